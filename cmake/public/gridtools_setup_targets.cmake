@@ -341,6 +341,12 @@ macro(_gt_setup_targets _config_mode clang_cuda_mode)
         target_link_libraries(${_gt_namespace}threadpool_hpx INTERFACE ${_gt_namespace}gridtools HPX::hpx)
     endif()
 
+    find_package(Threads)
+    if (Threads_FOUND)
+        _gt_add_library(${_config_mode} threadpool_persistent)
+        target_link_libraries(${_gt_namespace}threadpool_persistent INTERFACE ${_gt_namespace}gridtools Threads::Threads)
+    endif()
+
     set(GT_AVAILABLE_TARGETS ${_gt_available_targets} CACHE STRING "Available GridTools targets" FORCE)
     mark_as_advanced(GT_AVAILABLE_TARGETS)
 endmacro()
@@ -11,15 +11,24 @@
 #pragma once
 
 #include "../common/layout_map.hpp"
+#include "../gcl/low_level/proc_grids_3D.hpp"
 
 namespace gridtools {
     namespace boundaries {
         /** \ingroup Distributed-Boundaries
          * @{ */
 
-        template <typename StorageType, typename Arch, typename TimerImpl>
+        /**
+            \tparam ProcGrid The process grid of the communication, gcl::thread_3D_process_grid_t<3> makes the
+            subdomains to be owned by the threads of a single process
+        */
+        template <typename StorageType,
+            typename Arch,
+            typename TimerImpl,
+            typename ProcGrid = gcl::MPI_3D_process_grid_t<3>>
         struct comm_traits {
             using proc_layout = layout_map<0, 1, 2>;
+            using proc_grid_type = ProcGrid;
             using comm_arch_type = Arch;
             using timer_impl_t = TimerImpl;
             using data_layout = typename StorageType::element_type::layout_t;
@@ -0,0 +1,163 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../common/defs.hpp"
+#include "../common/hymap.hpp"
+#include "../common/integral_constant.hpp"
+#include "../meta.hpp"
+#include "../sid/concept.hpp"
+#include "../sid/delegate.hpp"
+#include "../sid/unknown_kind.hpp"
+#include "../stencil/common/intent.hpp"
+
+namespace gridtools {
+    namespace boundaries {
+        namespace direct_pack_sid_impl_ {
+            // the value stored through the pointer goes also to the send buffers of the exchange
+            template <class T, class Exchange>
+            struct reference {
+                T *m_ptr;
+                Exchange *m_exchange;
+                int m_field;
+                int_t m_pos[3];
+
+                operator T() const { return *m_ptr; }
+
+                reference &operator=(T const &value) {
+                    *m_ptr = value;
+                    m_exchange->write_halo(m_field, m_pos[0], m_pos[1], m_pos[2], value);
+                    return *this;
+                }
+
+                reference &operator=(reference const &other) { return *this = static_cast<T>(other); }
+            };
+
+            template <class T, class Exchange>
+            struct ptr {
+                T *m_impl;
+                Exchange *m_exchange;
+                int m_field;
+                int_t m_pos[3];
+
+                reference<T, Exchange> operator*() const {
+                    return {m_impl, m_exchange, m_field, {m_pos[0], m_pos[1], m_pos[2]}};
+                }
+            };
+
+            template <class PtrDiff>
+            struct ptr_diff {
+                PtrDiff m_impl{};
+                int_t m_pos[3] = {};
+
+                template <class T, class Exchange>
+                friend ptr<T, Exchange> operator+(ptr<T, Exchange> obj, ptr_diff const &diff) {
+                    obj.m_impl = obj.m_impl + diff.m_impl;
+                    for (int d = 0; d < 3; ++d)
+                        obj.m_pos[d] += diff.m_pos[d];
+                    return obj;
+                }
+            };
+
+            // moves the position in the dimension `Dim` of the data store along with the pointer
+            template <class Dim, class Stride>
+            struct stride {
+                static_assert(Dim::value >= 0 && Dim::value < 3, GT_INTERNAL_ERROR);
+                Stride m_impl;
+
+                template <class Ptr, class Offset>
+                friend void sid_shift(Ptr &obj, stride const &s, Offset const &offset) {
+                    sid::shift(obj.m_impl, s.m_impl, offset);
+                    obj.m_pos[Dim::value] += offset;
+                }
+            };
+
+            struct wrap_stride_f {
+                template <class Dim, class Stride>
+                stride<Dim, Stride> operator()(Stride const &impl) const {
+                    return {impl};
+                }
+            };
+
+            template <class Sid, class Exchange>
+            struct direct_pack_sid : sid::delegate<Sid> {
+                using ptr_diff_t = ptr_diff<sid::ptr_diff_type<Sid>>;
+                using ptr_t = ptr<sid::element_type<Sid>, Exchange>;
+
+                struct ptr_holder {
+                    sid::ptr_holder_type<Sid> m_impl;
+                    Exchange *m_exchange;
+                    int m_field;
+                    int_t m_pos[3];
+
+                    ptr_t operator()() const {
+                        return {m_impl(), m_exchange, m_field, {m_pos[0], m_pos[1], m_pos[2]}};
+                    }
+
+                    friend ptr_holder operator+(ptr_holder obj, ptr_diff_t const &diff) {
+                        obj.m_impl = obj.m_impl + diff.m_impl;
+                        for (int d = 0; d < 3; ++d)
+                            obj.m_pos[d] += diff.m_pos[d];
+                        return obj;
+                    }
+                };
+
+                Exchange *m_exchange;
+                int m_field;
+
+                direct_pack_sid(Sid impl, Exchange &exchange, int field)
+                    : sid::delegate<Sid>(std::move(impl)), m_exchange(&exchange), m_field(field) {}
+
+                friend ptr_holder sid_get_origin(direct_pack_sid &obj) {
+                    return {sid::get_origin(obj.m_impl), obj.m_exchange, obj.m_field, {0, 0, 0}};
+                }
+
+                friend ptr_diff_t sid_get_ptr_diff(direct_pack_sid const &) { return {}; }
+
+                friend auto sid_get_strides(direct_pack_sid const &obj) {
+                    return hymap::transform(wrap_stride_f(), sid::get_strides(obj.m_impl));
+                }
+            };
+
+            template <class...>
+            struct kind;
+
+            template <class Sid, class Exchange, class Kind = sid::strides_kind<Sid>>
+            meta::if_<std::is_same<Kind, sid::unknown_kind>, Kind, kind<Kind>> sid_get_strides_kind(
+                direct_pack_sid<Sid, Exchange> const &);
+        } // namespace direct_pack_sid_impl_
+
+        /**
+         *  A SID of a three dimensional data store that passes every value stored through it to the send buffers of
+         *  the exchange `exchange`, as the field with the index `field`, see gcl::halo_exchange_dynamic_ut::write_halo.
+         *  The position of the pointer is tracked in the dimensions 0, 1 and 2 of the data store, the origin being the
+         *  first element including the halos. The references are proxies: only plain reads and assignments are
+         *  supported, and the data store must not be k-cached by the stencils.
+         *
+         *  Host only, see distributed_boundaries::direct_pack.
+         */
+        template <class Sid, class Exchange>
+        direct_pack_sid_impl_::direct_pack_sid<Sid, Exchange> make_direct_pack_sid(
+            Sid sid, Exchange &exchange, int field) {
+            static_assert(sid::is_sid<Sid>::value, "the data store of the direct packing must model the SID concept");
+            return {std::move(sid), exchange, field};
+        }
+    } // namespace boundaries
+
+    namespace stencil {
+        template <class T, class Exchange>
+        struct apply_intent_type<intent::inout, boundaries::direct_pack_sid_impl_::reference<T, Exchange>> {
+            using type = boundaries::direct_pack_sid_impl_::reference<T, Exchange>;
+        };
+    } // namespace stencil
+} // namespace gridtools
@@ -13,14 +13,23 @@
 /** \defgroup Distributed-Boundaries Distributed Boundary Conditions
  */
 
+#include <functional>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "../common/halo_descriptor.hpp"
 #include "../common/timer/timer.hpp"
+#include "../common/tuple_util.hpp"
 #include "../gcl/halo_exchange.hpp"
+#include "../gcl/high_level/descriptor_aggregated.hpp"
+#include "../meta.hpp"
+#include "../thread_pool/omp.hpp"
 #include "bound_bc.hpp"
+#include "direct_pack_sid.hpp"
 #include "grid_predicate.hpp"
 #include "predicate.hpp"
 
@@ -29,6 +38,29 @@ namespace gridtools {
         /** \ingroup Distributed-Boundaries
          * @{ */
 
+        namespace distributed_boundaries_impl_ {
+            // the process grid of the communication traits, MPI if not specified
+            template <class CTraits, class = void>
+            struct proc_grid_type {
+                using type = gcl::MPI_3D_process_grid_t<3>;
+            };
+
+            template <class CTraits>
+            struct proc_grid_type<CTraits, void_t<typename CTraits::proc_grid_type>> {
+                using type = typename CTraits::proc_grid_type;
+            };
+
+            // whether the data store of the pointer type `Ptr` has the value type and the layout of the traits
+            template <class CTraits>
+            struct is_traits_store {
+                template <class Ptr, class Store = typename std::decay_t<Ptr>::element_type>
+                using apply = bool_constant<
+                    std::is_same<std::remove_const_t<typename Store::data_t>,
+                        std::remove_const_t<typename CTraits::value_type>>::value &&
+                    std::is_same<typename Store::layout_t, typename CTraits::data_layout>::value>;
+            };
+        } // namespace distributed_boundaries_impl_
+
         /**
             @brief This class takes a communication traits class and provide a facility to
             perform boundary conditions and communications in a single call.
@@ -70,7 +102,13 @@ namespace gridtools {
             using pattern_type = gcl::halo_exchange_dynamic_ut<typename CTraits::data_layout,
                 typename CTraits::proc_layout,
                 typename CTraits::value_type,
-                typename CTraits::comm_arch_type>;
+                typename CTraits::comm_arch_type,
+                0,
+                typename distributed_boundaries_impl_::proc_grid_type<CTraits>::type>;
+
+            using aggregated_pattern_type =
+                gcl::hndlr_aggregated<gcl::Halo_Exchange_3D<typename pattern_type::grid_type>,
+                    typename CTraits::proc_layout>;
 
           private:
             using performance_meter_t = timer<typename CTraits::timer_impl_t>;
@@ -79,6 +117,15 @@ namespace gridtools {
             array<int_t, 3> m_sizes;
             uint_t m_max_stores;
             std::unique_ptr<pattern_type> m_he;
+            typename pattern_type::grid_type::period_type m_period;
+            // created on the first use, see aggregated()
+            std::unique_ptr<aggregated_pattern_type> m_aggregated;
+            bool m_use_aggregated = false;
+            // the settings applied to the aggregated pattern when it is created
+            std::function<void(aggregated_pattern_type &)> m_aggregated_persistent;
+            std::function<void(aggregated_pattern_type &)> m_aggregated_progress_thread;
+            // the data stores of the pending direct packing, see direct_pack
+            std::vector<void const *> m_direct_pack;
 
             performance_meter_t m_meter_pack;
             performance_meter_t m_meter_exchange;
@@ -94,14 +141,16 @@ namespace gridtools {
                dimension. true mean the dimension is periodic \param max_stores Maximum number of data_stores to be used
                in communication. PAssing more will couse a runtime error (probably segmentation fault), passing less
                will underutilize the memory \param CartComm MPI communicator to use in the halo update operation [must
-               be a cartesian communicator]
+               be a cartesian communicator], or the communicator of the process grid of the traits
             */
             distributed_boundaries(array<halo_descriptor, 3> halos,
                 typename pattern_type::grid_type::period_type period,
                 uint_t max_stores,
-                MPI_Comm CartComm)
+                typename pattern_type::grid_type::communicator_type CartComm)
                 : m_halos{halos}, m_sizes{0, 0, 0}, m_max_stores{max_stores},
-                  m_he(std::make_unique<pattern_type>(period, CartComm)), m_meter_pack("pack/unpack       "),
+                  m_he(std::make_unique<pattern_type>(period, CartComm)),
+                  m_period(period),
+                  m_meter_pack("pack/unpack       "),
                   m_meter_exchange("exchange          "), m_meter_bc("boundary condition") {
                 m_he->pattern().proc_grid().fill_dims(m_sizes);
 
@@ -159,7 +208,21 @@ namespace gridtools {
             */
             template <typename... Jobs>
             void exchange(Jobs const &... jobs) {
-                auto all_stores_for_exc = std::tuple_cat(collect_stores(jobs)...);
+                start_exchange(jobs...);
+                wait(jobs...);
+            }
+
+            /**
+                @brief Split-phase version of distributed_boundaries::exchange: packs the data and starts the
+                communication. Must be followed by distributed_boundaries::wait with the same jobs.
+
+                In between, the data stores that are communicated must not be modified, but can be read outside of
+                their halos.
+
+                \param jobs Variadic list of jobs
+            */
+            template <typename... Jobs>
+            void start_exchange(Jobs const &... jobs) {
                 if (m_max_stores < sizeof...(jobs)) {
                     std::string err{"Too many data stores to be exchanged" + std::to_string(sizeof...(jobs)) +
                                     " instead of the maximum allowed, which is " + std::to_string(m_max_stores)};
@@ -167,18 +230,133 @@ namespace gridtools {
                 }
 
                 m_meter_pack.start();
-                call_pack(all_stores_for_exc, std::make_integer_sequence<uint_t, sizeof...(jobs)>{});
-                m_meter_pack.pause();
-                m_meter_exchange.start();
-                m_he->exchange();
-                m_meter_exchange.pause();
-                m_meter_pack.start();
-                call_unpack(all_stores_for_exc, std::make_integer_sequence<uint_t, sizeof...(jobs)>{});
+                auto stores = std::tuple_cat(collect_stores(jobs)...);
+                start_stores(stores, has_traits_stores<decltype(stores)>(), has_aggregated());
                 m_meter_pack.pause();
+            }
+
+            /**
+                @brief Starts the direct packing of the data stores for their next exchange, that then skips the
+                packing. The returned tuple holds a SID per data store, in the same order, to be passed to the stencil
+                that computes the data stores in place of them: every value that the stencil stores through it goes
+                also to the send buffers, see boundaries::make_direct_pack_sid. The stencil must write the whole compute
+                domain of the data stores, and the next exchange must be of the same data stores in the same order.
+
+                Host only, not available with the aggregated, face and datatype exchanges.
+
+                \param stores The data stores of the traits to be exchanged next
+            */
+            template <typename... Stores>
+            auto direct_pack(Stores const &... stores) {
+                static_assert(has_aggregated::value, "the direct packing is available for the host memory only");
+                static_assert(has_traits_stores<std::tuple<Stores...>>::value,
+                    "the direct packing is available for the data stores of the traits only");
+                if (m_use_aggregated)
+                    throw std::runtime_error("The direct packing is not available with the aggregated exchange");
+                if (m_max_stores < sizeof...(stores))
+                    throw std::runtime_error("Too many data stores for the direct packing");
+                m_he->begin_direct_pack(sizeof...(stores));
+                m_direct_pack = {stores->get_const_target_ptr()...};
+                return make_direct_pack_sids(std::index_sequence_for<Stores...>(), stores...);
+            }
+
+            /**
+                @brief Completes the communication started by distributed_boundaries::start_exchange, unpacks the
+                data and applies the boundary conditions.
+
+                \param jobs Variadic list of jobs, the same as passed to distributed_boundaries::start_exchange
+            */
+            template <typename... Jobs>
+            void wait(Jobs const &... jobs) {
+                auto stores = std::tuple_cat(collect_stores(jobs)...);
+                wait_stores(stores, has_traits_stores<decltype(stores)>(), has_aggregated());
 
                 boundary_only(jobs...);
             }
 
+            /**
+                @brief The halo descriptors the object was constructed with. The compute domain of the local
+                subdomain is given by their begin and end.
+            */
+            array<halo_descriptor, 3> const &halos() const { return m_halos; }
+
+            /**
+                @brief Switches the communication to the persistent MPI requests, that are set up once and reused
+                by every exchange with the same number of data stores.
+            */
+            void use_persistent_requests(bool value = true) {
+                m_he->use_persistent_requests(value);
+                m_aggregated_persistent = [value](aggregated_pattern_type &aggregated) {
+                    aggregated.use_persistent_requests(value);
+                };
+                if (m_aggregated)
+                    m_aggregated_persistent(*m_aggregated);
+            }
+
+            /**
+                @brief Switches the communication with the processes on the same node to the MPI-3 shared memory,
+                see gcl::halo_exchange_dynamic_ut::use_shared_memory. Collective, not available for the gpu
+                communication.
+            */
+            void use_shared_memory(bool value = true) { m_he->use_shared_memory(value); }
+
+            /**
+                @brief Switches to a progress thread that drives the communication between start_exchange and wait,
+                see gcl::halo_exchange_dynamic_ut::use_progress_thread.
+            */
+            template <class ThreadPool = thread_pool::omp>
+            void use_progress_thread(bool value = true, ThreadPool pool = {}) {
+                m_he->use_progress_thread(value, pool);
+                m_aggregated_progress_thread = [value, pool](aggregated_pattern_type &aggregated) {
+                    aggregated.use_progress_thread(value, pool);
+                };
+                if (m_aggregated)
+                    m_aggregated_progress_thread(*m_aggregated);
+            }
+
+            /**
+                @brief Switches the communication to the exchange with the six face neighbors only, see
+                gcl::halo_exchange_dynamic_ut::use_face_exchange.
+            */
+            void use_face_exchange(bool value = true) { m_he->use_face_exchange(value); }
+
+            /**
+                @brief Switches the communication to the MPI derived datatypes that send the halos directly from
+                the data stores, see gcl::halo_exchange_dynamic_ut::use_datatypes.
+            */
+            void use_datatypes(bool value = true) { m_he->use_datatypes(value); }
+
+            /**
+                @brief Sends the halos of the data stores in a reduced precision, per data store in the order of the
+                jobs or for all of them, see gcl::halo_exchange_dynamic_ut::use_halo_precision.
+            */
+            template <typename Precisions>
+            void use_halo_precision(Precisions const &precisions) {
+                m_he->use_halo_precision(precisions);
+            }
+
+            /**
+                @brief Switches the communication to the aggregated exchange of gcl::hndlr_aggregated, that packs the
+                halos of all the data stores byte-wise into one buffer per neighbor.
+
+                The aggregated exchange is always used for the jobs with data stores of other value types or layouts
+                than the ones of the traits. The halos of such a data store are the ones of the constructor in the
+                dimensions in which it has the same length. In the other dimensions, it is supposed to have the same
+                compute domain and symmetric halos, of which at most the widths of the constructor are exchanged.
+                The modes of the exchange of the traits data stores (persistent requests, shared memory, face
+                exchange, datatypes) do not apply to it. Host memory only: throws for the other architectures.
+
+                The pattern of the aggregated exchange, with its own communicator, is created by the first call with
+                `value` true, or by the first exchange of data stores of other types. Collective then.
+            */
+            void use_aggregated_exchange(bool value = true) {
+                if (value && !has_aggregated::value)
+                    throw std::runtime_error("The aggregated exchange is available for the host memory only");
+                if (value)
+                    create_aggregated(has_aggregated());
+                m_use_aggregated = value;
+            }
+
             auto const &proc_grid() const { return m_he->comm(); }
 
             std::string print_meters() const {
@@ -231,6 +409,159 @@ namespace gridtools {
                 return std::make_tuple(first_job);
             }
 
+            template <typename Stores>
+            using has_traits_stores =
+                meta::all_of<distributed_boundaries_impl_::is_traits_store<CTraits>::template apply, Stores>;
+
+            // the aggregated exchange packs on the host
+            using has_aggregated = std::is_same<typename CTraits::comm_arch_type, gcl::cpu>;
+
+            // the pattern of the aggregated exchange on the process grid of the traits exchange, with the settings
+            // recorded until then
+            aggregated_pattern_type &create_aggregated(std::true_type) {
+                if (!m_aggregated) {
+                    m_aggregated = std::make_unique<aggregated_pattern_type>(
+                        m_period.template permute<typename CTraits::proc_layout>(), m_he->comm().communicator());
+                    if (m_aggregated_persistent)
+                        m_aggregated_persistent(*m_aggregated);
+                    if (m_aggregated_progress_thread)
+                        m_aggregated_progress_thread(*m_aggregated);
+                }
+                return *m_aggregated;
+            }
+
+            void create_aggregated(std::false_type) {}
+
+            // the traits data stores on the host: the exchange is chosen at run time, see use_aggregated_exchange
+            template <typename Stores>
+            void start_stores(Stores const &stores, std::true_type, std::true_type) {
+                if (m_use_aggregated)
+                    start_aggregated(stores);
+                else
+                    start_traits(stores);
+            }
+
+            template <typename Stores>
+            void start_stores(Stores const &stores, std::true_type, std::false_type) {
+                start_traits(stores);
+            }
+
+            template <typename Stores, typename HasAggregated>
+            void start_stores(Stores const &stores, std::false_type, HasAggregated) {
+                static_assert(HasAggregated::value,
+                    "the data stores of other types than the ones of the traits can be exchanged in the host memory "
+                    "only");
+                start_aggregated(stores);
+            }
+
+            template <typename Stores>
+            void wait_stores(Stores const &stores, std::true_type, std::true_type) {
+                if (m_use_aggregated)
+                    wait_aggregated(stores);
+                else
+                    wait_traits(stores);
+            }
+
+            template <typename Stores>
+            void wait_stores(Stores const &stores, std::true_type, std::false_type) {
+                wait_traits(stores);
+            }
+
+            template <typename Stores, typename HasAggregated>
+            void wait_stores(Stores const &stores, std::false_type, HasAggregated) {
+                wait_aggregated(stores);
+            }
+
+            template <typename Stores>
+            void start_traits(Stores const &stores) {
+                if (m_direct_pack.empty())
+                    call_pack(stores, std::make_integer_sequence<uint_t, std::tuple_size<Stores>::value>{});
+                else
+                    check_direct_pack(stores);
+                m_he->start_exchange();
+            }
+
+            // the direct packing applies only to the exchange of the data stores it was started for
+            template <typename Stores>
+            void check_direct_pack(Stores const &stores) {
+                std::vector<void const *> ptrs;
+                tuple_util::for_each([&](auto const &store) { ptrs.push_back(store->get_const_target_ptr()); }, stores);
+                bool is_same = ptrs == m_direct_pack;
+                m_direct_pack.clear();
+                if (!is_same)
+                    throw std::runtime_error("The data stores exchanged are not the ones of the direct packing");
+            }
+
+            template <typename... Stores, size_t... Ids>
+            auto make_direct_pack_sids(std::index_sequence<Ids...>, Stores const &... stores) {
+                return std::make_tuple(make_direct_pack_sid(stores, *m_he, Ids)...);
+            }
+
+            template <typename Stores>
+            void wait_traits(Stores const &stores) {
+                m_meter_exchange.start();
+                m_he->wait();
+                m_meter_exchange.pause();
+                m_meter_pack.start();
+                call_unpack(stores, std::make_integer_sequence<uint_t, std::tuple_size<Stores>::value>{});
+                m_meter_pack.pause();
+            }
+
+            template <typename Stores>
+            void start_aggregated(Stores const &stores) {
+                auto &aggregated = create_aggregated(has_aggregated());
+                aggregated.pack(make_byte_fields(stores));
+                aggregated.start_exchange();
+            }
+
+            template <typename Stores>
+            void wait_aggregated(Stores const &stores) {
+                m_meter_exchange.start();
+                m_aggregated->wait();
+                m_meter_exchange.pause();
+                m_meter_pack.start();
+                m_aggregated->unpack(make_byte_fields(stores));
+                m_meter_pack.pause();
+            }
+
+            // the halos of a data store for the aggregated exchange, see use_aggregated_exchange
+            template <typename Store>
+            array<halo_descriptor, 3> store_halos(Store const &store) const {
+                array<halo_descriptor, 3> res;
+                auto lengths = store->lengths();
+                for (int d = 0; d < 3; ++d) {
+                    auto const &h = m_halos[d];
+                    int length = lengths[d];
+                    if (length == (int)h.total_length()) {
+                        res[d] = h;
+                        continue;
+                    }
+                    int compute = h.end() - h.begin() + 1;
+                    int width = (length - compute) / 2;
+                    if (length < compute || (length - compute) % 2)
+                        throw std::runtime_error("The data store " + store->name() +
+                                                 " does not match the compute domain of the distributed boundaries");
+                    res[d] = halo_descriptor(std::min<int>(width, h.minus()),
+                        std::min<int>(width, h.plus()),
+                        width,
+                        width + compute - 1,
+                        length);
+                }
+                return res;
+            }
+
+            template <typename Stores>
+            std::vector<gcl::byte_field> make_byte_fields(Stores const &stores) const {
+                std::vector<gcl::byte_field> res;
+                tuple_util::for_each(
+                    [&](auto const &store) {
+                        res.push_back(
+                            gcl::make_byte_field(store->get_target_ptr(), store_halos(store), store->strides()));
+                    },
+                    stores);
+                return res;
+            }
+
             template <typename Stores, uint_t... Ids>
             void call_pack(Stores const &stores, std::integer_sequence<uint_t, Ids...>) {
                 m_he->pack(std::get<Ids>(stores)->get_const_target_ptr()...);
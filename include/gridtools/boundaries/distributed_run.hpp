@@ -0,0 +1,194 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/halo_descriptor.hpp"
+#include "../common/tuple_util.hpp"
+#include "../stencil/common/extent.hpp"
+#include "../stencil/frontend/make_grid.hpp"
+#include "../stencil/frontend/run.hpp"
+#include "distributed_boundaries.hpp"
+
+namespace gridtools {
+    namespace boundaries {
+        /** \ingroup Distributed-Boundaries
+         * @{ */
+
+        namespace distributed_run_impl_ {
+            /**
+                @brief The split of the compute domain of a subdomain: the interior, that does not read the halos
+                of the fields within the given extent, and up to four strips along the subdomain edges, that cover
+                the rest of the compute domain.
+            */
+            struct regions {
+                bool has_interior;
+                halo_descriptor interior_i;
+                halo_descriptor interior_j;
+                std::vector<std::pair<halo_descriptor, halo_descriptor>> strips;
+            };
+
+            inline halo_descriptor sub_range(halo_descriptor const &hd, int_t begin, int_t end) {
+                return {0, 0, (uint_t)begin, (uint_t)end, hd.total_length()};
+            }
+
+            /**
+                @brief Splits the compute domain given by the begin and end of the halo descriptors `di` and `dj`.
+
+                \tparam Extent The extent with which the fields are read
+            */
+            template <class Extent>
+            regions split_domain(halo_descriptor const &di, halo_descriptor const &dj, Extent = {}) {
+                int_t b_i = di.begin(), e_i = di.end(), b_j = dj.begin(), e_j = dj.end();
+                int_t ib_i = b_i - Extent::iminus::value, ie_i = e_i - Extent::iplus::value;
+                int_t ib_j = b_j - Extent::jminus::value, ie_j = e_j - Extent::jplus::value;
+
+                regions res = {ib_i <= ie_i && ib_j <= ie_j, di, dj, {}};
+                if (!res.has_interior) {
+                    res.strips.emplace_back(di, dj);
+                    return res;
+                }
+                res.interior_i = sub_range(di, ib_i, ie_i);
+                res.interior_j = sub_range(dj, ib_j, ie_j);
+                auto add_strip = [&](int_t bi, int_t ei, int_t bj, int_t ej) {
+                    if (bi <= ei && bj <= ej)
+                        res.strips.emplace_back(sub_range(di, bi, ei), sub_range(dj, bj, ej));
+                };
+                add_strip(b_i, ib_i - 1, b_j, e_j);
+                add_strip(ie_i + 1, e_i, b_j, e_j);
+                add_strip(ib_i, ie_i, b_j, ib_j - 1);
+                add_strip(ib_i, ie_i, ie_j + 1, e_j);
+                return res;
+            }
+
+            template <class Comp, size_t... Is>
+            stencil::enclosing_extent<decltype(
+                stencil::get_arg_extent(std::declval<Comp>()(stencil::frontend_impl_::arg<Is>()...),
+                    stencil::frontend_impl_::arg<Is>()))...>
+            get_comp_extent(Comp, std::index_sequence<Is...>);
+
+            /**
+                @brief Runs the stencil computation `comp` on the compute domain of the subdomain, overlapping the halo
+                exchange of the given jobs with the computation on the interior of the domain.
+
+                The communication is started first, then the points that do not depend on the halos are computed.
+                The strips along the subdomain edges are computed after the communication and the boundary
+                conditions are completed. The interior is derived from the extents with which the computation reads
+                its fields.
+
+                The result is the same as the one of `bnd.exchange(jobs...)` followed by the `run` on the whole
+                compute domain, provided that the computation does not write the fields it reads with a horizontal
+                extent and the exchanged fields are not written by the computation.
+
+                \param bnd The distributed boundaries object that defines the compute domain and the communication
+                \param jobs The tuple of the jobs to be passed to distributed_boundaries::exchange
+                \param comp The stencil composition specification, as passed to `run`
+                \param be The backend
+                \param axis_or_k_size The vertical axis or the size in k
+                \param fields The fields of the computation
+            */
+            template <class CTraits, class... Jobs, class Comp, class Backend, class Axis, class... Fields>
+            void distributed_run(distributed_boundaries<CTraits> &bnd,
+                std::tuple<Jobs...> const &jobs,
+                Comp comp,
+                Backend &&be,
+                Axis const &axis_or_k_size,
+                Fields &&... fields) {
+                using extent_t = decltype(get_comp_extent(comp, std::index_sequence_for<Fields...>()));
+                auto domain = split_domain<extent_t>(bnd.halos()[0], bnd.halos()[1]);
+                auto run_on = [&](halo_descriptor const &di, halo_descriptor const &dj) {
+                    stencil::run(comp, be, stencil::make_grid(di, dj, axis_or_k_size), fields...);
+                };
+
+                tuple_util::apply([&](auto const &... js) { bnd.start_exchange(js...); }, jobs);
+                if (domain.has_interior)
+                    run_on(domain.interior_i, domain.interior_j);
+                tuple_util::apply([&](auto const &... js) { bnd.wait(js...); }, jobs);
+                for (auto const &strip : domain.strips)
+                    run_on(strip.first, strip.second);
+            }
+
+            inline halo_descriptor extend(halo_descriptor const &hd, int_t minus, int_t plus) {
+                return sub_range(hd, (int_t)hd.begin() - minus, (int_t)hd.end() + plus);
+            }
+
+            /**
+                @brief Runs `n_steps` steps of the stencil computation `comp` with a single halo exchange, trading the
+                communication for the redundant computation in the halos.
+
+                The halos of `bnd` (and of the fields) should be `n_steps` times as wide as the extent with which the
+                computation reads its fields. After the exchange of the given jobs, the step `s` (counting from zero)
+                is computed on the compute domain extended by `n_steps - 1 - s` times the extent, so that the
+                halo points read by the next step are valid without the communication. The extent is derived from
+                the computation specification.
+
+                `step_fields(s)` returns the tuple of the fields for the step `s`. This allows to swap the input and
+                output fields between the steps.
+
+                Note that the boundary conditions of the jobs are applied only once, before the first step.
+
+                \param bnd The distributed boundaries object that defines the compute domain and the communication
+                \param jobs The tuple of the jobs to be passed to distributed_boundaries::exchange
+                \param n_steps The number of steps to run
+                \param comp The stencil composition specification of a step, as passed to `run`
+                \param be The backend
+                \param axis_or_k_size The vertical axis or the size in k
+                \param step_fields The callable that returns the tuple of the fields for a given step
+            */
+            template <class CTraits, class... Jobs, class Comp, class Backend, class Axis, class StepFields>
+            void deep_halo_run(distributed_boundaries<CTraits> &bnd,
+                std::tuple<Jobs...> const &jobs,
+                int_t n_steps,
+                Comp comp,
+                Backend &&be,
+                Axis const &axis_or_k_size,
+                StepFields &&step_fields) {
+                using fields_t = std::decay_t<decltype(step_fields(int_t()))>;
+                using extent_t = decltype(
+                    get_comp_extent(comp, std::make_index_sequence<tuple_util::size<fields_t>::value>()));
+                int_t iminus = -extent_t::iminus::value, iplus = extent_t::iplus::value;
+                int_t jminus = -extent_t::jminus::value, jplus = extent_t::jplus::value;
+
+                auto const &di = bnd.halos()[0];
+                auto const &dj = bnd.halos()[1];
+                if ((int_t)di.minus() < n_steps * iminus || (int_t)di.plus() < n_steps * iplus ||
+                    (int_t)dj.minus() < n_steps * jminus || (int_t)dj.plus() < n_steps * jplus) {
+                    std::string err{"The halos are too narrow to run " + std::to_string(n_steps) +
+                                    " steps with a single exchange"};
+                    throw std::runtime_error(err);
+                }
+
+                tuple_util::apply([&](auto const &... js) { bnd.exchange(js...); }, jobs);
+                for (int_t s = 0; s < n_steps; ++s) {
+                    int_t depth = n_steps - 1 - s;
+                    auto grid = stencil::make_grid(extend(di, depth * iminus, depth * iplus),
+                        extend(dj, depth * jminus, depth * jplus),
+                        axis_or_k_size);
+                    tuple_util::apply(
+                        [&](auto &&... fields) { stencil::run(comp, be, grid, fields...); }, step_fields(s));
+                }
+            }
+        } // namespace distributed_run_impl_
+
+        using distributed_run_impl_::deep_halo_run;
+        using distributed_run_impl_::distributed_run;
+        using distributed_run_impl_::split_domain;
+
+        /** @} */
+    } // namespace boundaries
+} // namespace gridtools
@@ -0,0 +1,245 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <initializer_list>
+#include <type_traits>
+
+#include "defs.hpp"
+#include "gt_math.hpp"
+#include "host_device.hpp"
+
+/**
+ *  A minimal portable short vector type.
+ *
+ *  `vec<T, N>` holds `N` lanes by value. `vec_ref<T, N, Stride>` refers to `N` lanes in memory that are `Stride`
+ *  elements apart: reading converts it to `vec`, assigning to it stores the lanes back.
+ *  Arithmetic operators and the functions from `gridtools::math` are applied lane by lane, scalar operands are
+ *  broadcast. All loops have a compile time trip count, so that the compiler can map them to vector instructions.
+ *
+ *  Comparisons are intentionally not provided: there is no portable way to branch on a vector.
+ */
+namespace gridtools {
+    namespace simd {
+        template <class T, int N>
+        struct vec {
+            static_assert(N > 0, GT_INTERNAL_ERROR);
+
+            T m_values[N];
+
+            vec() = default;
+
+            GT_FORCE_INLINE vec(T value) {
+                for (int l = 0; l < N; ++l)
+                    m_values[l] = value;
+            }
+
+            template <class U>
+            GT_FORCE_INLINE vec(vec<U, N> const &src) {
+                for (int l = 0; l < N; ++l)
+                    m_values[l] = src[l];
+            }
+
+            GT_FORCE_INLINE T &operator[](int l) { return m_values[l]; }
+            GT_FORCE_INLINE T const &operator[](int l) const { return m_values[l]; }
+
+            template <class Rhs>
+            GT_FORCE_INLINE vec &operator+=(Rhs const &rhs) {
+                return *this = *this + rhs;
+            }
+            template <class Rhs>
+            GT_FORCE_INLINE vec &operator-=(Rhs const &rhs) {
+                return *this = *this - rhs;
+            }
+            template <class Rhs>
+            GT_FORCE_INLINE vec &operator*=(Rhs const &rhs) {
+                return *this = *this * rhs;
+            }
+            template <class Rhs>
+            GT_FORCE_INLINE vec &operator/=(Rhs const &rhs) {
+                return *this = *this / rhs;
+            }
+        };
+
+        template <class T, int N, int Stride>
+        class vec_ref {
+            static_assert(N > 0, GT_INTERNAL_ERROR);
+
+            T *m_ptr;
+
+          public:
+            explicit vec_ref(T *ptr) : m_ptr(ptr) {}
+            vec_ref(vec_ref const &) = default;
+
+            GT_FORCE_INLINE T const &operator[](int l) const { return m_ptr[l * Stride]; }
+
+            GT_FORCE_INLINE operator vec<T, N>() const {
+                vec<T, N> res;
+                for (int l = 0; l < N; ++l)
+                    res[l] = m_ptr[l * Stride];
+                return res;
+            }
+
+            GT_FORCE_INLINE vec_ref const &operator=(vec<T, N> const &src) const {
+                for (int l = 0; l < N; ++l)
+                    m_ptr[l * Stride] = src[l];
+                return *this;
+            }
+
+            GT_FORCE_INLINE vec_ref const &operator=(vec_ref const &src) const {
+                return *this = vec<T, N>(src);
+            }
+
+            template <class Rhs>
+            GT_FORCE_INLINE vec_ref const &operator+=(Rhs const &rhs) const {
+                return *this = *this + rhs;
+            }
+            template <class Rhs>
+            GT_FORCE_INLINE vec_ref const &operator-=(Rhs const &rhs) const {
+                return *this = *this - rhs;
+            }
+            template <class Rhs>
+            GT_FORCE_INLINE vec_ref const &operator*=(Rhs const &rhs) const {
+                return *this = *this * rhs;
+            }
+            template <class Rhs>
+            GT_FORCE_INLINE vec_ref const &operator/=(Rhs const &rhs) const {
+                return *this = *this / rhs;
+            }
+        };
+
+        namespace simd_impl_ {
+            template <class T>
+            struct width : std::integral_constant<int, std::is_arithmetic<T>::value ? 0 : -1> {};
+
+            template <class T, int N>
+            struct width<vec<T, N>> : std::integral_constant<int, N> {};
+
+            template <class T, int N, int Stride>
+            struct width<vec_ref<T, N, Stride>> : std::integral_constant<int, N> {};
+
+            constexpr int combine_widths(int lhs, int rhs) {
+                return lhs < 0 || rhs < 0 ? -1 : lhs == 0 ? rhs : rhs == 0 || rhs == lhs ? lhs : -1;
+            }
+
+            template <class... Ts>
+            constexpr int get_result_width() {
+                int res = 0;
+                for (int w : {0, width<std::decay_t<Ts>>::value...})
+                    res = combine_widths(res, w);
+                return res;
+            }
+
+            /**
+             *  The number of lanes of the result of the lane-wise operation on the given argument types.
+             *  Is zero if all arguments are scalars and negative if the arguments can not be combined.
+             */
+            template <class... Ts>
+            using result_width = std::integral_constant<int, get_result_width<Ts...>()>;
+
+            template <class... Ts>
+            using enable_if_simd = std::enable_if_t<(result_width<Ts...>::value > 0), int>;
+
+            template <class T>
+            GT_FORCE_INLINE T const &lane(T const &x, int) {
+                return x;
+            }
+
+            template <class T, int N>
+            GT_FORCE_INLINE T const &lane(vec<T, N> const &x, int l) {
+                return x[l];
+            }
+
+            template <class T, int N, int Stride>
+            GT_FORCE_INLINE T const &lane(vec_ref<T, N, Stride> const &x, int l) {
+                return x[l];
+            }
+
+            template <class F, class... Ts, int N = result_width<Ts...>::value>
+            GT_FORCE_INLINE auto apply(F f, Ts const &... args) {
+                using res_t = std::decay_t<decltype(f(lane(args, 0)...))>;
+                vec<res_t, N> res;
+                for (int l = 0; l < N; ++l)
+                    res[l] = f(lane(args, l)...);
+                return res;
+            }
+        } // namespace simd_impl_
+
+        using simd_impl_::apply;
+        using simd_impl_::enable_if_simd;
+
+#define GT_SIMD_DEFINE_BINARY_OPERATOR(op)                                              \
+    template <class Lhs, class Rhs, simd_impl_::enable_if_simd<Lhs, Rhs> = 0>           \
+    GT_FORCE_INLINE auto operator op(Lhs const &lhs, Rhs const &rhs) {                  \
+        return simd_impl_::apply([](auto l, auto r) { return l op r; }, lhs, rhs);      \
+    }
+
+        GT_SIMD_DEFINE_BINARY_OPERATOR(+)
+        GT_SIMD_DEFINE_BINARY_OPERATOR(-)
+        GT_SIMD_DEFINE_BINARY_OPERATOR(*)
+        GT_SIMD_DEFINE_BINARY_OPERATOR(/)
+
+#undef GT_SIMD_DEFINE_BINARY_OPERATOR
+
+        template <class T, simd_impl_::enable_if_simd<T> = 0>
+        GT_FORCE_INLINE auto operator-(T const &arg) {
+            return simd_impl_::apply([](auto x) { return -x; }, arg);
+        }
+
+        template <class T, simd_impl_::enable_if_simd<T> = 0>
+        GT_FORCE_INLINE auto operator+(T const &arg) {
+            return simd_impl_::apply([](auto x) { return +x; }, arg);
+        }
+    } // namespace simd
+
+    namespace math {
+#define GT_SIMD_DEFINE_UNARY_FUNCTION(fun)                                         \
+    template <class T, simd::enable_if_simd<T> = 0>                                \
+    GT_FORCE_INLINE auto fun(T const &arg) {                                       \
+        return simd::apply([](auto x) { return math::fun(x); }, arg);              \
+    }
+
+#define GT_SIMD_DEFINE_BINARY_FUNCTION(fun)                                                 \
+    template <class Lhs, class Rhs, simd::enable_if_simd<Lhs, Rhs> = 0>                     \
+    GT_FORCE_INLINE auto fun(Lhs const &lhs, Rhs const &rhs) {                              \
+        return simd::apply(                                                                 \
+            [](auto x, auto y) {                                                            \
+                using type = std::common_type_t<decltype(x), decltype(y)>;                  \
+                return math::fun(type(x), type(y));                                         \
+            },                                                                              \
+            lhs,                                                                            \
+            rhs);                                                                           \
+    }                                                                                       \
+    template <class T, int N>                                                               \
+    GT_FORCE_INLINE auto fun(simd::vec<T, N> const &lhs, simd::vec<T, N> const &rhs) {      \
+        return simd::apply([](auto x, auto y) { return math::fun(x, y); }, lhs, rhs);       \
+    }                                                                                       \
+    template <class T, int N, int Stride>                                                   \
+    GT_FORCE_INLINE auto fun(                                                               \
+        simd::vec_ref<T, N, Stride> const &lhs, simd::vec_ref<T, N, Stride> const &rhs) {   \
+        return simd::apply([](auto x, auto y) { return math::fun(x, y); }, lhs, rhs);       \
+    }
+
+        GT_SIMD_DEFINE_UNARY_FUNCTION(fabs)
+        GT_SIMD_DEFINE_UNARY_FUNCTION(abs)
+        GT_SIMD_DEFINE_UNARY_FUNCTION(exp)
+        GT_SIMD_DEFINE_UNARY_FUNCTION(log)
+        GT_SIMD_DEFINE_UNARY_FUNCTION(sqrt)
+        GT_SIMD_DEFINE_UNARY_FUNCTION(trunc)
+
+        GT_SIMD_DEFINE_BINARY_FUNCTION(pow)
+        GT_SIMD_DEFINE_BINARY_FUNCTION(fmod)
+        GT_SIMD_DEFINE_BINARY_FUNCTION(min)
+        GT_SIMD_DEFINE_BINARY_FUNCTION(max)
+
+#undef GT_SIMD_DEFINE_BINARY_FUNCTION
+#undef GT_SIMD_DEFINE_UNARY_FUNCTION
+    } // namespace math
+} // namespace gridtools
@@ -29,8 +29,10 @@ namespace gridtools {
             inline void init(int *argc, char ***argv) {
                 int ready;
                 MPI_Initialized(&ready);
+                // the progress thread of the halo exchange calls MPI from another thread than the main one
+                int provided;
                 if (!ready)
-                    MPI_Init(argc, argv);
+                    MPI_Init_thread(argc, argv, MPI_THREAD_SERIALIZED, &provided);
                 MPI_Comm_rank(world(), &pid_holder());
                 MPI_Comm_size(world(), &procs_holder());
             }
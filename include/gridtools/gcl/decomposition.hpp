@@ -0,0 +1,166 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../common/array.hpp"
+#include "../common/halo_descriptor.hpp"
+
+namespace gridtools {
+    namespace gcl {
+        namespace decomposition_impl_ {
+            /*
+             * The bounds of the `parts` consecutive parts of [0, n) of at least `min_size` points each: the part `r`
+             * is [res[r], res[r + 1]). Without weights the sizes differ by one at most, with weights (one per point)
+             * the bounds are the ones whose prefix sums are the closest to the even shares of the total weight.
+             */
+            inline std::vector<int> split(int n, int parts, std::vector<double> const &weights, int min_size) {
+                if (n < parts * min_size)
+                    throw std::runtime_error("the domain of size " + std::to_string(n) + " cannot be split in " +
+                                             std::to_string(parts) + " parts of at least " +
+                                             std::to_string(min_size) + " points");
+                std::vector<int> res(parts + 1, n);
+                res[0] = 0;
+                if (weights.empty()) {
+                    for (int r = 1; r < parts; ++r)
+                        res[r] = r * (n / parts) + std::min(r, n % parts);
+                    return res;
+                }
+                if ((int)weights.size() != n)
+                    throw std::runtime_error("one weight per point is expected");
+                std::vector<double> prefix(n + 1, 0);
+                for (int i = 0; i < n; ++i)
+                    prefix[i + 1] = prefix[i] + weights[i];
+                for (int r = 1; r < parts; ++r) {
+                    double target = prefix[n] * r / parts;
+                    int lo = res[r - 1] + min_size, hi = n - (parts - r) * min_size;
+                    int best = lo;
+                    for (int i = lo + 1; i <= hi && prefix[i - 1] < target; ++i)
+                        if (std::abs(prefix[i] - target) < std::abs(prefix[best] - target))
+                            best = i;
+                    res[r] = best;
+                }
+                return res;
+            }
+        } // namespace decomposition_impl_
+
+        /**
+           The decomposition of a global domain over a process grid (MPI_3D_process_grid_t or thread_3D_process_grid_t),
+           the dimension `d` of the domain being distributed along the dimension `d` of the grid (the default
+           proc_layout of boundaries::comm_traits). Every process owns a box of the domain and the halos around it.
+
+           The domain is split independently in every dimension. Without weights, the sizes of the parts differ by
+           one point at most. With weights, the parts along a dimension have about the same total weight: for
+           instance the costs of the columns can be given as their sums over the other horizontal dimension, see
+           column_weights.
+
+           The object gives, for the calling process:
+            - the halo descriptors of the dimensions, for make_grid and distributed_boundaries;
+            - the total lengths of the dimensions, for the dimensions of the storage builder;
+            - the global index of the first point of the compute domain, and the initial value of a positional that
+              gives the global index of every point.
+        */
+        class decomposition {
+            array<int, 3> m_global_sizes;
+            array<int, 3> m_halos;
+            array<int, 3> m_coords;
+            array<std::vector<int>, 3> m_bounds;
+
+          public:
+            /**
+               \param global_sizes The sizes of the global compute domain
+               \param grid The process grid
+               \param halos The widths of the halos, every process owns at least as many points
+               \param weights The weights of the global indices of every dimension, no weights for the even split
+            */
+            template <class Grid>
+            decomposition(array<int, 3> const &global_sizes,
+                Grid const &grid,
+                array<int, 3> const &halos = {0, 0, 0},
+                array<std::vector<double>, 3> const &weights = {})
+                : m_global_sizes(global_sizes), m_halos(halos) {
+                for (int d = 0; d < 3; ++d) {
+                    m_coords[d] = grid.coordinates(d);
+                    m_bounds[d] = decomposition_impl_::split(
+                        global_sizes[d], grid.dimensions(d), weights[d], std::max(halos[d], 1));
+                }
+            }
+
+            int global_size(int d) const { return m_global_sizes[d]; }
+
+            /** The size of the compute domain of the caller in the dimension `d` */
+            int local_size(int d) const { return local_size(d, m_coords[d]); }
+
+            /** The size of the compute domain of the processes of the coordinate `coord` in the dimension `d` */
+            int local_size(int d, int coord) const { return m_bounds[d][coord + 1] - m_bounds[d][coord]; }
+
+            /** The global index of the first point of the compute domain of the caller in the dimension `d` */
+            int global_offset(int d) const { return m_bounds[d][m_coords[d]]; }
+
+            /** The length of the dimension `d` of the storages of the caller, the halos included */
+            int total_length(int d) const { return local_size(d) + 2 * m_halos[d]; }
+
+            array<int, 3> total_lengths() const { return {total_length(0), total_length(1), total_length(2)}; }
+
+            /** The halo descriptor of the dimension `d` of the storages of the caller */
+            halo_descriptor halo(int d) const {
+                int h = m_halos[d];
+                return {uint_t(h), uint_t(h), uint_t(h), uint_t(h + local_size(d) - 1), uint_t(total_length(d))};
+            }
+
+            array<halo_descriptor, 3> halos() const { return {halo(0), halo(1), halo(2)}; }
+
+            /**
+               The value of the point 0 of the storage in the dimension `d` for a positional (of the stencil module)
+               that gives the global indices, the points of the halos before the domain having negative indices.
+            */
+            int positional_offset(int d) const { return global_offset(d) - m_halos[d]; }
+
+            /**
+               The ratio of the largest compute domain of the processes to the average one, 1 for a perfectly even
+               split of the points.
+            */
+            double imbalance() const {
+                double largest = 1, average = 1;
+                for (int d = 0; d < 3; ++d) {
+                    int parts = m_bounds[d].size() - 1, max_size = 0;
+                    for (int r = 0; r < parts; ++r)
+                        max_size = std::max(max_size, local_size(d, r));
+                    largest *= max_size;
+                    average *= double(m_global_sizes[d]) / parts;
+                }
+                return largest / average;
+            }
+        };
+
+        /**
+           The weights of the dimensions i and j of a global domain for the decomposition, from the costs `cost(i, j)`
+           of its columns: the weight of an index is the total cost of the columns that have it.
+        */
+        template <class Cost>
+        array<std::vector<double>, 3> column_weights(array<int, 3> const &global_sizes, Cost &&cost) {
+            array<std::vector<double>, 3> res;
+            res[0].assign(global_sizes[0], 0);
+            res[1].assign(global_sizes[1], 0);
+            for (int i = 0; i < global_sizes[0]; ++i)
+                for (int j = 0; j < global_sizes[1]; ++j) {
+                    double c = cost(i, j);
+                    res[0][i] += c;
+                    res[1][j] += c;
+                }
+            return res;
+        }
+    } // namespace gcl
+} // namespace gridtools
@@ -0,0 +1,277 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "../common/halo_descriptor.hpp"
+#include "low_level/data_types_mapping.hpp"
+
+/** \file
+    The collective input and output of the global fields distributed over the processes of a communicator, each
+    process owning the compute domain of its halo descriptors at some offset of the global array.
+
+    The files hold the global array in C order, the dimensions sorted by decreasing strides as the halo descriptors,
+    and are written and read by all the processes at once with MPI-IO subarray views, so that no process has to hold
+    the global array. For the diagnostics on a single process, the compute domains are gathered to (and scattered
+    from) a root process along a binomial tree, in log(P) rounds of messages.
+ */
+
+namespace gridtools {
+    namespace gcl {
+        namespace global_io_impl_ {
+            enum { headers_tag = 10, data_tag };
+
+            // the span of the subtree of the relative rank `rel` in the binomial tree: its lowest bit, or the smallest
+            // power of two not below `size` for the root
+            inline int subtree_span(int rel, int size) {
+                int res = 1;
+                while (res < size && !(rel & res))
+                    res <<= 1;
+                return res;
+            }
+
+            template <typename T>
+            std::vector<T> probe_recv(MPI_Datatype type, int source, int tag, MPI_Comm comm) {
+                MPI_Status status;
+                MPI_Probe(source, tag, comm, &status);
+                int count;
+                MPI_Get_count(&status, type, &count);
+                std::vector<T> res(count);
+                MPI_Recv(res.data(), count, type, source, tag, comm, MPI_STATUS_IGNORE);
+                return res;
+            }
+        } // namespace global_io_impl_
+
+        /** The collective reads, writes, gathers and scatters of a global array whose blocks are owned by the
+            processes of a communicator.
+
+            \tparam value_type The type of the elements of the fields
+
+            The local fields are laid out as described by the halo descriptors (sorted by decreasing strides, as in
+            all_to_all_halo), only their compute domains are read and written. All the member functions are
+            collective over the communicator.
+         */
+        template <typename value_type>
+        class global_io {
+            MPI_Comm m_comm;
+            int m_ndims;
+            std::vector<int> m_header;
+            MPI_Datatype m_value_type;
+            MPI_Datatype m_local_type;
+            MPI_Datatype m_file_type;
+            long long m_global_size = 1;
+            std::vector<int> m_global_sizes;
+
+            // the subarray of the global array filled by the compute domain described by `header`
+            MPI_Datatype block_type(int const *header) const {
+                std::vector<halo_descriptor> halo(m_ndims);
+                for (int i = 0; i < m_ndims; ++i)
+                    halo[i] = halo_descriptor(0, 0, 0, header[m_ndims + i] - 1, header[m_ndims + i]);
+                return make_datatype<value_type>::make_global(halo, m_global_sizes, header);
+            }
+
+            // the size of the header of a block in the messages of the tree: the offsets, the sizes and the bytes
+            int header_size() const { return 2 * m_ndims + 1; }
+
+          public:
+            /** \param comm The communicator of the processes that own the global field
+                \param halo The halo descriptors of the local fields
+                \param global_sizes The sizes of the global array
+                \param offsets The global indices of the first point of the compute domain of the calling process,
+                e.g. the global offsets of a gcl::decomposition
+             */
+            template <typename arraytype, typename sizestype, typename offsetstype>
+            global_io(MPI_Comm comm, arraytype const &halo, sizestype const &global_sizes, offsetstype const &offsets)
+                : m_ndims(halo.size()), m_header(2 * halo.size()), m_value_type(make_datatype<value_type>::type()),
+                  m_local_type(make_datatype<value_type>::make(halo)),
+                  m_file_type(make_datatype<value_type>::make_global(halo, global_sizes, offsets)),
+                  m_global_sizes(halo.size()) {
+                MPI_Comm_dup(comm, &m_comm);
+                for (int i = 0; i < m_ndims; ++i) {
+                    m_header[i] = offsets[i];
+                    m_header[m_ndims + i] = halo[i].end() - halo[i].begin() + 1;
+                    m_global_sizes[i] = global_sizes[i];
+                    m_global_size *= global_sizes[i];
+                }
+            }
+
+            global_io(global_io const &) = delete;
+            global_io &operator=(global_io const &) = delete;
+
+            ~global_io() {
+                int finalized;
+                MPI_Finalized(&finalized);
+                if (!finalized) {
+                    MPI_Type_free(&m_local_type);
+                    MPI_Type_free(&m_file_type);
+                    MPI_Comm_free(&m_comm);
+                }
+            }
+
+            /** The number of the elements of the global array */
+            long long global_size() const { return m_global_size; }
+
+            /** Writes the global array at the byte `displacement` of the file, created if it does not exist.
+
+                \param filename The name of the file
+                \param field Pointer to the local field
+                \param displacement The position in bytes of the global array in the file, so that a file can hold
+                several fields or time steps
+             */
+            void write(std::string const &filename, value_type const *field, MPI_Offset displacement = 0) const {
+                MPI_File file;
+                if (MPI_File_open(m_comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file))
+                    throw std::runtime_error("cannot open " + filename + " for writing");
+                MPI_File_set_view(file, displacement, m_value_type, m_file_type, "native", MPI_INFO_NULL);
+                MPI_File_write_all(file, field, 1, m_local_type, MPI_STATUS_IGNORE);
+                MPI_File_close(&file);
+            }
+
+            /** Reads the compute domain of the local field from the global array at the byte `displacement` of the
+                file, the halos of the field are untouched.
+             */
+            void read(std::string const &filename, value_type *field, MPI_Offset displacement = 0) const {
+                MPI_File file;
+                if (MPI_File_open(m_comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file))
+                    throw std::runtime_error("cannot open " + filename + " for reading");
+                MPI_File_set_view(file, displacement, m_value_type, m_file_type, "native", MPI_INFO_NULL);
+                MPI_File_read_all(file, field, 1, m_local_type, MPI_STATUS_IGNORE);
+                MPI_File_close(&file);
+            }
+
+            /** Gathers the compute domains of the local fields into the global array on the process `root`.
+                Every process packs its block and forwards the ones of its subtree to its parent, the root unpacks
+                them to their places in the global array.
+
+                \param field Pointer to the local field
+                \param result Pointer to the global array of global_size() elements, only used on the root
+                \param root The rank of the root process
+             */
+            void gather(value_type const *field, value_type *result, int root = 0) const {
+                int rank, size;
+                MPI_Comm_rank(m_comm, &rank);
+                MPI_Comm_size(m_comm, &size);
+                int rel = (rank - root + size) % size;
+
+                int bytes;
+                MPI_Pack_size(1, m_local_type, m_comm, &bytes);
+                std::vector<char> data(bytes);
+                int position = 0;
+                MPI_Pack(field, 1, m_local_type, data.data(), bytes, &position, m_comm);
+                data.resize(position);
+                std::vector<int> headers = m_header;
+                headers.push_back(position);
+
+                for (int mask = 1; mask < size; mask <<= 1) {
+                    if (rel & mask) {
+                        int parent = (rank - mask + size) % size;
+                        MPI_Send(
+                            headers.data(), int(headers.size()), MPI_INT, parent, global_io_impl_::headers_tag, m_comm);
+                        MPI_Send(data.data(), int(data.size()), MPI_PACKED, parent, global_io_impl_::data_tag, m_comm);
+                        return;
+                    }
+                    if (rel + mask < size) {
+                        int child = (rank + mask) % size;
+                        auto child_headers =
+                            global_io_impl_::probe_recv<int>(MPI_INT, child, global_io_impl_::headers_tag, m_comm);
+                        auto child_data =
+                            global_io_impl_::probe_recv<char>(MPI_PACKED, child, global_io_impl_::data_tag, m_comm);
+                        headers.insert(headers.end(), child_headers.begin(), child_headers.end());
+                        data.insert(data.end(), child_data.begin(), child_data.end());
+                    }
+                }
+
+                position = 0;
+                for (std::size_t h = 0; h < headers.size(); h += header_size()) {
+                    MPI_Datatype type = block_type(&headers[h]);
+                    MPI_Unpack(data.data(), data.size(), &position, result, 1, type, m_comm);
+                    MPI_Type_free(&type);
+                }
+            }
+
+            /** Scatters the global array on the process `root` into the compute domains of the local fields, the
+                halos of the fields are untouched. The root packs the blocks of all the processes, which are
+                forwarded along the same tree as for gather.
+
+                \param global Pointer to the global array of global_size() elements, only used on the root
+                \param field Pointer to the local field
+                \param root The rank of the root process
+             */
+            void scatter(value_type const *global, value_type *field, int root = 0) const {
+                int rank, size;
+                MPI_Comm_rank(m_comm, &rank);
+                MPI_Comm_size(m_comm, &size);
+                int rel = (rank - root + size) % size;
+                int mask = global_io_impl_::subtree_span(rel, size);
+
+                // the headers and the packed blocks of the subtree, in the order of the relative ranks
+                std::vector<int> headers;
+                std::vector<char> data;
+                std::vector<int> all(rel ? 0 : size * 2 * m_ndims);
+                MPI_Gather(m_header.data(), 2 * m_ndims, MPI_INT, all.data(), 2 * m_ndims, MPI_INT, root, m_comm);
+                if (rel) {
+                    int parent = (rank - mask + size) % size;
+                    headers = global_io_impl_::probe_recv<int>(MPI_INT, parent, global_io_impl_::headers_tag, m_comm);
+                    data = global_io_impl_::probe_recv<char>(MPI_PACKED, parent, global_io_impl_::data_tag, m_comm);
+                } else {
+                    for (int r = 0; r < size; ++r) {
+                        int const *header = &all[(r + root) % size * 2 * m_ndims];
+                        MPI_Datatype type = block_type(header);
+                        int bytes;
+                        MPI_Pack_size(1, type, m_comm, &bytes);
+                        std::size_t start = data.size();
+                        data.resize(start + bytes);
+                        int position = 0;
+                        MPI_Pack(global, 1, type, data.data() + start, bytes, &position, m_comm);
+                        MPI_Type_free(&type);
+                        data.resize(start + position);
+                        headers.insert(headers.end(), header, header + 2 * m_ndims);
+                        headers.push_back(position);
+                    }
+                }
+
+                // the offsets of the blocks in the headers and in the data
+                int blocks = headers.size() / header_size();
+                std::vector<std::size_t> starts(blocks + 1, 0);
+                for (int b = 0; b < blocks; ++b)
+                    starts[b + 1] = starts[b] + headers[b * header_size() + 2 * m_ndims];
+
+                // the children get the blocks of their subtrees, the largest subtree first
+                for (int m = mask >> 1; m > 0; m >>= 1) {
+                    if (rel + m >= size)
+                        continue;
+                    int child = (rank + m) % size;
+                    int last = std::min(2 * m, blocks);
+                    MPI_Send(&headers[m * header_size()],
+                        (last - m) * header_size(),
+                        MPI_INT,
+                        child,
+                        global_io_impl_::headers_tag,
+                        m_comm);
+                    MPI_Send(data.data() + starts[m],
+                        starts[last] - starts[m],
+                        MPI_PACKED,
+                        child,
+                        global_io_impl_::data_tag,
+                        m_comm);
+                }
+
+                int position = 0;
+                MPI_Unpack(data.data(), starts[1], &position, field, 1, m_local_type, m_comm);
+            }
+        };
+    } // namespace gcl
+} // namespace gridtools
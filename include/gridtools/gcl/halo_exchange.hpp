@@ -13,11 +13,13 @@
 
 #include "../common/halo_descriptor.hpp"
 #include "../common/layout_map.hpp"
+#include "../thread_pool/omp.hpp"
 #include "high_level/descriptor_generic_manual.hpp"
 #include "high_level/descriptors.hpp"
 #include "high_level/descriptors_manual_gpu.hpp"
 #include "high_level/field_on_the_fly.hpp"
 #include "low_level/Halo_Exchange_3D.hpp"
+#include "low_level/Halo_Exchange_3D_threads.hpp"
 #include "low_level/arch.hpp"
 #include "low_level/proc_grids_3D.hpp"
 
@@ -153,13 +155,15 @@ namespace gridtools {
            dimension in the processor grid \tparam DataType Value type the elements int the arrays \tparam DIMS Number
            of dimensions of data arrays (equal to the dimension of the processor grid) \tparam GCL_ARCH Specification of
            the "architecture", that is the place where the data to be exchanged is. Possible coiches are defined in
-           low_level/gcl_arch.h .
+           low_level/gcl_arch.h . \tparam GridType The process grid: MPI_3D_process_grid_t or, for the subdomains
+           owned by the threads of a single process, thread_3D_process_grid_t (CPU only).
         */
         template <typename T_layout_map,
             typename layout2proc_map_abs,
             typename DataType,
             typename Gcl_Arch = cpu,
-            int version = 0>
+            int version = 0,
+            typename GridType = MPI_3D_process_grid_t<3>>
         class halo_exchange_dynamic_ut {
             // This is necessary since the internals of gcl use "increasing stride order" instead of "decreasing stride
             // order"
@@ -170,7 +174,7 @@ namespace gridtools {
             /**
                Type of the computin grid associated to the pattern
             */
-            typedef MPI_3D_process_grid_t<3> grid_type;
+            typedef GridType grid_type;
 
             static constexpr int DIMS = 3;
 
@@ -197,9 +201,10 @@ namespace gridtools {
                 layout_map passed to the class.
 
                 \param[in] c Periodicity specification as in \link boollist_concept \endlink
-                \param[in] comm MPI CART communicator with dimension 3
+                \param[in] comm MPI CART communicator with dimension 3, or the communicator of the process grid
             */
-            explicit halo_exchange_dynamic_ut(typename grid_type::period_type const &c, MPI_Comm const &comm)
+            explicit halo_exchange_dynamic_ut(
+                typename grid_type::period_type const &c, typename grid_type::communicator_type const &comm)
                 : hd(c.template permute<layout2proc_map_abs>(), comm) {}
 
             /** Function to rerturn the L3 level pattern used inside the pattern itself.
@@ -275,6 +280,32 @@ namespace gridtools {
             */
             void unpack(std::vector<DataType *> const &fields) { hd.unpack(fields); }
 
+            /**
+               Function to start the direct packing of the fields, that replaces pack(): the computation passes the
+               values it stores into the fields also to write_halo(), which puts them in the send buffers of the halos
+               that contain them, so that no pass over the halos is needed before start_exchange(). CPU only. The
+               stencils do it through boundaries::direct_pack_sid, see boundaries::distributed_boundaries::direct_pack.
+
+               \param[in] n_fields The number of the fields to be exchanged
+            */
+            void begin_direct_pack(int n_fields) { hd.begin_direct_pack(n_fields); }
+
+            /**
+               Function to pass a value stored into a field during the direct packing to the send buffers. The
+               coordinates are in the logical order chosen by the application, as in add_halo().
+
+               \param[in] field The index of the field in the exchange
+               \param[in] i, j, k The coordinates of the point
+               \param[in] value The value
+            */
+            void write_halo(int field, int i, int j, int k, DataType const &value) {
+                int crds[DIMS];
+                crds[layout_map::at(0)] = i;
+                crds[layout_map::at(1)] = j;
+                crds[layout_map::at(2)] = k;
+                hd.write_halo(field, crds[0], crds[1], crds[2], value);
+            }
+
             /**
                function to trigger data exchange
 
@@ -303,6 +334,61 @@ namespace gridtools {
             */
             void wait() { hd.wait(); }
 
+            /**
+               function to switch to the persistent MPI requests: the requests are created on the first exchange and
+               every following exchange with the same number of fields only starts and completes them.
+               Must not be called between start_exchange() and wait().
+            */
+            void use_persistent_requests(bool value = true) { hd.use_persistent_requests(value); }
+
+            /**
+               function to switch the exchange with the neighbors on the same node to the MPI-3 shared memory:
+               the halos are packed straight into a shared window, that the neighbor reads them from instead of
+               receiving MPI messages. The neighbors on the other nodes are not affected. Collective, must be called
+               after setup() and not between start_exchange() and wait(). Has no effect on the face exchange mode,
+               available for the cpu architecture only.
+            */
+            void use_shared_memory(bool value = true) { hd.use_shared_memory(value); }
+
+            /**
+               function to switch to a progress thread, that tests the MPI requests between start_exchange() and
+               wait() so that the messages are transferred while the caller computes. The caller must not call MPI
+               in between. Requires MPI_THREAD_SERIALIZED. Must not be called between start_exchange() and wait().
+               Has no effect on the exchange through the MPI datatypes. `pool` is the thread pool of the computation,
+               that lends a core to the progress thread (see thread_pool::reserve_core).
+            */
+            template <class ThreadPool = thread_pool::omp>
+            void use_progress_thread(bool value = true, ThreadPool pool = {}) {
+                hd.use_progress_thread(value, pool);
+            }
+
+            /**
+               function to switch to the exchange with the six face neighbors only, in three dimension ordered phases
+               that forward the edges and the corners of the halos. Six messages are sent per exchange instead of 26.
+               Only the first phase overlaps with the computation between start_exchange() and wait(), the remaining
+               ones are completed by unpack(). Not available for the GPU.
+            */
+            void use_face_exchange(bool value = true) { hd.use_face_exchange(value); }
+
+            /**
+               function to switch to the exchange without the pack and unpack buffers: the halos are sent from and
+               received into the fields directly, described by MPI subarray datatypes. pack() only records the fields
+               and unpack() does nothing, so the fields must not be modified between start_exchange() and wait().
+               Only available on the MPI process grids and not for the GPU.
+            */
+            void use_datatypes(bool value = true) { hd.use_datatypes(value); }
+
+            /**
+               function to send the halos of the fields in a reduced precision (float, bfloat16 or the upper half of
+               the representation), per field in the order of pack() or for all the fields. The values are converted
+               back on unpack(). Lossy, for the float and double fields only. Not available for the GPU.
+            */
+            void use_halo_precision(std::vector<halo_precision> precisions) {
+                hd.use_halo_precision(std::move(precisions));
+            }
+
+            void use_halo_precision(halo_precision precision) { hd.use_halo_precision(precision); }
+
             grid_type const &comm() const { return hd.comm(); }
         };
 
@@ -461,6 +547,33 @@ namespace gridtools {
                and vice versa.
             */
             void wait() { hd.wait(); }
+
+            /**
+               function to switch to the persistent MPI requests: the requests are created on the first exchange and
+               every following exchange with the same number of fields only starts and completes them.
+               Must not be called between start_exchange() and wait().
+            */
+            void use_persistent_requests(bool value = true) { hd.use_persistent_requests(value); }
+
+            /**
+               function to switch the exchange with the neighbors on the same node to the MPI-3 shared memory:
+               the halos are packed straight into a shared window, that the neighbor reads them from instead of
+               receiving MPI messages. The neighbors on the other nodes are not affected. Collective, must be called
+               after setup() and not between start_exchange() and wait(). Has no effect on the face exchange mode,
+               available for the cpu architecture only.
+            */
+            void use_shared_memory(bool value = true) { hd.use_shared_memory(value); }
+
+            /**
+               function to switch to a progress thread, that tests the MPI requests between start_exchange() and
+               wait() so that the messages are transferred while the caller computes. The caller must not call MPI
+               in between. Requires MPI_THREAD_SERIALIZED. Must not be called between start_exchange() and wait().
+               `pool` is the thread pool of the computation, that lends a core to the progress thread.
+            */
+            template <class ThreadPool = thread_pool::omp>
+            void use_progress_thread(bool value = true, ThreadPool pool = {}) {
+                hd.use_progress_thread(value, pool);
+            }
         };
 
         template <typename layout2proc_map, typename Gcl_Arch = cpu>
@@ -0,0 +1,187 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "../../common/array.hpp"
+#include "../../common/halo_descriptor.hpp"
+#include "../low_level/translate.hpp"
+#include "descriptor_base.hpp"
+#include "helpers_impl.hpp"
+#include "numerics.hpp"
+
+namespace gridtools {
+    namespace gcl {
+        /**
+           The description of a field of the aggregated exchange, independent of its value type and its layout: the
+           address of the element (0, 0, 0), the size of an element in bytes, and the halos and the strides (in
+           elements) of the dimensions in the logical order.
+        */
+        struct byte_field {
+            char *m_ptr;
+            int m_element_size;
+            array<halo_descriptor, 3> m_halos;
+            array<int, 3> m_strides;
+        };
+
+        /**
+           Makes the byte_field of the field at `ptr`. The field is only read if it is passed to
+           hndlr_aggregated::pack, so `ptr` can point to const.
+        */
+        template <typename T, typename Strides>
+        byte_field make_byte_field(T *ptr, array<halo_descriptor, 3> const &halos, Strides const &strides) {
+            return {reinterpret_cast<char *>(const_cast<std::remove_const_t<T> *>(ptr)),
+                int(sizeof(T)),
+                halos,
+                {int(strides[0]), int(strides[1]), int(strides[2])}};
+        }
+
+        /**
+           The halo exchange of the fields with different value types, layouts and halo widths. The halos of all the
+           fields that go to a neighbor are packed byte-wise into a single buffer, so that an exchange is a single
+           round of messages of the underlying Level 3 pattern, whatever the number and the kinds of the fields.
+
+           The buffers grow to the largest exchange seen and the message sizes are set by every pack(), so that the
+           fields can change from an exchange to the next one. The data must be in the host memory.
+
+           \tparam HaloExch The Level 3 pattern
+           \tparam proc_layout The layout_map from the logical dimensions of the fields to the dimensions of the
+           process grid
+        */
+        template <typename HaloExch, typename proc_layout>
+        class hndlr_aggregated : public descriptor_base<HaloExch> {
+            static constexpr int DIMS = 3;
+
+            typedef descriptor_base<HaloExch> base_type;
+            typedef translate_t<DIMS> translate;
+
+            std::vector<char> m_send[static_pow3(DIMS)];
+            std::vector<char> m_recv[static_pow3(DIMS)];
+
+          public:
+            typedef typename base_type::grid_type grid_type;
+
+            /**
+               \param[in] c The periodicity of the process grid
+               \param[in] comm The communicator of the process grid
+            */
+            hndlr_aggregated(
+                typename grid_type::period_type const &c, typename grid_type::communicator_type const &comm)
+                : base_type(c, comm) {}
+
+            hndlr_aggregated(hndlr_aggregated const &) = delete;
+            hndlr_aggregated &operator=(hndlr_aggregated const &) = delete;
+
+            /**
+               Packs the halos of the fields into the send buffers and sets the sizes of the messages.
+
+               \param[in] fields The fields to be exchanged
+            */
+            void pack(std::vector<byte_field> const &fields) {
+                for_each_neighbor([&](array<int, DIMS> const &eta, int I, int J, int K) {
+                    int dir = translate()(eta[0], eta[1], eta[2]);
+                    std::size_t send_size = 0, recv_size = 0;
+                    for (auto const &field : fields) {
+                        send_size += region_size(field, eta, true);
+                        recv_size += region_size(field, eta, false);
+                    }
+                    if (m_send[dir].size() < send_size)
+                        m_send[dir].resize(send_size);
+                    if (m_recv[dir].size() < recv_size)
+                        m_recv[dir].resize(recv_size);
+                    base_type::m_haloexch.register_send_to_buffer(m_send[dir].data(), send_size, I, J, K);
+                    base_type::m_haloexch.register_receive_from_buffer(m_recv[dir].data(), recv_size, I, J, K);
+
+                    char *it = base_type::m_haloexch.send_buffer(I, J, K);
+                    for (auto const &field : fields)
+                        for_each_run(field, eta, true, [&](char *run, std::size_t size) {
+                            std::memcpy(it, run, size);
+                            it += size;
+                        });
+                });
+            }
+
+            /**
+               Unpacks the received halos into the fields, which must be the ones passed to pack().
+
+               \param[in] fields The fields to be exchanged
+            */
+            void unpack(std::vector<byte_field> const &fields) {
+                for_each_neighbor([&](array<int, DIMS> const &eta, int, int, int) {
+                    char const *it = m_recv[translate()(eta[0], eta[1], eta[2])].data();
+                    for (auto const &field : fields)
+                        for_each_run(field, eta, false, [&](char *run, std::size_t size) {
+                            std::memcpy(run, it, size);
+                            it += size;
+                        });
+                });
+            }
+
+          private:
+            // calls `f(eta, I, J, K)` for the directions with a neighbor, (I, J, K) being the direction in the grid
+            template <typename F>
+            void for_each_neighbor(F f) const {
+                for (int ii = -1; ii <= 1; ++ii)
+                    for (int jj = -1; jj <= 1; ++jj)
+                        for (int kk = -1; kk <= 1; ++kk) {
+                            const int ii_P = nth<proc_layout, 0>(ii, jj, kk);
+                            const int jj_P = nth<proc_layout, 1>(ii, jj, kk);
+                            const int kk_P = nth<proc_layout, 2>(ii, jj, kk);
+                            if ((ii != 0 || jj != 0 || kk != 0) &&
+                                base_type::pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)
+                                f(array<int, DIMS>{ii, jj, kk}, ii_P, jj_P, kk_P);
+                        }
+            }
+
+            static void bounds(byte_field const &field, array<int, DIMS> const &eta, bool inside, int (&lo)[DIMS],
+                int (&hi)[DIMS]) {
+                for (int d = 0; d < DIMS; ++d) {
+                    auto const &h = field.m_halos[d];
+                    lo[d] = inside ? h.loop_low_bound_inside(eta[d]) : h.loop_low_bound_outside(eta[d]);
+                    hi[d] = inside ? h.loop_high_bound_inside(eta[d]) : h.loop_high_bound_outside(eta[d]);
+                }
+            }
+
+            static std::size_t region_size(byte_field const &field, array<int, DIMS> const &eta, bool inside) {
+                int lo[DIMS], hi[DIMS];
+                bounds(field, eta, inside, lo, hi);
+                std::size_t res = field.m_element_size;
+                for (int d = 0; d < DIMS; ++d)
+                    res *= std::max(hi[d] - lo[d] + 1, 0);
+                return res;
+            }
+
+            /*
+             * Calls `f(address, size)` for the contiguous runs of the halo region of the field, that are the rows
+             * along the dimension with the unit stride (the single elements if there is no such dimension).
+             */
+            template <typename F>
+            static void for_each_run(byte_field const &field, array<int, DIMS> const &eta, bool inside, F f) {
+                int lo[DIMS], hi[DIMS];
+                bounds(field, eta, inside, lo, hi);
+                auto const &s = field.m_strides;
+                int u = int(std::min_element(s.begin(), s.end()) - s.begin());
+                int a = u == 0 ? 1 : 0, b = u == 2 ? 1 : 2;
+                int run = s[u] == 1 ? std::max(hi[u] - lo[u] + 1, 0) : 1;
+                if (run == 0)
+                    return;
+                for (int x = lo[a]; x <= hi[a]; ++x)
+                    for (int y = lo[b]; y <= hi[b]; ++y)
+                        for (int z = lo[u]; z <= hi[u]; z += run)
+                            f(field.m_ptr + (long(x) * s[a] + long(y) * s[b] + long(z) * s[u]) * field.m_element_size,
+                                std::size_t(run) * field.m_element_size);
+            }
+        };
+    } // namespace gcl
+} // namespace gridtools
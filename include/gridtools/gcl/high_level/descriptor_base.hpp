@@ -11,6 +11,8 @@
 
 #include <mpi.h>
 
+#include "../../thread_pool/omp.hpp"
+
 namespace gridtools {
     namespace gcl {
         /**
@@ -31,7 +33,8 @@ namespace gridtools {
           public:
             pattern_type m_haloexch; // TODO private
 
-            descriptor_base(typename grid_type::period_type const &c, MPI_Comm const &comm)
+            descriptor_base(
+                typename grid_type::period_type const &c, typename grid_type::communicator_type const &comm)
                 : m_grid(grid_type(c, comm)), m_haloexch(m_grid) {}
 
             descriptor_base(grid_type const &g) : m_grid(g), m_haloexch(g) {}
@@ -70,6 +73,27 @@ namespace gridtools {
             */
             void wait() { m_haloexch.wait(); }
 
+            /**
+               function to switch the underlying pattern to the persistent MPI requests, that are created once and
+               only started and completed by every exchange.
+            */
+            void use_persistent_requests(bool value = true) { m_haloexch.use_persistent_requests(value); }
+
+            /**
+               function to switch the underlying pattern to the MPI-3 shared memory for the neighbors that run on
+               the same node. Collective, must be called after the setup.
+            */
+            void use_shared_memory(bool value = true) { m_haloexch.use_shared_memory(value); }
+
+            /**
+               function to switch the underlying pattern to the progress thread, that drives the MPI requests
+               between start_exchange() and wait().
+            */
+            template <class ThreadPool = thread_pool::omp>
+            void use_progress_thread(bool value = true, ThreadPool pool = {}) {
+                m_haloexch.use_progress_thread(value, pool);
+            }
+
             /**
                Retrieve the pattern from which the computing grid and other information
                can be retrieved. The function is available only if the underlying
@@ -209,13 +209,13 @@ namespace gridtools {
                 }
             }
 
-            template <typename... FIELDS>
-            void pack(const FIELDS &... _fields) const {
+            template <typename FIELD, typename... FIELDS>
+            void pack(const FIELD &first, const FIELDS &... _fields) const {
                 for (int ii = -1; ii <= 1; ++ii) {
                     for (int jj = -1; jj <= 1; ++jj) {
                         for (int kk = -1; kk <= 1; ++kk) {
-                            char *it = reinterpret_cast<char *>(&(send_buffer[translate()(ii, jj, kk)][0]));
-                            pack_dims<DIMS, 0>()(*this, ii, jj, kk, it, _fields...);
+                            char *it = send_buffer_to<typename FIELD::inner_layoutmap>(ii, jj, kk);
+                            pack_dims<DIMS, 0>()(*this, ii, jj, kk, it, first, _fields...);
                         }
                     }
                 }
@@ -246,7 +246,8 @@ namespace gridtools {
                         for (int kk = -1; kk <= 1; ++kk) {
                             typename field_on_the_fly<T1, T2, T3>::value_type *it =
                                 reinterpret_cast<typename field_on_the_fly<T1, T2, T3>::value_type *>(
-                                    &(send_buffer[translate()(ii, jj, kk)][0]));
+                                    send_buffer_to<typename field_on_the_fly<T1, T2, T3>::inner_layoutmap>(
+                                        ii, jj, kk));
                             pack_vector_dims<DIMS, 0>()(*this, ii, jj, kk, it, fields);
                         }
                     }
@@ -274,6 +275,15 @@ namespace gridtools {
             }
 
           private:
+            // the buffer into which the halos of the fields with the given layout are packed, see
+            // Halo_Exchange_3D::send_buffer
+            template <typename FieldLayout>
+            char *send_buffer_to(int ii, int jj, int kk) const {
+                using proc_layout = layout_transform<FieldLayout, proc_layout_abs>;
+                return base_type::m_haloexch.send_buffer(
+                    nth<proc_layout, 0>(ii, jj, kk), nth<proc_layout, 1>(ii, jj, kk), nth<proc_layout, 2>(ii, jj, kk));
+            }
+
             template <int, int>
             struct pack_dims {};
 
@@ -390,6 +400,9 @@ namespace gridtools {
             void *halo_d_r; // pointer to halo descr on device
 
           public:
+            // the halos are packed on the device, not into the shared window of the host
+            void use_shared_memory(bool = true) = delete;
+
             typedef descriptor_base<HaloExch> base_type;
             typedef typename base_type::pattern_type pattern_type;
 
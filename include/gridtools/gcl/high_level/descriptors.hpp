@@ -9,15 +9,20 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include "../../common/array.hpp"
 #include "../low_level/Halo_Exchange_3D.hpp"
+#include "../low_level/communicator.hpp"
 #include "../low_level/proc_grids_3D.hpp"
 #include "../low_level/translate.hpp"
 #include "access.hpp"
 #include "descriptor_base.hpp"
 #include "empty_field_base.hpp"
+#include "halo_precision.hpp"
 #include "helpers_impl.hpp"
 #include "numerics.hpp"
 
@@ -381,6 +386,36 @@ namespace gridtools {
             array<int, static_pow3(DIMS)> send_size;
             array<int, static_pow3(DIMS)> recv_size;
 
+            // the state of the face exchange, see use_face_exchange
+            bool m_face_exchange = false;
+            std::vector<DataType const *> m_face_fields;
+            std::vector<DataType> m_face_send[2];
+            std::vector<DataType> m_face_recv[2];
+            typename GridType::request_type m_face_requests[4];
+            int m_face_requests_n = 0;
+
+            // the state of the datatype exchange, see use_datatypes
+            bool m_datatype_exchange = false;
+            MPI_Datatype m_dt_element = MPI_DATATYPE_NULL;
+            MPI_Datatype m_dt_inside[static_pow3(DIMS)];
+            MPI_Datatype m_dt_outside[static_pow3(DIMS)];
+            std::vector<DataType const *> m_dt_pending;
+            std::vector<DataType const *> m_dt_fields;
+            MPI_Datatype m_dt_send[static_pow3(DIMS)];
+            MPI_Datatype m_dt_recv[static_pow3(DIMS)];
+            MPI_Request m_dt_requests[2 * static_pow3(DIMS)];
+            int m_dt_requests_n = 0;
+
+            using is_mpi_grid_t = std::is_same<typename GridType::communicator_type, MPI_Comm>;
+
+            // the precisions of the halos of the fields, see use_halo_precision
+            std::vector<halo_precision> m_precisions;
+            halo_precision m_default_precision = halo_precision::full;
+            std::vector<int> m_field_bytes;
+
+            // the directions with a neighbor, see begin_direct_pack
+            array<bool, static_pow3(DIMS)> m_direct_send;
+
           public:
             typedef cpu arch_type;
             typedef descriptor_base<HaloExch> base_type;
@@ -405,12 +440,21 @@ namespace gridtools {
                Constructor
 
                \param[in] c The object of the class used to specify periodicity in each dimension
-               \param[in] comm MPI communicator (typically MPI_Comm_world)
+               \param[in] comm MPI communicator (typically MPI_Comm_world) or the communicator of the process grid
             */
-            explicit hndlr_dynamic_ut(typename grid_type::period_type const &c, MPI_Comm const &comm)
-                : base_type(c, comm), halo(), send_buffer{nullptr}, recv_buffer{nullptr}, send_size{0}, recv_size{0} {}
+            explicit hndlr_dynamic_ut(
+                typename grid_type::period_type const &c, typename grid_type::communicator_type const &comm)
+                : base_type(c, comm), halo(), send_buffer{nullptr}, recv_buffer{nullptr}, send_size{0}, recv_size{0} {
+                dt_reset();
+            }
 
-            ~hndlr_dynamic_ut() { _destroy_dynamic_ut<DIMS, 0>().do_it(this); }
+            ~hndlr_dynamic_ut() {
+                _destroy_dynamic_ut<DIMS, 0>().do_it(this);
+                int finalized;
+                MPI_Finalized(&finalized);
+                if (!finalized)
+                    dt_free();
+            }
 
             /**
                Constructor
@@ -421,7 +465,9 @@ namespace gridtools {
              */
             explicit hndlr_dynamic_ut(typename grid_type::period_type const &c, int _P, int _pid)
                 : halo(), base_type::m_haloexch(grid_type(c, _P, _pid)), send_buffer{nullptr},
-                  recv_buffer{nullptr}, send_size{0}, recv_size{0} {}
+                  recv_buffer{nullptr}, send_size{0}, recv_size{0} {
+                dt_reset();
+            }
 
             /**
                Constructor
@@ -429,8 +475,10 @@ namespace gridtools {
                \param[in] g A processor grid that will execute the pattern
              */
             explicit hndlr_dynamic_ut(grid_type const &g)
-                : halo(), base_type::m_haloexch(g), send_buffer{nullptr}, recv_buffer{nullptr}, send_size{0}, recv_size{
-                                                                                                                  0} {}
+                : halo(), base_type::m_haloexch(g), send_buffer{nullptr}, recv_buffer{nullptr}, send_size{0},
+                  recv_size{0} {
+                dt_reset();
+            }
 
             /**
                Function to setup internal data structures for data exchange and preparing eventual underlying layers
@@ -446,7 +494,12 @@ namespace gridtools {
             */
             template <typename... FIELDS>
             void pack(const FIELDS &... _fields) {
-                pack_dims<DIMS, 0>()(*this, _fields...);
+                if (m_datatype_exchange)
+                    m_dt_pending = {_fields...};
+                else if (m_face_exchange)
+                    face_pack({_fields...});
+                else
+                    pack_fields({_fields...});
             }
 
             /**
@@ -455,8 +508,13 @@ namespace gridtools {
                \param[in] _fields data fields where to unpack data
             */
             template <typename... FIELDS>
-            void unpack(const FIELDS &... _fields) const {
-                unpack_dims<DIMS, 0>()(*this, _fields...);
+            void unpack(const FIELDS &... _fields) {
+                if (m_datatype_exchange)
+                    return;
+                if (m_face_exchange)
+                    face_unpack(std::vector<DataType *>{_fields...});
+                else
+                    unpack_fields({_fields...});
             }
 
             /**
@@ -464,14 +522,191 @@ namespace gridtools {
 
                \param[in] fields vector with data fields pointers to be packed from
             */
-            void pack(std::vector<DataType *> const &fields) { pack_vector_dims<DIMS, 0>()(*this, fields); }
+            void pack(std::vector<DataType *> const &fields) {
+                if (m_datatype_exchange)
+                    m_dt_pending.assign(fields.begin(), fields.end());
+                else if (m_face_exchange)
+                    face_pack(std::vector<DataType const *>(fields.begin(), fields.end()));
+                else
+                    pack_fields(std::vector<DataType const *>(fields.begin(), fields.end()));
+            }
 
             /**
                Function to unpack received data
 
                \param[in] fields vector with data fields pointers to be unpacked into
             */
-            void unpack(std::vector<DataType *> const &fields) { unpack_vector_dims<DIMS, 0>()(*this, fields); }
+            void unpack(std::vector<DataType *> const &fields) {
+                if (m_datatype_exchange)
+                    return;
+                if (m_face_exchange)
+                    face_unpack(fields);
+                else
+                    unpack_fields(fields);
+            }
+
+            /**
+               Switches to the exchange with the six face neighbors only. The halos are exchanged in three phases,
+               one dimension after another (in the increasing stride order). The messages of the later phases include
+               the halos received in the earlier ones, so that the edges and the corners of the halos are forwarded
+               through the face neighbors. This reduces the number of messages from 26 to 6 per exchange, at the
+               price of the phases being sequential.
+
+               Only the first phase is overlapped with the computation when start_exchange() and wait() are used: the
+               remaining ones are done by unpack().
+               The result is the same as the one of the exchange with all the neighbors.
+
+               \param[in] value Whether the face exchange is used
+            */
+            void use_face_exchange(bool value = true) { m_face_exchange = value; }
+
+            /**
+               Switches to the exchange without the intermediate buffers. The halo regions of every direction are
+               described by MPI subarray datatypes, built once at the first exchange, and the messages are sent from
+               and received into the memory of the fields directly. The datatypes of the fields of an exchange are
+               combined into one message per direction with MPI_Type_create_hindexed_block on the absolute addresses
+               of the fields. They are rebuilt only when the fields differ from the ones of the previous exchange.
+
+               pack() only records the fields and unpack() has nothing to do: the fields must not be modified
+               between start_exchange() and wait(). Takes precedence over the face exchange. Only available on the
+               MPI process grids. Must not be called between pack() and unpack().
+
+               \param[in] value Whether the datatype exchange is used
+            */
+            void use_datatypes(bool value = true) {
+                if (value && !is_mpi_grid_t::value)
+                    throw std::runtime_error("the datatype exchange requires an MPI process grid");
+                m_datatype_exchange = value;
+            }
+
+            /**
+               Sets the precision in which the halos of the fields are sent, see halo_precision.hpp. The entries of
+               `precisions` apply to the fields in the order they are passed to pack() and unpack(), the other fields
+               are sent in full precision. The reduced precisions are lossy and are available for the float and double
+               fields only. All the processes must use the same precisions for the same fields.
+
+               Applies to the exchange with the pack and unpack buffers, not to the face and the datatype exchanges.
+               Must not be called between pack() and unpack().
+
+               \param[in] precisions The precisions of the fields
+            */
+            void use_halo_precision(std::vector<halo_precision> precisions) {
+                for (auto p : precisions)
+                    check_halo_precision<DataType>(p);
+                m_precisions = std::move(precisions);
+                m_default_precision = halo_precision::full;
+            }
+
+            /**
+               Sets the precision in which the halos of all the fields are sent.
+
+               \param[in] precision The precision of the fields
+            */
+            void use_halo_precision(halo_precision precision) {
+                check_halo_precision<DataType>(precision);
+                m_precisions.clear();
+                m_default_precision = precision;
+            }
+
+            /**
+               Starts the direct packing of `n_fields` fields, that replaces pack(): the computation that stores the
+               values of the fields also passes them to write_halo(), which puts them into the send buffers of the
+               halos that contain them. This saves the pass of pack() over the halos after the computation. All the
+               points of the send regions of all the fields must be written before start_exchange(); unpack() is done
+               as usual.
+
+               Not available with the face and the datatype exchanges.
+
+               \param[in] n_fields The number of the fields, at most the one passed to setup()
+            */
+            void begin_direct_pack(int n_fields) {
+                if (m_face_exchange || m_datatype_exchange)
+                    throw std::runtime_error("the direct packing requires the exchange with the buffers");
+                update_field_bytes(n_fields);
+                for (int ii = -1; ii <= 1; ++ii)
+                    for (int jj = -1; jj <= 1; ++jj)
+                        for (int kk = -1; kk <= 1; ++kk) {
+                            const int ii_P = nth<proc_layout, 0>(ii, jj, kk);
+                            const int jj_P = nth<proc_layout, 1>(ii, jj, kk);
+                            const int kk_P = nth<proc_layout, 2>(ii, jj, kk);
+                            int dir = translate()(ii, jj, kk);
+                            m_direct_send[dir] = (ii != 0 || jj != 0 || kk != 0) &&
+                                                 base_type::pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1;
+                            if (!m_direct_send[dir])
+                                continue;
+                            base_type::m_haloexch.set_send_to_size(
+                                send_size[dir] * m_field_bytes[n_fields], ii_P, jj_P, kk_P);
+                            base_type::m_haloexch.set_receive_from_size(
+                                recv_size[dir] * m_field_bytes[n_fields], ii_P, jj_P, kk_P);
+                        }
+            }
+
+            /**
+               Passes a value stored into a field during the direct packing, see begin_direct_pack. If the point lies
+               in the halos sent to some neighbors, the value is put in their send buffers; the field itself is not
+               written.
+
+               \param[in] field The index of the field in the exchange
+               \param[in] i The coordinate in the first dimension, in the increasing stride order
+               \param[in] j The coordinate in the second dimension, in the increasing stride order
+               \param[in] k The coordinate in the third dimension, in the increasing stride order
+               \param[in] value The value
+            */
+            void write_halo(int field, int i, int j, int k, DataType const &value) {
+                auto const &h = halo.halos;
+                // the range of the directions of the send regions that contain the point in every dimension
+                int crds[DIMS] = {i, j, k}, lo[DIMS], hi[DIMS];
+                for (int d = 0; d < DIMS; ++d) {
+                    if (crds[d] < (int)h[d].begin() || crds[d] > (int)h[d].end())
+                        return;
+                    lo[d] = crds[d] <= h[d].loop_high_bound_inside(-1) ? -1 : 0;
+                    hi[d] = crds[d] >= h[d].loop_low_bound_inside(1) ? 1 : 0;
+                }
+                int element_size = m_field_bytes[field + 1] - m_field_bytes[field];
+                for (int ii = lo[0]; ii <= hi[0]; ++ii)
+                    for (int jj = lo[1]; jj <= hi[1]; ++jj)
+                        for (int kk = lo[2]; kk <= hi[2]; ++kk) {
+                            int dir = translate()(ii, jj, kk);
+                            if (!m_direct_send[dir])
+                                continue;
+                            // the position of the point in the region, in the increasing stride order
+                            int eta[DIMS] = {ii, jj, kk}, pos = 0;
+                            for (int d = DIMS - 1; d >= 0; --d) {
+                                int first = h[d].loop_low_bound_inside(eta[d]);
+                                pos = pos * (h[d].loop_high_bound_inside(eta[d]) - first + 1) + crds[d] - first;
+                            }
+                            char *buffer = base_type::m_haloexch.send_buffer(nth<proc_layout, 0>(ii, jj, kk),
+                                nth<proc_layout, 1>(ii, jj, kk),
+                                nth<proc_layout, 2>(ii, jj, kk));
+                            encode_halo(precision(field),
+                                &value,
+                                1,
+                                buffer + long(m_field_bytes[field]) * send_size[dir] + long(pos) * element_size);
+                        }
+            }
+
+            void exchange() {
+                start_exchange();
+                wait();
+            }
+
+            void start_exchange() {
+                if (m_datatype_exchange)
+                    dt_start(is_mpi_grid_t());
+                else if (m_face_exchange)
+                    face_start(0);
+                else
+                    base_type::start_exchange();
+            }
+
+            void wait() {
+                if (m_datatype_exchange)
+                    dt_wait(is_mpi_grid_t());
+                else if (m_face_exchange)
+                    face_wait();
+                else
+                    base_type::wait();
+            }
 
             /// Utilities
 
@@ -489,135 +724,358 @@ namespace gridtools {
             friend struct allocation_service<this_type>;
 
           private:
-            template <int I, int dummy>
-            struct pack_dims {};
-
-            template <int dummy>
-            struct pack_dims<3, dummy> {
-                template <typename T, typename... FIELDS>
-                void operator()(T &hm, const FIELDS &... _fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
-                            for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = nth<map_type, 0>(ii, jj, kk);
-                                const int jj_P = nth<map_type, 1>(ii, jj, kk);
-                                const int kk_P = nth<map_type, 2>(ii, jj, kk);
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.send_buffer[translate()(ii, jj, kk)][0]);
-                                    hm.halo.pack_all({ii, jj, kk}, it, _fields...);
-
-                                    hm.m_haloexch.set_send_to_size(
-                                        hm.send_size[translate()(ii, jj, kk)] * sizeof...(_fields) * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                    hm.m_haloexch.set_receive_from_size(
-                                        hm.recv_size[translate()(ii, jj, kk)] * sizeof...(_fields) * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                }
-                            }
-                        }
+            // the neighbor across the face in the dimension `d` (in the increasing stride order)
+            int face_neighbor(int d, int side) const {
+                array<int, DIMS> eta = {0, 0, 0};
+                eta[d] = side;
+                return base_type::pattern().proc_grid().proc(nth<proc_layout, 0>(eta[0], eta[1], eta[2]),
+                    nth<proc_layout, 1>(eta[0], eta[1], eta[2]),
+                    nth<proc_layout, 2>(eta[0], eta[1], eta[2]));
+            }
+
+            /*
+             * The bounds of the face region of the phase `d` in the increasing stride order. The region spans the
+             * halos of the dimensions of the earlier phases, where they are received.
+             */
+            void face_bounds(int d, int side, bool inside, int (&lo)[DIMS], int (&hi)[DIMS]) const {
+                for (int e = 0; e < DIMS; ++e) {
+                    auto const &h = halo.halos[e];
+                    if (e == d) {
+                        lo[e] = inside ? h.loop_low_bound_inside(side) : h.loop_low_bound_outside(side);
+                        hi[e] = inside ? h.loop_high_bound_inside(side) : h.loop_high_bound_outside(side);
+                    } else {
+                        lo[e] = e < d && face_neighbor(e, -1) != -1 ? h.loop_low_bound_outside(-1) : h.begin();
+                        hi[e] = e < d && face_neighbor(e, 1) != -1 ? h.loop_high_bound_outside(1) : h.end();
                     }
                 }
-            };
+            }
 
-            template <int I, int dummy>
-            struct unpack_dims {};
+            int face_size(int d, int side) const {
+                int lo[DIMS], hi[DIMS];
+                face_bounds(d, side, false, lo, hi);
+                int res = m_face_fields.size();
+                for (int e = 0; e < DIMS; ++e)
+                    res *= hi[e] - lo[e] + 1;
+                return res;
+            }
 
-            template <int dummy>
-            struct unpack_dims<3, dummy> {
-                template <typename T, typename... FIELDS>
-                void operator()(const T &hm, const FIELDS &... _fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
+            // calls `f` with the offset of every point of the face region
+            template <typename F>
+            void for_each_face_point(int d, int side, bool inside, F f) const {
+                int lo[DIMS], hi[DIMS];
+                face_bounds(d, side, inside, lo, hi);
+                int n0 = halo.halos[0].total_length(), n1 = halo.halos[1].total_length();
+                for (int k = lo[2]; k <= hi[2]; ++k)
+                    for (int j = lo[1]; j <= hi[1]; ++j)
+                        for (int i = lo[0]; i <= hi[0]; ++i)
+                            f(access(i, j, k, n0, n1));
+            }
+
+            static int face_tag(int d, int side) { return 2 * d + (side + 1) / 2; }
+
+            // packs the faces of the phase `d` and starts their communication
+            void face_start(int d) {
+                auto comm = base_type::pattern().proc_grid().communicator();
+                m_face_requests_n = 0;
+                for (int s = 0; s < 2; ++s) {
+                    int side = 2 * s - 1;
+                    int neighbor = face_neighbor(d, side);
+                    if (neighbor == -1)
+                        continue;
+                    auto &recv = m_face_recv[s];
+                    recv.resize(face_size(d, side));
+                    comm_irecv(comm,
+                        recv.data(),
+                        int(recv.size() * sizeof(DataType)),
+                        neighbor,
+                        face_tag(d, -side),
+                        m_face_requests[m_face_requests_n++]);
+                }
+                for (int s = 0; s < 2; ++s) {
+                    int side = 2 * s - 1;
+                    int neighbor = face_neighbor(d, side);
+                    if (neighbor == -1)
+                        continue;
+                    auto &send = m_face_send[s];
+                    send.clear();
+                    for (auto field : m_face_fields)
+                        for_each_face_point(d, side, true, [&](int idx) { send.push_back(field[idx]); });
+                    comm_isend(comm,
+                        send.data(),
+                        int(send.size() * sizeof(DataType)),
+                        neighbor,
+                        face_tag(d, side),
+                        m_face_requests[m_face_requests_n++]);
+                }
+            }
+
+            void face_wait() {
+                comm_waitall(base_type::pattern().proc_grid().communicator(), m_face_requests_n, m_face_requests);
+                m_face_requests_n = 0;
+            }
+
+            template <typename Fields>
+            void face_unpack_phase(int d, Fields const &fields) {
+                for (int s = 0; s < 2; ++s) {
+                    int side = 2 * s - 1;
+                    if (face_neighbor(d, side) == -1)
+                        continue;
+                    auto it = m_face_recv[s].begin();
+                    for (auto field : fields)
+                        for_each_face_point(d, side, false, [&](int idx) { field[idx] = *it++; });
+                }
+            }
+
+            void face_pack(std::vector<DataType const *> fields) { m_face_fields = std::move(fields); }
+
+            // completes the face exchange: unpacks the first phase and runs the others
+            template <typename Fields>
+            void face_unpack(Fields const &fields) {
+                face_unpack_phase(0, fields);
+                for (int d = 1; d < DIMS; ++d) {
+                    face_start(d);
+                    face_wait();
+                    face_unpack_phase(d, fields);
+                }
+            }
+
+            void dt_reset() {
+                for (int n = 0; n < static_pow3(DIMS); ++n)
+                    m_dt_inside[n] = m_dt_outside[n] = m_dt_send[n] = m_dt_recv[n] = MPI_DATATYPE_NULL;
+            }
+
+            static void dt_free(MPI_Datatype &type) {
+                if (type != MPI_DATATYPE_NULL)
+                    MPI_Type_free(&type);
+                type = MPI_DATATYPE_NULL;
+            }
+
+            void dt_free_fields() {
+                for (int n = 0; n < static_pow3(DIMS); ++n) {
+                    dt_free(m_dt_send[n]);
+                    dt_free(m_dt_recv[n]);
+                }
+                m_dt_fields.clear();
+            }
+
+            void dt_free() {
+                dt_free_fields();
+                for (int n = 0; n < static_pow3(DIMS); ++n) {
+                    dt_free(m_dt_inside[n]);
+                    dt_free(m_dt_outside[n]);
+                }
+                dt_free(m_dt_element);
+            }
+
+            // the subarray of the halo region of a direction in a single field, MPI_DATATYPE_NULL if it is empty
+            MPI_Datatype dt_region(array<int, DIMS> const &eta, bool inside) const {
+                int sizes[DIMS], subsizes[DIMS], starts[DIMS];
+                for (int d = 0; d < DIMS; ++d) {
+                    auto const &h = halo.halos[d];
+                    sizes[d] = h.total_length();
+                    starts[d] = inside ? h.loop_low_bound_inside(eta[d]) : h.loop_low_bound_outside(eta[d]);
+                    int hi = inside ? h.loop_high_bound_inside(eta[d]) : h.loop_high_bound_outside(eta[d]);
+                    subsizes[d] = hi - starts[d] + 1;
+                    if (subsizes[d] <= 0)
+                        return MPI_DATATYPE_NULL;
+                }
+                MPI_Datatype res;
+                MPI_Type_create_subarray(
+                    DIMS, sizes, subsizes, starts, MPI_ORDER_FORTRAN /* increasing strides */, m_dt_element, &res);
+                MPI_Type_commit(&res);
+                return res;
+            }
+
+            // the datatypes of the fields of the exchange, built from the ones of the single field
+            void dt_prepare() {
+                if (m_dt_element == MPI_DATATYPE_NULL) {
+                    MPI_Type_contiguous(sizeof(DataType), MPI_BYTE, &m_dt_element);
+                    MPI_Type_commit(&m_dt_element);
+                    for (int ii = -1; ii <= 1; ++ii)
+                        for (int jj = -1; jj <= 1; ++jj)
                             for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = nth<map_type, 0>(ii, jj, kk);
-                                const int jj_P = nth<map_type, 1>(ii, jj, kk);
-                                const int kk_P = nth<map_type, 2>(ii, jj, kk);
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.recv_buffer[translate()(ii, jj, kk)][0]);
-                                    hm.halo.unpack_all({ii, jj, kk}, it, _fields...);
-                                }
+                                if (ii == 0 && jj == 0 && kk == 0)
+                                    continue;
+                                m_dt_inside[translate()(ii, jj, kk)] = dt_region({ii, jj, kk}, true);
+                                m_dt_outside[translate()(ii, jj, kk)] = dt_region({ii, jj, kk}, false);
                             }
-                        }
-                    }
                 }
-            };
+                if (m_dt_pending == m_dt_fields)
+                    return;
+                dt_free_fields();
+                m_dt_fields = m_dt_pending;
+                std::vector<MPI_Aint> addresses(m_dt_fields.size());
+                for (std::size_t f = 0; f < m_dt_fields.size(); ++f)
+                    MPI_Get_address(m_dt_fields[f], &addresses[f]);
+                for (int n = 0; n < static_pow3(DIMS); ++n)
+                    for (auto types : {std::make_pair(m_dt_inside + n, m_dt_send + n),
+                             std::make_pair(m_dt_outside + n, m_dt_recv + n)}) {
+                        if (*types.first == MPI_DATATYPE_NULL || m_dt_fields.empty())
+                            continue;
+                        MPI_Type_create_hindexed_block(
+                            m_dt_fields.size(), 1, addresses.data(), *types.first, types.second);
+                        MPI_Type_commit(types.second);
+                    }
+            }
 
-            template <int I, int dummy>
-            struct pack_vector_dims {};
+            static int dt_tag(int I, int J, int K) { return (K + 1) * 9 + (I + 1) * 3 + J + 1; }
 
-            template <int dummy>
-            struct pack_vector_dims<3, dummy> {
-                template <typename T>
-                void operator()(T &hm, std::vector<DataType *> const &fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
+            void dt_start(std::true_type) {
+                dt_prepare();
+                auto const &grid = base_type::pattern().proc_grid();
+                m_dt_requests_n = 0;
+                for (int is_send = 0; is_send < 2; ++is_send)
+                    for (int ii = -1; ii <= 1; ++ii)
+                        for (int jj = -1; jj <= 1; ++jj)
                             for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = nth<map_type, 0>(ii, jj, kk);
-                                const int jj_P = nth<map_type, 1>(ii, jj, kk);
-                                const int kk_P = nth<map_type, 2>(ii, jj, kk);
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.send_buffer[translate()(ii, jj, kk)][0]);
-                                    for (size_t i = 0; i < fields.size(); ++i) {
-                                        hm.halo.pack({ii, jj, kk}, fields[i], it);
-                                    }
-
-                                    hm.m_haloexch.set_send_to_size(
-                                        hm.send_size[translate()(ii, jj, kk)] * fields.size() * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                    hm.m_haloexch.set_receive_from_size(
-                                        hm.recv_size[translate()(ii, jj, kk)] * fields.size() * sizeof(DataType),
-                                        ii_P,
-                                        jj_P,
-                                        kk_P);
-                                }
+                                const int ii_P = nth<proc_layout, 0>(ii, jj, kk);
+                                const int jj_P = nth<proc_layout, 1>(ii, jj, kk);
+                                const int kk_P = nth<proc_layout, 2>(ii, jj, kk);
+                                int proc = grid.proc(ii_P, jj_P, kk_P);
+                                int dir = translate()(ii, jj, kk);
+                                MPI_Datatype type = is_send ? m_dt_send[dir] : m_dt_recv[dir];
+                                if ((ii == 0 && jj == 0 && kk == 0) || proc == -1 || type == MPI_DATATYPE_NULL)
+                                    continue;
+                                if (is_send)
+                                    MPI_Isend(MPI_BOTTOM,
+                                        1,
+                                        type,
+                                        proc,
+                                        dt_tag(ii_P, jj_P, kk_P),
+                                        grid.communicator(),
+                                        &m_dt_requests[m_dt_requests_n++]);
+                                else
+                                    MPI_Irecv(MPI_BOTTOM,
+                                        1,
+                                        type,
+                                        proc,
+                                        dt_tag(-ii_P, -jj_P, -kk_P),
+                                        grid.communicator(),
+                                        &m_dt_requests[m_dt_requests_n++]);
                             }
-                        }
-                    }
+            }
+
+            void dt_start(std::false_type) {}
+
+            void dt_wait(std::true_type) {
+                MPI_Waitall(m_dt_requests_n, m_dt_requests, MPI_STATUSES_IGNORE);
+                m_dt_requests_n = 0;
+            }
+
+            void dt_wait(std::false_type) {}
+
+            /*
+             * The halo region of a direction as a sequence of the contiguous runs of elements. A run is a row along
+             * the dimension with the unit stride, merged with the rows along the next dimensions as long as the region
+             * spans the whole length of the previous ones. The runs are enumerated in the order of the increasing
+             * strides, which is also the order of the elements in the buffers.
+             */
+            struct halo_runs {
+                int m_first;
+                int m_length;
+                int m_counts[2];
+                int m_strides[2];
+
+                int count() const { return m_length ? m_counts[0] * m_counts[1] : 0; }
+                int size() const { return m_length * count(); }
+                int offset(int run) const {
+                    return m_first + run % m_counts[0] * m_strides[0] + run / m_counts[0] * m_strides[1];
                 }
             };
 
-            template <int I, int dummy>
-            struct unpack_vector_dims {};
+            halo_runs make_halo_runs(array<int, DIMS> const &eta, bool inside) const {
+                int lo[DIMS], len[DIMS], total[DIMS], stride[DIMS];
+                for (int d = 0; d < DIMS; ++d) {
+                    auto const &h = halo.halos[d];
+                    lo[d] = inside ? h.loop_low_bound_inside(eta[d]) : h.loop_low_bound_outside(eta[d]);
+                    int hi = inside ? h.loop_high_bound_inside(eta[d]) : h.loop_high_bound_outside(eta[d]);
+                    len[d] = std::max(hi - lo[d] + 1, 0);
+                    total[d] = h.total_length();
+                    stride[d] = d ? stride[d - 1] * total[d - 1] : 1;
+                }
+                halo_runs res = {access(lo[0], lo[1], lo[2], total[0], total[1]), len[0], {1, 1}, {0, 0}};
+                int d = 1;
+                for (; d < DIMS && len[d - 1] == total[d - 1]; ++d)
+                    res.m_length *= len[d];
+                for (int r = 0; d < DIMS; ++d, ++r) {
+                    res.m_counts[r] = len[d];
+                    res.m_strides[r] = stride[d];
+                }
+                return res;
+            }
 
-            template <int dummy>
-            struct unpack_vector_dims<3, dummy> {
-                template <typename T>
-                void operator()(const T &hm, std::vector<DataType *> const &fields) const {
-#pragma omp parallel for schedule(dynamic, 1) collapse(3)
-                    for (int ii = -1; ii <= 1; ++ii) {
-                        for (int jj = -1; jj <= 1; ++jj) {
-                            for (int kk = -1; kk <= 1; ++kk) {
-                                typedef proc_layout map_type;
-                                const int ii_P = nth<map_type, 0>(ii, jj, kk);
-                                const int jj_P = nth<map_type, 1>(ii, jj, kk);
-                                const int kk_P = nth<map_type, 2>(ii, jj, kk);
-                                if ((ii != 0 || jj != 0 || kk != 0) &&
-                                    (hm.pattern().proc_grid().proc(ii_P, jj_P, kk_P) != -1)) {
-                                    DataType *it = &(hm.recv_buffer[translate()(ii, jj, kk)][0]);
-                                    for (size_t i = 0; i < fields.size(); ++i) {
-                                        hm.halo.unpack({ii, jj, kk}, fields[i], it);
-                                    }
-                                }
+            /*
+             * Copies the halos of all the fields between the fields and the buffers of all the directions. The work is
+             * distributed over the triples (direction, field, run), so that the threads are busy also when there are
+             * just a few directions with large faces. `copy(field_index, buffer, field, n)` copies a single run. The
+             * halos of a field take halo_element_size bytes per value in the buffers, see use_halo_precision.
+             */
+            template <bool IsPack, typename Ptr, typename Copy>
+            void copy_halos(Ptr const *fields, int n_fields, Copy copy) {
+                halo_runs runs[static_pow3(DIMS)];
+                char *buffers[static_pow3(DIMS)];
+                long first_item[static_pow3(DIMS) + 1] = {0};
+                update_field_bytes(n_fields);
+                int n = 0;
+                for (int ii = -1; ii <= 1; ++ii)
+                    for (int jj = -1; jj <= 1; ++jj)
+                        for (int kk = -1; kk <= 1; ++kk) {
+                            const int ii_P = nth<proc_layout, 0>(ii, jj, kk);
+                            const int jj_P = nth<proc_layout, 1>(ii, jj, kk);
+                            const int kk_P = nth<proc_layout, 2>(ii, jj, kk);
+                            if ((ii == 0 && jj == 0 && kk == 0) ||
+                                base_type::pattern().proc_grid().proc(ii_P, jj_P, kk_P) == -1)
+                                continue;
+                            int dir = translate()(ii, jj, kk);
+                            if (IsPack) {
+                                base_type::m_haloexch.set_send_to_size(
+                                    send_size[dir] * m_field_bytes[n_fields], ii_P, jj_P, kk_P);
+                                base_type::m_haloexch.set_receive_from_size(
+                                    recv_size[dir] * m_field_bytes[n_fields], ii_P, jj_P, kk_P);
                             }
+                            runs[n] = make_halo_runs({ii, jj, kk}, IsPack);
+                            buffers[n] = IsPack ? base_type::m_haloexch.send_buffer(ii_P, jj_P, kk_P)
+                                                : reinterpret_cast<char *>(recv_buffer[dir]);
+                            first_item[n + 1] = first_item[n] + long(n_fields) * runs[n].count();
+                            ++n;
                         }
-                    }
+                long n_items = first_item[n];
+#pragma omp parallel for schedule(static)
+                for (long item = 0; item < n_items; ++item) {
+                    int d = std::upper_bound(first_item + 1, first_item + n + 1, item) - (first_item + 1);
+                    halo_runs const &r = runs[d];
+                    int field = (item - first_item[d]) / r.count();
+                    int run = (item - first_item[d]) % r.count();
+                    int element_size = m_field_bytes[field + 1] - m_field_bytes[field];
+                    copy(field,
+                        buffers[d] + long(m_field_bytes[field]) * r.size() + long(run) * r.m_length * element_size,
+                        fields[field] + r.offset(run),
+                        r.m_length);
                 }
-            };
+            }
+
+            // the offsets of the fields in the bytes of a point of the buffers
+            void update_field_bytes(int n_fields) {
+                m_field_bytes.resize(n_fields + 1);
+                for (int f = 0; f < n_fields; ++f)
+                    m_field_bytes[f + 1] = m_field_bytes[f] + halo_element_size<DataType>(precision(f));
+            }
+
+            halo_precision precision(int field) const {
+                return field < (int)m_precisions.size() ? m_precisions[field] : m_default_precision;
+            }
+
+            void pack_fields(std::vector<DataType const *> const &fields) {
+                copy_halos<true>(fields.data(), fields.size(), [&](int f, char *buffer, DataType const *field, int n) {
+                    encode_halo(precision(f), field, n, buffer);
+                });
+            }
+
+            void unpack_fields(std::vector<DataType *> const &fields) {
+                copy_halos<false>(fields.data(), fields.size(), [&](int f, char const *buffer, DataType *field, int n) {
+                    decode_halo(precision(f), buffer, n, field);
+                });
+            }
 
             template <int D, int Dummy>
             struct _destroy_dynamic_ut {};
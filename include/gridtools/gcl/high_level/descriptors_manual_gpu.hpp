@@ -124,6 +124,9 @@ namespace gridtools {
             hndlr_dynamic_ut(hndlr_dynamic_ut &&) = delete;
 
           public:
+            // the halos are packed on the device, not into the shared window of the host
+            void use_shared_memory(bool = true) = delete;
+
             /**
                Constructor
 
@@ -0,0 +1,176 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ *  The precision in which the halos of a field are sent. The reduced precisions are lossy and are available for the
+ *  floating point fields only:
+ *
+ *  `single`: the values are converted to float (4 bytes per value);
+ *  `bfloat16`: the values are converted to float and rounded to the upper half of its representation (2 bytes);
+ *  `truncated`: the representation of the value is rounded to its upper half, that is the sign, the whole exponent and
+ *  the upper bits of the mantissa (4 bytes for double, 2 bytes for float).
+ *
+ *  The rounding is to the nearest, ties to even. The values are converted back to the type of the field on unpack.
+ */
+namespace gridtools {
+    namespace gcl {
+        enum class halo_precision { full, single, bfloat16, truncated };
+
+        namespace halo_precision_impl_ {
+            template <typename T>
+            using is_reducible = std::integral_constant<bool,
+                std::is_same<T, float>::value || std::is_same<T, double>::value>;
+
+            template <typename T>
+            struct bits;
+
+            template <>
+            struct bits<float> {
+                using type = std::uint32_t;
+                using half_type = std::uint16_t;
+            };
+
+            template <>
+            struct bits<double> {
+                using type = std::uint64_t;
+                using half_type = std::uint32_t;
+            };
+
+            // the upper half of the representation of `value`, rounded to the nearest, NaN kept quiet
+            template <typename T>
+            typename bits<T>::half_type upper_half(T value) {
+                using full_t = typename bits<T>::type;
+                using half_t = typename bits<T>::half_type;
+                constexpr int shift = 4 * sizeof(T);
+                full_t b;
+                std::memcpy(&b, &value, sizeof(T));
+                if (value != value)
+                    return half_t(b >> shift) | half_t(1) << (std::numeric_limits<T>::digits - 2 - shift);
+                b += (full_t(1) << (shift - 1)) - 1 + (b >> shift & 1);
+                return half_t(b >> shift);
+            }
+
+            template <typename T>
+            T from_upper_half(typename bits<T>::half_type half) {
+                typename bits<T>::type b = typename bits<T>::type(half) << 4 * sizeof(T);
+                T res;
+                std::memcpy(&res, &b, sizeof(T));
+                return res;
+            }
+
+            template <typename T, typename Encoded, typename F>
+            void encode(T const *src, int n, char *dst, F f) {
+                for (int i = 0; i < n; ++i) {
+                    Encoded value = f(src[i]);
+                    std::memcpy(dst + i * sizeof(Encoded), &value, sizeof(Encoded));
+                }
+            }
+
+            template <typename T, typename Encoded, typename F>
+            void decode(char const *src, int n, T *dst, F f) {
+                for (int i = 0; i < n; ++i) {
+                    Encoded value;
+                    std::memcpy(&value, src + i * sizeof(Encoded), sizeof(Encoded));
+                    dst[i] = f(value);
+                }
+            }
+        } // namespace halo_precision_impl_
+
+        /**
+           Throws if the values of type `T` cannot be sent with the precision `p`.
+        */
+        template <typename T>
+        void check_halo_precision(halo_precision p) {
+            if (p != halo_precision::full && !halo_precision_impl_::is_reducible<T>::value)
+                throw std::runtime_error("the reduced halo precisions are available for float and double only");
+        }
+
+        /**
+           The number of bytes a value of type `T` takes in the buffers with the precision `p`.
+        */
+        template <typename T>
+        int halo_element_size(halo_precision p) {
+            switch (p) {
+            case halo_precision::single:
+                return sizeof(float);
+            case halo_precision::bfloat16:
+                return sizeof(std::uint16_t);
+            case halo_precision::truncated:
+                return sizeof(T) / 2;
+            default:
+                return sizeof(T);
+            }
+        }
+
+        template <typename T>
+        std::enable_if_t<!halo_precision_impl_::is_reducible<T>::value> encode_halo(
+            halo_precision, T const *src, int n, char *dst) {
+            std::memcpy(dst, src, n * sizeof(T));
+        }
+
+        template <typename T>
+        std::enable_if_t<!halo_precision_impl_::is_reducible<T>::value> decode_halo(
+            halo_precision, char const *src, int n, T *dst) {
+            std::memcpy(dst, src, n * sizeof(T));
+        }
+
+        /**
+           Writes the `n` values at `src` to `dst` with the precision `p`.
+        */
+        template <typename T>
+        std::enable_if_t<halo_precision_impl_::is_reducible<T>::value> encode_halo(
+            halo_precision p, T const *src, int n, char *dst) {
+            using namespace halo_precision_impl_;
+            switch (p) {
+            case halo_precision::single:
+                encode<T, float>(src, n, dst, [](T v) { return float(v); });
+                break;
+            case halo_precision::bfloat16:
+                encode<T, std::uint16_t>(src, n, dst, [](T v) { return upper_half(float(v)); });
+                break;
+            case halo_precision::truncated:
+                encode<T, typename bits<T>::half_type>(src, n, dst, [](T v) { return upper_half(v); });
+                break;
+            default:
+                std::memcpy(dst, src, n * sizeof(T));
+            }
+        }
+
+        /**
+           Reads the `n` values written by encode_halo with the precision `p` from `src` to `dst`.
+        */
+        template <typename T>
+        std::enable_if_t<halo_precision_impl_::is_reducible<T>::value> decode_halo(
+            halo_precision p, char const *src, int n, T *dst) {
+            using namespace halo_precision_impl_;
+            switch (p) {
+            case halo_precision::single:
+                decode<T, float>(src, n, dst, [](float v) { return T(v); });
+                break;
+            case halo_precision::bfloat16:
+                decode<T, std::uint16_t>(src, n, dst, [](std::uint16_t v) { return T(from_upper_half<float>(v)); });
+                break;
+            case halo_precision::truncated:
+                decode<T, typename bits<T>::half_type>(
+                    src, n, dst, [](typename bits<T>::half_type v) { return from_upper_half<T>(v); });
+                break;
+            default:
+                std::memcpy(dst, src, n * sizeof(T));
+            }
+        }
+    } // namespace gcl
+} // namespace gridtools
@@ -142,12 +142,11 @@ namespace gridtools {
         template <typename Datatype, typename T2>
         struct pack_service<hndlr_descriptor_ut<Datatype, T2>> {
             void operator()(hndlr_descriptor_ut<Datatype, T2> const *hm) const {
-                typedef typename hndlr_descriptor_ut<Datatype, T2>::pattern_type::translate_type translate;
                 for (int ii = -1; ii <= 1; ++ii)
                     for (int jj = -1; jj <= 1; ++jj)
                         for (int kk = -1; kk <= 1; ++kk)
                             if ((ii != 0 || jj != 0 || kk != 0) && (hm->pattern().proc_grid().proc(ii, jj, kk) != -1)) {
-                                Datatype *it = &(hm->send_buffer[translate()(ii, jj, kk)][0]);
+                                Datatype *it = reinterpret_cast<Datatype *>(hm->m_haloexch.send_buffer(ii, jj, kk));
                                 for (int df = 0; df < hm->size(); ++df)
                                     hm->data_field(df).pack({ii, jj, kk}, it);
                             }
@@ -9,8 +9,14 @@
  */
 #pragma once
 
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "../../common/defs.hpp"
 #include "../GCL.hpp"
+#include "progress_thread.hpp"
 #include "translate.hpp"
 
 /** \file
@@ -209,6 +215,7 @@ namespace gridtools {
                 }
 
                 char *&buffer(int I, int J, int K) { return m_buffers[translate()(I, J, K)]; }
+                char *buffer(int I, int J, int K) const { return m_buffers[translate()(I, J, K)]; }
                 int &size(int I, int J, int K) { return m_size[translate()(I, J, K)]; }
                 int size(int I, int J, int K) const { return m_size[translate()(I, J, K)]; }
             };
@@ -218,6 +225,18 @@ namespace gridtools {
                 static const int value = (K + 1) * 9 + (I + 1) * 3 + J + 1;
             };
 
+            static int tag(int I, int J, int K) { return (K + 1) * 9 + (I + 1) * 3 + J + 1; }
+
+            /*
+             * The persistent requests for all the sends (or all the receives) together with the buffers and the sizes
+             * they were created for.
+             */
+            struct persistent_plan {
+                sr_buffers m_buffers;
+                std::vector<MPI_Request> m_requests;
+                bool m_valid = false;
+            };
+
             struct request_t {
                 MPI_Request request[27];
                 MPI_Request &operator()(int i, int j, int k) { return request[translate()(i, j, k)]; }
@@ -245,9 +264,188 @@ namespace gridtools {
 
             const PROC_GRID /*&*/ m_proc_grid;
 
+            bool m_persistent = false;
+            persistent_plan m_send_plan;
+            persistent_plan m_recv_plan;
+
+            std::unique_ptr<progress_thread> m_progress;
+
+            static void free_plan(persistent_plan &plan) {
+                for (auto &request : plan.m_requests)
+                    MPI_Request_free(&request);
+                plan.m_requests.clear();
+                plan.m_valid = false;
+            }
+
+            /*
+             * (Re)creates the persistent requests if the buffers or the sizes have changed since the last exchange,
+             * which happens if the number of the exchanged fields changes.
+             */
+            void update_plan(persistent_plan &plan, sr_buffers const &buffers, bool is_send) {
+                bool same = plan.m_valid;
+                for (int i = -1; i <= 1 && same; ++i)
+                    for (int j = -1; j <= 1 && same; ++j)
+                        for (int k = -1; k <= 1 && same; ++k)
+                            same = plan.m_buffers.buffer(i, j, k) == buffers.buffer(i, j, k) &&
+                                   plan.m_buffers.size(i, j, k) == buffers.size(i, j, k);
+                if (same)
+                    return;
+                free_plan(plan);
+                plan.m_buffers = buffers;
+                plan.m_valid = true;
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            int proc = m_proc_grid.proc(i, j, k);
+                            if ((i == 0 && j == 0 && k == 0) || proc == -1 || !buffers.size(i, j, k) ||
+                                on_node(i, j, k))
+                                continue;
+                            plan.m_requests.emplace_back();
+                            if (is_send)
+                                MPI_Send_init(buffers.buffer(i, j, k),
+                                    buffers.size(i, j, k),
+                                    MPI_CHAR,
+                                    proc,
+                                    tag(i, j, k),
+                                    m_proc_grid.communicator(),
+                                    &plan.m_requests.back());
+                            else
+                                MPI_Recv_init(buffers.buffer(i, j, k),
+                                    buffers.size(i, j, k),
+                                    MPI_CHAR,
+                                    proc,
+                                    tag(-i, -j, -k),
+                                    m_proc_grid.communicator(),
+                                    &plan.m_requests.back());
+                        }
+            }
+
+            void start_plan(persistent_plan &plan, sr_buffers const &buffers, bool is_send) {
+                update_plan(plan, buffers, is_send);
+                if (!plan.m_requests.empty())
+                    MPI_Startall(plan.m_requests.size(), plan.m_requests.data());
+            }
+
+            static void wait_plan(persistent_plan &plan) {
+                if (!plan.m_requests.empty())
+                    MPI_Waitall(plan.m_requests.size(), plan.m_requests.data(), MPI_STATUSES_IGNORE);
+            }
+
+            /*
+             * The transport through the MPI-3 shared memory for the neighbors on the same node. Every process
+             * exposes a window with a slot per direction: the table of the slot offsets comes first, each slot
+             * consists of a pair of counters followed by the data. The data of a slot is the send buffer of its
+             * direction, the sender packs into it and bumps the `written` counter; the receiver copies the data from
+             * the slot of the neighbor into the receive buffer and bumps the `read` counter. The sender waits for
+             * the `read` counter at the end of the exchange, before the slot is packed again.
+             */
+            struct shared_slot {
+                long m_written;
+                long m_read;
+            };
+
+            static constexpr long shared_align = 64;
+
+            MPI_Comm m_node_comm = MPI_COMM_NULL;
+            MPI_Win m_win = MPI_WIN_NULL;
+            char *m_win_base = nullptr;
+            int m_node_ranks[27];
+            char *m_neighbor_slots[27];
+            long m_shared_sent[27] = {};
+            long m_shared_received[27] = {};
+            // the registered send buffers of the directions that are replaced by the slots of the window
+            char *m_registered_sends[27] = {};
+            int m_shared_capacity[27] = {};
+
+            bool on_node(int I, int J, int K) const { return m_node_ranks[translate()(I, J, K)] != MPI_UNDEFINED; }
+
+            static long align_up(long size) { return (size + shared_align - 1) / shared_align * shared_align; }
+
+            static long load_acquire(long const &counter) { return __atomic_load_n(&counter, __ATOMIC_ACQUIRE); }
+            static void store_release(long &counter, long value) {
+                __atomic_store_n(&counter, value, __ATOMIC_RELEASE);
+            }
+
+            template <class Pred>
+            void spin_until(Pred pred) const {
+                while (!pred()) {
+                    MPI_Win_sync(m_win);
+                    std::this_thread::yield();
+                }
+            }
+
+            shared_slot &own_slot(int I, int J, int K) const {
+                long offset = reinterpret_cast<long const *>(m_win_base)[translate()(I, J, K)];
+                return *reinterpret_cast<shared_slot *>(m_win_base + offset);
+            }
+
+            void free_shared() {
+                if (m_win != MPI_WIN_NULL) {
+                    MPI_Win_unlock_all(m_win);
+                    MPI_Win_free(&m_win);
+                }
+                if (m_node_comm != MPI_COMM_NULL)
+                    MPI_Comm_free(&m_node_comm);
+                m_win_base = nullptr;
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k)
+                            if (on_node(i, j, k))
+                                m_send_buffers.buffer(i, j, k) = m_registered_sends[translate()(i, j, k)];
+                for (int i = 0; i < 27; ++i) {
+                    m_node_ranks[i] = MPI_UNDEFINED;
+                    m_neighbor_slots[i] = nullptr;
+                    m_shared_sent[i] = 0;
+                    m_shared_received[i] = 0;
+                    m_registered_sends[i] = nullptr;
+                    m_shared_capacity[i] = 0;
+                }
+            }
+
+            void shared_sends() {
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            if (!on_node(i, j, k) || !m_send_buffers.size(i, j, k))
+                                continue;
+                            // the data is already packed into the slot
+                            store_release(own_slot(i, j, k).m_written, ++m_shared_sent[translate()(i, j, k)]);
+                        }
+            }
+
+            void wait_shared_sends() const {
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            if (!on_node(i, j, k))
+                                continue;
+                            shared_slot const &slot = own_slot(i, j, k);
+                            long sent = m_shared_sent[translate()(i, j, k)];
+                            spin_until([&] { return load_acquire(slot.m_read) == sent; });
+                        }
+            }
+
+            void shared_receives() {
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            if (!on_node(i, j, k) || !m_recv_buffers.size(i, j, k))
+                                continue;
+                            int dir = translate()(i, j, k);
+                            // the neighbor in the direction (i, j, k) sends in the direction (-i, -j, -k)
+                            shared_slot &slot = *reinterpret_cast<shared_slot *>(m_neighbor_slots[dir]);
+                            long expected = ++m_shared_received[dir];
+                            spin_until([&] { return load_acquire(slot.m_written) == expected; });
+                            std::memcpy(m_recv_buffers.buffer(i, j, k),
+                                m_neighbor_slots[dir] + align_up(sizeof(shared_slot)),
+                                m_recv_buffers.size(i, j, k));
+                            store_release(slot.m_read, expected);
+                        }
+            }
+
             template <int I, int J, int K>
             void post_receive() {
-                if (m_recv_buffers.size(I, J, K)) {
+                if (m_recv_buffers.size(I, J, K) && !on_node(I, J, K)) {
                     MPI_Irecv(static_cast<char *>(m_recv_buffers.buffer(I, J, K)),
                         m_recv_buffers.size(I, J, K),
                         MPI_CHAR,
@@ -260,7 +458,7 @@ namespace gridtools {
 
             template <int I, int J, int K>
             void perform_isend() {
-                if (m_send_buffers.size(I, J, K)) {
+                if (m_send_buffers.size(I, J, K) && !on_node(I, J, K)) {
                     MPI_Isend(static_cast<char *>(m_send_buffers.buffer(I, J, K)),
                         m_send_buffers.size(I, J, K),
                         MPI_CHAR,
@@ -273,6 +471,27 @@ namespace gridtools {
                 }
             }
 
+            // the requests started by start_exchange()
+            std::vector<MPI_Request *> active_requests() {
+                std::vector<MPI_Request *> res;
+                if (m_persistent) {
+                    for (auto plan : {&m_send_plan, &m_recv_plan})
+                        for (auto &request : plan->m_requests)
+                            res.push_back(&request);
+                    return res;
+                }
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            if (send_request.marked(i, j, k))
+                                res.push_back(&send_request(i, j, k));
+                            if ((i != 0 || j != 0 || k != 0) && m_proc_grid.proc(i, j, k) != -1 &&
+                                m_recv_buffers.size(i, j, k) && !on_node(i, j, k))
+                                res.push_back(&request(-i, -j, -k));
+                        }
+                return res;
+            }
+
             void wait_for_sends() {
                 MPI_Status status;
                 for (int i = -1; i <= 1; ++i)
@@ -286,7 +505,7 @@ namespace gridtools {
 
             template <int I, int J, int K>
             void wait() {
-                if (m_recv_buffers.size(I, J, K)) {
+                if (m_recv_buffers.size(I, J, K) && !on_node(I, J, K)) {
                     MPI_Status status;
                     MPI_Wait(&request(-I, -J, -K), &status);
                 }
@@ -306,7 +525,139 @@ namespace gridtools {
              *
              */
             explicit Halo_Exchange_3D(PROC_GRID /*const&*/ _pg)
-                : m_send_buffers(), m_recv_buffers(), request(), send_request(), m_proc_grid(_pg) {}
+                : m_send_buffers(), m_recv_buffers(), request(), send_request(), m_proc_grid(_pg) {
+                for (int i = 0; i < 27; ++i) {
+                    m_node_ranks[i] = MPI_UNDEFINED;
+                    m_neighbor_slots[i] = nullptr;
+                }
+            }
+
+            Halo_Exchange_3D(Halo_Exchange_3D const &) = delete;
+            Halo_Exchange_3D &operator=(Halo_Exchange_3D const &) = delete;
+
+            ~Halo_Exchange_3D() {
+                int finalized;
+                MPI_Finalized(&finalized);
+                if (!finalized) {
+                    free_plan(m_send_plan);
+                    free_plan(m_recv_plan);
+                    free_shared();
+                }
+            }
+
+            /** Switches to the persistent communication: the requests are created once with MPI_Send_init and
+                MPI_Recv_init and every exchange only starts them with MPI_Startall and completes them with
+                MPI_Waitall. The requests are recreated only if the registered buffers or their sizes change.
+                Must not be called while an exchange is in progress.
+
+                \param[in] value Whether the persistent requests are used
+            */
+            void use_persistent_requests(bool value = true) {
+                if (!value) {
+                    free_plan(m_send_plan);
+                    free_plan(m_recv_plan);
+                }
+                m_persistent = value;
+            }
+
+            bool uses_persistent_requests() const { return m_persistent; }
+
+            /** Switches to the progress thread, that tests the requests of the exchange between start_exchange() and
+                wait() so that the messages are transferred while the caller computes, see progress_thread. The
+                caller must not call MPI between start_exchange() and wait(). Throws if MPI was not initialized with
+                at least MPI_THREAD_SERIALIZED. Must not be called while an exchange is in progress.
+
+                \param[in] value Whether the progress thread is used
+                \param[in] pool The thread pool of the computation, that lends a core to the progress thread
+            */
+            template <class ThreadPool = thread_pool::omp>
+            void use_progress_thread(bool value = true, ThreadPool pool = {}) {
+                if (!value)
+                    m_progress.reset();
+                else if (!m_progress)
+                    m_progress = std::make_unique<progress_thread>(pool);
+            }
+
+            bool uses_progress_thread() const { return bool(m_progress); }
+
+            /** Switches the exchange with the neighbors that run on the same node to the MPI-3 shared memory: the
+                send buffers of these neighbors are replaced by the slots of a shared window and the neighbor copies
+                the data from there into its receive buffer, synchronizing with flags instead of MPI messages. The
+                neighbors on the other nodes keep using the MPI messages. The data has to be packed into
+                send_buffer(I, J, K), which must be host memory.
+
+                This is a collective operation on the communicator of the processor grid. It must be called after
+                the buffers are registered: the sizes registered at the time of the call are the maximal sizes of
+                the messages. Must not be called while an exchange is in progress.
+
+                \param[in] value Whether the shared memory is used
+            */
+            void use_shared_memory(bool value = true) {
+                // the persistent requests depend on which neighbors are reached through the shared memory
+                free_plan(m_send_plan);
+                free_plan(m_recv_plan);
+                free_shared();
+                if (!value)
+                    return;
+
+                MPI_Comm comm = m_proc_grid.communicator();
+                MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &m_node_comm);
+                MPI_Group comm_group, node_group;
+                MPI_Comm_group(comm, &comm_group);
+                MPI_Comm_group(m_node_comm, &node_group);
+
+                long offsets[27];
+                long size = align_up(27 * sizeof(long));
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            int dir = translate()(i, j, k);
+                            int proc = m_proc_grid.proc(i, j, k);
+                            if ((i != 0 || j != 0 || k != 0) && proc != -1)
+                                MPI_Group_translate_ranks(comm_group, 1, &proc, node_group, &m_node_ranks[dir]);
+                            offsets[dir] = size;
+                            size += align_up(sizeof(shared_slot));
+                            if (on_node(i, j, k))
+                                size += align_up(m_send_buffers.size(i, j, k));
+                        }
+                MPI_Group_free(&comm_group);
+                MPI_Group_free(&node_group);
+
+                MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, m_node_comm, &m_win_base, &m_win);
+                std::memcpy(m_win_base, offsets, sizeof(offsets));
+                for (int dir = 0; dir < 27; ++dir)
+                    *reinterpret_cast<shared_slot *>(m_win_base + offsets[dir]) = {0, 0};
+                MPI_Win_lock_all(MPI_MODE_NOCHECK, m_win);
+                MPI_Win_sync(m_win);
+                MPI_Barrier(m_node_comm);
+                MPI_Win_sync(m_win);
+
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            int dir = translate()(i, j, k);
+                            if (m_node_ranks[dir] == MPI_UNDEFINED)
+                                continue;
+                            MPI_Aint neighbor_size;
+                            int disp_unit;
+                            char *neighbor_base;
+                            MPI_Win_shared_query(m_win, m_node_ranks[dir], &neighbor_size, &disp_unit, &neighbor_base);
+                            long offset = reinterpret_cast<long const *>(neighbor_base)[translate()(-i, -j, -k)];
+                            m_neighbor_slots[dir] = neighbor_base + offset;
+
+                            m_registered_sends[dir] = m_send_buffers.buffer(i, j, k);
+                            m_shared_capacity[dir] = m_send_buffers.size(i, j, k);
+                            m_send_buffers.buffer(i, j, k) = m_win_base + offsets[dir] + align_up(sizeof(shared_slot));
+                        }
+            }
+
+            bool uses_shared_memory() const { return m_win != MPI_WIN_NULL; }
+
+            /** Returns the buffer into which the data sent to the process (I, J, K) has to be packed: the
+                registered send buffer or, if the process is reached through the shared memory, its slot of the
+                shared window.
+            */
+            char *send_buffer(int I, int J, int K) const { return m_send_buffers.buffer(I, J, K); }
 
             /** Function to retrieve the grid from the pattern, from which user can query
                 location information.
@@ -335,7 +686,12 @@ namespace gridtools {
                 assert((J >= -1 && J <= 1));
                 assert((K >= -1 && K <= 1));
 
-                m_send_buffers.buffer(I, J, K) = reinterpret_cast<char *>(p);
+                if (on_node(I, J, K)) {
+                    // the slot of the shared window stays the send buffer
+                    assert(s <= m_shared_capacity[translate()(I, J, K)]);
+                    m_registered_sends[translate()(I, J, K)] = reinterpret_cast<char *>(p);
+                } else
+                    m_send_buffers.buffer(I, J, K) = reinterpret_cast<char *>(p);
                 m_send_buffers.size(I, J, K) = s;
             }
 
@@ -441,6 +797,7 @@ namespace gridtools {
                 assert((I >= -1 && I <= 1));
                 assert((J >= -1 && J <= 1));
                 assert((K >= -1 && K <= 1));
+                assert(!on_node(I, J, K) || s <= m_shared_capacity[translate()(I, J, K)]);
 
                 m_send_buffers.size(I, J, K) = s;
             }
@@ -549,6 +906,11 @@ namespace gridtools {
             }
 
             void post_receives() {
+                if (m_persistent) {
+                    start_plan(m_recv_plan, m_recv_buffers, false);
+                    return;
+                }
+
                 /* Posting receives face -1
                  */
                 if (m_proc_grid.template proc<1, 0, -1>() != -1) {
@@ -667,6 +1029,14 @@ namespace gridtools {
             }
 
             void do_sends() {
+                if (m_win != MPI_WIN_NULL)
+                    shared_sends();
+
+                if (m_persistent) {
+                    start_plan(m_send_plan, m_send_buffers, true);
+                    return;
+                }
+
                 /* Sending data face -1
                  */
                 if (m_proc_grid.template proc<-1, 0, -1>() != -1) {
@@ -810,9 +1180,26 @@ namespace gridtools {
                 // MPI_Barrier(GSL_WORLD);
 
                 do_sends();
+
+                if (m_progress)
+                    m_progress->start(active_requests());
             }
 
             void wait() {
+                if (m_progress)
+                    m_progress->stop();
+
+                if (m_win != MPI_WIN_NULL) {
+                    shared_receives();
+                    // the slots are packed again by the next exchange
+                    wait_shared_sends();
+                }
+
+                if (m_persistent) {
+                    wait_plan(m_send_plan);
+                    wait_plan(m_recv_plan);
+                    return;
+                }
 
                 wait_for_sends();
 
@@ -0,0 +1,121 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cassert>
+
+#include "Halo_Exchange_3D.hpp"
+#include "thread_comm.hpp"
+#include "translate.hpp"
+
+namespace gridtools {
+    namespace gcl {
+        /**
+           The Level 3 halo exchange pattern on the threads of a thread_comm. The interface is the one of the
+           Halo_Exchange_3D on an MPI process grid, without the MPI specific modes (persistent requests and shared
+           memory). Every message is a single memcpy from the send buffer of a thread to the receive buffer of its
+           neighbor.
+
+           \tparam Ndims The number of dimensions of the process grid
+        */
+        template <int Ndims, int ALIGN>
+        class Halo_Exchange_3D<thread_3D_process_grid_t<Ndims>, ALIGN> {
+          public:
+            typedef thread_3D_process_grid_t<Ndims> grid_type;
+
+          private:
+            typedef translate_t<3> translate;
+
+            char *m_send_buffers[27] = {};
+            int m_send_sizes[27] = {};
+            char *m_recv_buffers[27] = {};
+            int m_recv_sizes[27] = {};
+            thread_request m_requests[54];
+            int m_requests_n = 0;
+
+            const grid_type m_proc_grid;
+
+            static int tag(int I, int J, int K) { return (K + 1) * 9 + (I + 1) * 3 + J + 1; }
+
+          public:
+            explicit Halo_Exchange_3D(grid_type const &g) : m_proc_grid(g) {}
+
+            Halo_Exchange_3D(Halo_Exchange_3D const &) = delete;
+            Halo_Exchange_3D &operator=(Halo_Exchange_3D const &) = delete;
+
+            grid_type const &proc_grid() const { return m_proc_grid; }
+
+            void register_send_to_buffer(void *p, int s, int I, int J, int K) {
+                assert((I >= -1 && I <= 1) && (J >= -1 && J <= 1) && (K >= -1 && K <= 1));
+                m_send_buffers[translate()(I, J, K)] = static_cast<char *>(p);
+                m_send_sizes[translate()(I, J, K)] = s;
+            }
+
+            void register_receive_from_buffer(void *p, int s, int I, int J, int K) {
+                assert((I >= -1 && I <= 1) && (J >= -1 && J <= 1) && (K >= -1 && K <= 1));
+                m_recv_buffers[translate()(I, J, K)] = static_cast<char *>(p);
+                m_recv_sizes[translate()(I, J, K)] = s;
+            }
+
+            char *send_buffer(int I, int J, int K) const { return m_send_buffers[translate()(I, J, K)]; }
+
+            void set_send_to_size(int s, int I, int J, int K) { m_send_sizes[translate()(I, J, K)] = s; }
+
+            void set_receive_from_size(int s, int I, int J, int K) { m_recv_sizes[translate()(I, J, K)] = s; }
+
+            void post_receives() {
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            int proc = m_proc_grid.proc(i, j, k);
+                            int dir = translate()(i, j, k);
+                            if ((i != 0 || j != 0 || k != 0) && proc != -1 && m_recv_sizes[dir])
+                                comm_irecv(m_proc_grid.communicator(),
+                                    m_recv_buffers[dir],
+                                    m_recv_sizes[dir],
+                                    proc,
+                                    tag(-i, -j, -k),
+                                    m_requests[m_requests_n++]);
+                        }
+            }
+
+            void do_sends() {
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            int proc = m_proc_grid.proc(i, j, k);
+                            int dir = translate()(i, j, k);
+                            if ((i != 0 || j != 0 || k != 0) && proc != -1 && m_send_sizes[dir])
+                                comm_isend(m_proc_grid.communicator(),
+                                    m_send_buffers[dir],
+                                    m_send_sizes[dir],
+                                    proc,
+                                    tag(i, j, k),
+                                    m_requests[m_requests_n++]);
+                        }
+            }
+
+            void start_exchange() {
+                post_receives();
+                do_sends();
+            }
+
+            void wait() {
+                comm_waitall(m_proc_grid.communicator(), m_requests_n, m_requests);
+                m_requests_n = 0;
+            }
+
+            void exchange() {
+                start_exchange();
+                wait();
+            }
+        };
+    } // namespace gcl
+} // namespace gridtools
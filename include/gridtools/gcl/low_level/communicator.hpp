@@ -0,0 +1,42 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <mpi.h>
+
+/**
+ *  The point-to-point communication the patterns are built upon.
+ *
+ *  A process grid exposes the type of its communicator (`communicator_type`) and of the handle of a pending
+ *  communication (`request_type`). The following functions are overloaded for every communicator type:
+ *
+ *  `comm_isend(comm, data, size, dest, tag, request)`: starts sending `size` bytes to the process `dest`;
+ *  `comm_irecv(comm, data, size, source, tag, request)`: starts receiving `size` bytes from the process `source`;
+ *  `comm_waitall(comm, n, requests)`: completes the given requests.
+ *
+ *  The messages between two processes with the same tag are not overtaking. The buffers must not be touched until the
+ *  requests are completed. The overloads for MPI are provided here, see thread_comm.hpp for the threads of a single
+ *  process.
+ */
+namespace gridtools {
+    namespace gcl {
+        inline void comm_isend(MPI_Comm comm, void const *data, int size, int dest, int tag, MPI_Request &request) {
+            MPI_Isend(const_cast<void *>(data), size, MPI_CHAR, dest, tag, comm, &request);
+        }
+
+        inline void comm_irecv(MPI_Comm comm, void *data, int size, int source, int tag, MPI_Request &request) {
+            MPI_Irecv(data, size, MPI_CHAR, source, tag, comm, &request);
+        }
+
+        inline void comm_waitall(MPI_Comm, int n, MPI_Request *requests) {
+            MPI_Waitall(n, requests, MPI_STATUSES_IGNORE);
+        }
+    } // namespace gcl
+} // namespace gridtools
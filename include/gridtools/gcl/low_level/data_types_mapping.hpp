@@ -76,6 +76,27 @@ namespace gridtools {
                 MPI_Type_commit(&res);
                 return res;
             }
+
+            /** The subarray of a global array (sorted by decreasing strides) of sizes `global_sizes` that the
+                compute domain of the halo descriptors `halo` fills when it starts at the global indices `offsets`.
+             */
+            template <typename arraytype, typename sizestype, typename offsetstype>
+            static MPI_Datatype make_global(
+                arraytype const &halo, sizestype const &global_sizes, offsetstype const &offsets) {
+                const int d = halo.size();
+                std::vector<int> sizes(d), subsizes(d), starts(d);
+
+                for (int i = 0; i < d; ++i) {
+                    sizes[i] = global_sizes[i];
+                    subsizes[i] = halo[i].end() - halo[i].begin() + 1;
+                    starts[i] = offsets[i];
+                }
+
+                MPI_Datatype res;
+                MPI_Type_create_subarray(d, &sizes[0], &subsizes[0], &starts[0], MPI_ORDER_C, type(), &res);
+                MPI_Type_commit(&res);
+                return res;
+            }
         };
     } // namespace gcl
 } // namespace gridtools
@@ -11,7 +11,10 @@
 
 #include <cassert>
 #include <cmath>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <mpi.h>
 
@@ -23,6 +26,133 @@
 
 namespace gridtools {
     namespace gcl {
+        namespace proc_grids_3D_impl_ {
+            // the factorizations of `n` into three factors, equal to the non-zero entries of `fixed`
+            inline std::vector<array<int, 3>> factorizations(int n, array<int, 3> const &fixed) {
+                std::vector<array<int, 3>> res;
+                for (int a = 1; a <= n; ++a)
+                    for (int b = 1; n % a == 0 && b <= n / a; ++b) {
+                        if ((n / a) % b)
+                            continue;
+                        array<int, 3> f = {a, b, n / a / b};
+                        if ((!fixed[0] || fixed[0] == f[0]) && (!fixed[1] || fixed[1] == f[1]) &&
+                            (!fixed[2] || fixed[2] == f[2]))
+                            res.push_back(f);
+                    }
+                return res;
+            }
+
+            // the number of the pairs of face neighbors within a block of processes of the sizes `l`
+            inline long block_pairs(array<int, 3> const &l) {
+                long n = long(l[0]) * l[1] * l[2];
+                return (l[0] - 1) * n / l[0] + (l[1] - 1) * n / l[1] + (l[2] - 1) * n / l[2];
+            }
+
+            /*
+             * The dimensions of the process grid of `n_procs` processes and of the blocks of the `node_size`
+             * processes of a node in it. The blocks maximize the number of pairs of face neighbors within a node, the
+             * ties are broken by the smallest sum of the dimensions of the grid (the most balanced grid). The grid
+             * is {0, 0, 0} if no blocks fit in it.
+             */
+            inline std::pair<array<int, 3>, array<int, 3>> node_aware_dims(
+                int n_procs, int node_size, array<int, 3> const &fixed) {
+                std::pair<array<int, 3>, array<int, 3>> res = {{0, 0, 0}, {1, 1, 1}};
+                long best_pairs = -1;
+                int best_sum = 0;
+                auto blocks = factorizations(node_size, {0, 0, 0});
+                for (auto const &g : factorizations(n_procs, fixed))
+                    for (auto const &l : blocks) {
+                        if (g[0] % l[0] || g[1] % l[1] || g[2] % l[2])
+                            continue;
+                        long pairs = block_pairs(l);
+                        int sum = g[0] + g[1] + g[2];
+                        if (pairs > best_pairs || (pairs == best_pairs && sum < best_sum)) {
+                            res = {g, l};
+                            best_pairs = pairs;
+                            best_sum = sum;
+                        }
+                    }
+                return res;
+            }
+
+            // the rank of the coordinates in a grid of the dimensions `dims`, the last dimension being the fastest
+            inline int row_major(array<int, 3> const &crds, array<int, 3> const &dims) {
+                return (crds[0] * dims[1] + crds[1]) * dims[2] + crds[2];
+            }
+
+            inline MPI_Comm node_comm(MPI_Comm comm) {
+                MPI_Comm res;
+                MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &res);
+                return res;
+            }
+        } // namespace proc_grids_3D_impl_
+
+        /**
+           Creates a three dimensional MPI CART communicator on the processes of `comm` in which the processes of a
+           node form a block of the grid. The dimensions of the grid and of the blocks are chosen to maximize the
+           number of the pairs of face neighbors on the same node, see proc_grids_3D_impl_::node_aware_dims, and the
+           blocks are ordered as the nodes. If the nodes do not have the same number of processes or if the blocks
+           do not fit in the given dimensions, the processes are ordered as in `comm` on a balanced grid. Collective.
+           The communicator must be freed by the caller.
+
+           \param[in] comm The communicator of the processes
+           \param[in] dims The dimensions of the grid, the zero ones are chosen
+           \param[in] node The communicator of the processes on the same node as the caller, MPI_COMM_NULL for the
+           processes sharing the memory
+        */
+        inline MPI_Comm make_node_aware_cart_comm(
+            MPI_Comm comm, array<int, 3> const &dims = {0, 0, 0}, MPI_Comm node = MPI_COMM_NULL) {
+            using namespace proc_grids_3D_impl_;
+            MPI_Comm node_of_caller = node == MPI_COMM_NULL ? proc_grids_3D_impl_::node_comm(comm) : node;
+            int n_procs, rank, node_size, node_rank;
+            MPI_Comm_size(comm, &n_procs);
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(node_of_caller, &node_size);
+            MPI_Comm_rank(node_of_caller, &node_rank);
+
+            // the nodes are numbered by the ranks of their first processes
+            MPI_Comm leaders;
+            MPI_Comm_split(comm, node_rank == 0 ? 0 : MPI_UNDEFINED, rank, &leaders);
+            int node_id = 0;
+            if (leaders != MPI_COMM_NULL) {
+                MPI_Comm_rank(leaders, &node_id);
+                MPI_Comm_free(&leaders);
+            }
+            MPI_Bcast(&node_id, 1, MPI_INT, 0, node_of_caller);
+            int sizes[2] = {node_size, -node_size};
+            MPI_Allreduce(MPI_IN_PLACE, sizes, 2, MPI_INT, MPI_MAX, comm);
+            if (node == MPI_COMM_NULL)
+                MPI_Comm_free(&node_of_caller);
+            auto grid_and_block = node_aware_dims(n_procs, node_size, dims);
+            if (sizes[0] != -sizes[1] || grid_and_block.first[0] == 0) {
+                node_size = 1;
+                node_rank = 0;
+                node_id = rank;
+                grid_and_block = node_aware_dims(n_procs, 1, dims);
+            }
+            array<int, 3> const &g = grid_and_block.first;
+            array<int, 3> const &l = grid_and_block.second;
+            array<int, 3> nodes = {g[0] / l[0], g[1] / l[1], g[2] / l[2]};
+            array<int, 3> node_crds = {
+                node_id / (nodes[1] * nodes[2]), node_id / nodes[2] % nodes[1], node_id % nodes[2]};
+            array<int, 3> local_crds = {node_rank / (l[1] * l[2]), node_rank / l[2] % l[1], node_rank % l[2]};
+            array<int, 3> crds;
+            for (int d = 0; d < 3; ++d)
+                crds[d] = node_crds[d] * l[d] + local_crds[d];
+
+            MPI_Comm ordered, res;
+            MPI_Comm_split(comm, 0, row_major(crds, g), &ordered);
+            int period[3] = {1, 1, 1};
+            MPI_Cart_create(ordered, 3, &g[0], period, false, &res);
+            MPI_Comm_free(&ordered);
+            return res;
+        }
+
+        /**
+           Tag of the constructor of MPI_3D_process_grid_t that places the processes of a node in a block of the grid
+        */
+        struct node_aware_t {};
+
         /** \class MPI_3D_process_grid_t
          * Class that provides a representation of a 3D process grid given an MPI CART
          * It requires the MPI CART to be defined before the grid is created
@@ -38,6 +168,8 @@ namespace gridtools {
             static const int ndims = Ndims;
 
             typedef boollist<ndims> period_type;
+            typedef MPI_Comm communicator_type;
+            typedef MPI_Request request_type;
 
           private:
             MPI_Comm m_communicator; // Communicator that is associated with the MPI CART!
@@ -45,10 +177,15 @@ namespace gridtools {
             int m_nprocs;
             array<int, ndims> m_dimensions;
             array<int, ndims> m_coordinates;
+            // counted on the first request, negative until then
+            mutable int m_intra_node_neighbors = -1;
+            mutable int m_inter_node_neighbors = -1;
 
           public:
             MPI_3D_process_grid_t(MPI_3D_process_grid_t const &other)
-                : m_cyclic(other.cyclic()), m_nprocs(other.m_nprocs) {
+                : m_cyclic(other.cyclic()), m_nprocs(other.m_nprocs),
+                  m_intra_node_neighbors(other.m_intra_node_neighbors),
+                  m_inter_node_neighbors(other.m_inter_node_neighbors) {
 
                 MPI_Comm_dup(other.m_communicator, &m_communicator);
 
@@ -88,6 +225,22 @@ namespace gridtools {
                     m_communicator, ndims, &m_dimensions[0], period /*does not really care*/, &m_coordinates[0]);
             }
 
+            /** Constructor that distributes the processes of a communicator over the grid so that the processes of a
+                node form a block of it, see make_node_aware_cart_comm.
+                \param c Object containing information about periodicities as defined in \ref boollist_concept
+                \param comm MPI Communicator of the processes
+                \param dims Array of dimensions of the processor grid, the zero ones are chosen
+            */
+            MPI_3D_process_grid_t(
+                period_type const &c, MPI_Comm const &comm, node_aware_t, array<int, ndims> const &dims = {})
+                : m_cyclic(c), m_nprocs(0), m_dimensions(), m_coordinates() {
+                static_assert(ndims == 3, "this interface supposes ndims=3");
+                m_communicator = make_node_aware_cart_comm(comm, dims);
+                int period[ndims];
+                MPI_Cart_get(m_communicator, ndims, &m_dimensions[0], period, &m_coordinates[0]);
+                MPI_Comm_size(m_communicator, &m_nprocs);
+            }
+
             ~MPI_3D_process_grid_t() { MPI_Comm_free(&m_communicator); }
 
             /**
@@ -242,6 +395,55 @@ namespace gridtools {
 
             auto coordinates(uint_t i) const { return m_coordinates[i]; }
             auto dimensions(uint_t i) const { return m_dimensions[i]; }
+
+            /** Returns the number of the directions (out of the 26) in which the neighbor of the caller is on the same
+                node, as detected by MPI_Comm_split_type. The neighbors are counted on the first call to this function
+                or to inter_node_neighbors(), which is collective.
+            */
+            int intra_node_neighbors() const {
+                count_node_neighbors();
+                return m_intra_node_neighbors;
+            }
+
+            /** Returns the number of the directions (out of the 26) in which the neighbor of the caller is on another
+                node. See intra_node_neighbors().
+            */
+            int inter_node_neighbors() const {
+                count_node_neighbors();
+                return m_inter_node_neighbors;
+            }
+
+            /** Counts the neighbors of the caller on the same node and on the other nodes, with the nodes given by
+                the communicators of their processes. Collective.
+                \param node The communicator of the processes on the same node as the caller
+                \return The pair of the numbers of the intra-node and of the inter-node neighbors
+            */
+            std::pair<int, int> node_neighbors(MPI_Comm node) const {
+                static_assert(ndims == 3, "this interface supposes ndims=3");
+                // the nodes are identified by the ranks of their first processes
+                int node_id = pid();
+                MPI_Bcast(&node_id, 1, MPI_INT, 0, node);
+                std::vector<int> node_of(m_nprocs);
+                MPI_Allgather(&node_id, 1, MPI_INT, node_of.data(), 1, MPI_INT, m_communicator);
+                std::pair<int, int> res = {0, 0};
+                for (int i = -1; i <= 1; ++i)
+                    for (int j = -1; j <= 1; ++j)
+                        for (int k = -1; k <= 1; ++k) {
+                            int neighbor = i || j || k ? proc(i, j, k) : -1;
+                            if (neighbor != -1)
+                                ++(node_of[neighbor] == node_id ? res.first : res.second);
+                        }
+                return res;
+            }
+
+          private:
+            void count_node_neighbors() const {
+                if (m_intra_node_neighbors >= 0)
+                    return;
+                MPI_Comm node = proc_grids_3D_impl_::node_comm(m_communicator);
+                std::tie(m_intra_node_neighbors, m_inter_node_neighbors) = node_neighbors(node);
+                MPI_Comm_free(&node);
+            }
         };
     } // namespace gcl
 } // namespace gridtools
@@ -0,0 +1,158 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <mpi.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/omp.hpp"
+
+namespace gridtools {
+    namespace gcl {
+        /**
+           A thread that drives the progress of the MPI requests of an exchange while the calling thread computes.
+           Many MPI implementations move the data of the large messages only from within the MPI calls, so that the
+           messages started by start_exchange() are transferred only by wait(). Between start() and stop() the
+           thread calls MPI_Test on the requests until they complete.
+
+           The MPI calls of the two threads never overlap: the calling thread must not call MPI between start()
+           and stop(), so that MPI_THREAD_SERIALIZED is enough.
+
+           While the thread is testing, a core of the thread pool of the computation is reserved for it (see
+           thread_pool::reserve_core), so that the progress thread does not compete with the computation for the
+           cores. If the pool pins its threads, the progress thread is pinned on the reserved core.
+        */
+        class progress_thread {
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            std::vector<MPI_Request *> m_requests;
+            bool m_busy = false;
+            bool m_stop = false;
+            bool m_quit = false;
+            bool m_reserved = false;
+            int m_cpu = -1;
+            std::function<int()> m_reserve_core;
+            std::function<void()> m_release_core;
+            std::thread m_thread;
+
+            static void pin_current_thread(int cpu) {
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+            }
+
+            void run() {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                int pinned = -1;
+                while (true) {
+                    m_cv.wait(lock, [&] { return m_quit || m_busy; });
+                    if (m_quit)
+                        return;
+                    if (m_cpu >= 0 && m_cpu != pinned) {
+                        pin_current_thread(m_cpu);
+                        pinned = m_cpu;
+                    }
+                    while (!m_stop) {
+                        bool done = true;
+                        for (auto request : m_requests) {
+                            int flag;
+                            MPI_Test(request, &flag, MPI_STATUS_IGNORE);
+                            done = done && flag;
+                        }
+                        if (done)
+                            break;
+                        lock.unlock();
+                        std::this_thread::yield();
+                        lock.lock();
+                    }
+                    m_busy = false;
+                    m_cv.notify_all();
+                }
+            }
+
+          public:
+            /**
+               Throws if the MPI library does not allow a thread other than the main one to call MPI.
+               \param pool The thread pool of the computation that overlaps the communication
+            */
+            template <class ThreadPool = thread_pool::omp>
+            explicit progress_thread(ThreadPool pool = {})
+                : m_reserve_core([pool] { return thread_pool::reserve_core(pool); }),
+                  m_release_core([pool] { thread_pool::release_core(pool); }) {
+                int level;
+                MPI_Query_thread(&level);
+                if (level < MPI_THREAD_SERIALIZED)
+                    throw std::runtime_error("the progress thread requires MPI_THREAD_SERIALIZED");
+                m_thread = std::thread([this] { run(); });
+            }
+
+            progress_thread(progress_thread const &) = delete;
+            progress_thread &operator=(progress_thread const &) = delete;
+
+            ~progress_thread() {
+                stop();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_quit = true;
+                }
+                m_cv.notify_all();
+                m_thread.join();
+            }
+
+            /**
+               Starts testing the requests, which must stay valid until stop().
+            */
+            void start(std::vector<MPI_Request *> requests) {
+                if (requests.empty())
+                    return;
+                int cpu = m_reserve_core();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_reserved = true;
+                    m_cpu = cpu;
+                    m_requests = std::move(requests);
+                    m_busy = true;
+                }
+                m_cv.notify_all();
+            }
+
+            /**
+               Returns when the thread has stopped testing the requests. The completed requests are set to
+               MPI_REQUEST_NULL (or made inactive for the persistent ones), the others are still to be completed by
+               the caller.
+            */
+            void stop() {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_stop = true;
+                m_cv.wait(lock, [&] { return !m_busy; });
+                m_stop = false;
+                m_requests.clear();
+                if (m_reserved)
+                    m_release_core();
+                m_reserved = false;
+            }
+        };
+    } // namespace gcl
+} // namespace gridtools
@@ -0,0 +1,342 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "../../common/array.hpp"
+#include "../../common/defs.hpp"
+#include "boollist.hpp"
+
+/**
+ *  The communicator in which the processes are the threads of a single process.
+ *
+ *  `run_threads(n, f)` runs `f(comm)` on `n` threads, each getting the `thread_comm` with its own rank. The messages
+ *  are copied with a single memcpy from the send buffer straight into the receive buffer, by the thread that comes
+ *  second to the rendezvous. `thread_3D_process_grid_t` is the process grid on top of it, so that the halo exchange
+ *  patterns can be used to decompose the domain of a process into subdomains owned by the threads (e.g. one per NUMA
+ *  domain) or to test the patterns without MPI.
+ */
+namespace gridtools {
+    namespace gcl {
+        namespace thread_comm_impl_ {
+            struct message {
+                void *m_data;
+                int m_size;
+                bool m_done;
+            };
+
+            /*
+             * The state shared by the threads: the messages waiting for the matching counterpart, queued by the
+             * source, the destination and the tag.
+             */
+            struct world {
+                using key_t = std::tuple<int, int, int>;
+                using queue_t = std::deque<std::shared_ptr<message>>;
+
+                int const m_size;
+                std::mutex m_mutex;
+                std::condition_variable m_cond;
+                std::map<key_t, queue_t> m_sends;
+                std::map<key_t, queue_t> m_recvs;
+                int m_arrived = 0;
+                long m_generation = 0;
+
+                explicit world(int size) : m_size(size) {}
+
+                /*
+                 * Queues the message or, if the counterpart is already queued, copies the data from the source to
+                 * the destination. The copy is done outside of the lock.
+                 */
+                std::shared_ptr<message> post(key_t const &key, void *data, int size, bool is_send) {
+                    auto res = std::make_shared<message>(message{data, size, false});
+                    std::shared_ptr<message> match;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto &matched = (is_send ? m_recvs : m_sends)[key];
+                        if (matched.empty()) {
+                            (is_send ? m_sends : m_recvs)[key].push_back(res);
+                            return res;
+                        }
+                        match = std::move(matched.front());
+                        matched.pop_front();
+                    }
+                    message &src = is_send ? *res : *match;
+                    message &dst = is_send ? *match : *res;
+                    assert(src.m_size <= dst.m_size);
+                    std::memcpy(dst.m_data, src.m_data, src.m_size);
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        res->m_done = true;
+                        match->m_done = true;
+                    }
+                    m_cond.notify_all();
+                    return res;
+                }
+
+                void wait(message const &msg) {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cond.wait(lock, [&] { return msg.m_done; });
+                }
+
+                void barrier() {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    long generation = m_generation;
+                    if (++m_arrived == m_size) {
+                        m_arrived = 0;
+                        ++m_generation;
+                        m_cond.notify_all();
+                        return;
+                    }
+                    m_cond.wait(lock, [&] { return m_generation != generation; });
+                }
+            };
+        } // namespace thread_comm_impl_
+
+        /**
+           The handle of a pending communication of the thread_comm.
+        */
+        struct thread_request {
+            std::shared_ptr<thread_comm_impl_::message> m_message;
+        };
+
+        /**
+           The communicator of the threads started by run_threads. Copies of it refer to the same rank.
+        */
+        class thread_comm {
+            std::shared_ptr<thread_comm_impl_::world> m_world;
+            int m_rank;
+
+          public:
+            thread_comm(std::shared_ptr<thread_comm_impl_::world> world, int rank)
+                : m_world(std::move(world)), m_rank(rank) {}
+
+            int rank() const { return m_rank; }
+            int size() const { return m_world->m_size; }
+
+            void barrier() const { m_world->barrier(); }
+
+            friend void comm_isend(
+                thread_comm const &comm, void const *data, int size, int dest, int tag, thread_request &request) {
+                assert(dest >= 0 && dest < comm.size());
+                request.m_message = comm.m_world->post({comm.m_rank, dest, tag}, const_cast<void *>(data), size, true);
+            }
+
+            friend void comm_irecv(
+                thread_comm const &comm, void *data, int size, int source, int tag, thread_request &request) {
+                assert(source >= 0 && source < comm.size());
+                request.m_message = comm.m_world->post({source, comm.m_rank, tag}, data, size, false);
+            }
+
+            friend void comm_waitall(thread_comm const &comm, int n, thread_request *requests) {
+                for (int i = 0; i < n; ++i) {
+                    if (requests[i].m_message)
+                        comm.m_world->wait(*requests[i].m_message);
+                    requests[i].m_message.reset();
+                }
+            }
+        };
+
+        /**
+           Runs `f(thread_comm)` on `num_threads` threads and waits for them to complete. The first exception thrown by
+           a thread is rethrown. Note that a thread that exits early leaves its communication partners waiting.
+        */
+        template <class F>
+        void run_threads(int num_threads, F const &f) {
+            auto world = std::make_shared<thread_comm_impl_::world>(num_threads);
+            std::vector<std::exception_ptr> errors(num_threads);
+            std::vector<std::thread> threads;
+            for (int rank = 0; rank < num_threads; ++rank)
+                threads.emplace_back([&, rank] {
+                    try {
+                        f(thread_comm(world, rank));
+                    } catch (...) {
+                        errors[rank] = std::current_exception();
+                    }
+                });
+            for (auto &thread : threads)
+                thread.join();
+            for (auto const &error : errors)
+                if (error)
+                    std::rethrow_exception(error);
+        }
+
+        /**
+           Balanced factorization of `n` in the manner of MPI_Dims_create: the non-zero entries of `dims` are kept,
+           the zero ones are set to be as close to each other as possible, in non-increasing order.
+        */
+        template <class Array>
+        void dims_create(int n, Array &dims) {
+            int rest = n;
+            std::vector<int> free;
+            for (int d = 0; d < (int)dims.size(); ++d) {
+                if (dims[d]) {
+                    if (rest % dims[d])
+                        throw std::runtime_error("dims_create: the number of processes is not divisible by dims");
+                    rest /= dims[d];
+                } else {
+                    free.push_back(d);
+                }
+            }
+            if (free.empty()) {
+                if (rest != 1)
+                    throw std::runtime_error("dims_create: the dims do not match the number of processes");
+                return;
+            }
+            std::vector<int> factors;
+            for (int p = 2; p * p <= rest; ++p)
+                for (; rest % p == 0; rest /= p)
+                    factors.push_back(p);
+            if (rest > 1)
+                factors.push_back(rest);
+            std::vector<int> values(free.size(), 1);
+            for (auto it = factors.rbegin(); it != factors.rend(); ++it)
+                *std::min_element(values.begin(), values.end()) *= *it;
+            std::sort(values.begin(), values.end(), [](int l, int r) { return l > r; });
+            for (size_t i = 0; i < free.size(); ++i)
+                dims[free[i]] = values[i];
+        }
+
+        /** \class thread_3D_process_grid_t
+         * The process grid of the threads of a thread_comm, with the same interface as MPI_3D_process_grid_t.
+         * The ranks are ordered as in an MPI CART: the last dimension is the fastest.
+         * \n
+         * This is a process grid matching the \ref proc_grid_concept concept
+         */
+        template <int Ndims>
+        struct thread_3D_process_grid_t {
+            static const int ndims = Ndims;
+
+            typedef boollist<ndims> period_type;
+            typedef thread_comm communicator_type;
+            typedef thread_request request_type;
+
+          private:
+            thread_comm m_communicator;
+            period_type m_cyclic;
+            array<int, ndims> m_dimensions;
+            array<int, ndims> m_coordinates;
+
+            int rank_of(array<int, ndims> const &crds) const {
+                int res = 0;
+                for (int d = 0; d < ndims; ++d)
+                    res = res * m_dimensions[d] + crds[d];
+                return res;
+            }
+
+          public:
+            /** Constructor that distributes the threads of the communicator over the grid.
+                \param c Object containing information about periodicities as defined in \ref boollist_concept
+                \param comm The communicator of the threads
+                \param dims The dimensions of the grid, the zero ones are computed as by MPI_Dims_create
+            */
+            thread_3D_process_grid_t(period_type const &c, thread_comm const &comm, array<int, ndims> dims = {})
+                : m_communicator(comm), m_cyclic(c), m_dimensions(dims), m_coordinates() {
+                dims_create(comm.size(), m_dimensions);
+                int rank = comm.rank();
+                for (int d = ndims - 1; d >= 0; --d) {
+                    m_coordinates[d] = rank % m_dimensions[d];
+                    rank /= m_dimensions[d];
+                }
+            }
+
+            thread_comm const &communicator() const { return m_communicator; }
+
+            void dims(int &t_R, int &t_C, int &t_S) const {
+                static_assert(ndims == 3, "this interface supposes ndims=3");
+                t_R = m_dimensions[0];
+                t_C = m_dimensions[1];
+                t_S = m_dimensions[2];
+            }
+
+            template <class Array>
+            void fill_dims(Array &array) const {
+                static_assert(ndims == 3, "this interface supposes ndims=3");
+                array[0] = m_dimensions[0];
+                array[1] = m_dimensions[1];
+                array[2] = m_dimensions[2];
+            }
+
+            uint_t size() const {
+                uint_t ret = m_dimensions[0];
+                for (uint_t i = 1; i < ndims; ++i)
+                    ret *= m_dimensions[i];
+                return ret;
+            }
+
+            void coords(int &t_R, int &t_C, int &t_S) const {
+                static_assert(ndims == 3, "this interface supposes ndims=3");
+                t_R = m_coordinates[0];
+                t_C = m_coordinates[1];
+                t_S = m_coordinates[2];
+            }
+
+            template <int I, int J, int K>
+            int proc() const {
+                return proc(I, J, K);
+            }
+
+            int pid() const { return m_communicator.rank(); }
+
+            /** Returns the rank of the thread with relative coordinates (I,J,K) with respect to the caller, or -1 if
+                there is no such thread in the non-periodic dimensions.
+            */
+            int proc(int I, int J, int K) const {
+                int const rel[3] = {I, J, K};
+                array<int, ndims> crds;
+                for (int d = 0; d < ndims; ++d) {
+                    crds[d] = m_coordinates[d] + rel[d];
+                    if (m_cyclic.value(d))
+                        crds[d] = (crds[d] + m_dimensions[d]) % m_dimensions[d];
+                    else if (crds[d] < 0 || crds[d] >= m_dimensions[d])
+                        return -1;
+                }
+                return rank_of(crds);
+            }
+
+            array<int, ndims> const &coordinates() const { return m_coordinates; }
+
+            array<int, ndims> const &dimensions() const { return m_dimensions; }
+
+            int abs_proc(array<int, ndims> const &crds) const {
+                return proc(crds[0] - m_coordinates[0], crds[1] - m_coordinates[1], crds[2] - m_coordinates[2]);
+            }
+
+            auto ntasks() { return m_communicator.size(); }
+
+            bool periodic(int index) const {
+                assert(index < ndims);
+                return m_cyclic.value(index);
+            }
+
+            array<bool, ndims> periodic() const {
+                static_assert(ndims == 3, "this interface supposes ndims=3");
+                return {m_cyclic.value(0), m_cyclic.value(1), m_cyclic.value(2)};
+            }
+
+            decltype(auto) cyclic() const { return m_cyclic; }
+
+            auto coordinates(uint_t i) const { return m_coordinates[i]; }
+            auto dimensions(uint_t i) const { return m_dimensions[i]; }
+        };
+    } // namespace gcl
+} // namespace gridtools
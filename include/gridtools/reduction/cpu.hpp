@@ -13,6 +13,7 @@
 #include <type_traits>
 
 #include "../common/defs.hpp"
+#include "exact_sum.hpp"
 #include "functions.hpp"
 
 namespace gridtools {
@@ -71,6 +72,24 @@ namespace gridtools {
             return res;
         }
 
+        /**
+         *  The exact sum of the elements, independent of the number of the threads and of the order of the additions.
+         */
+        template <class T>
+        exact_sum reduction_exact_sum(cpu, T const *buff, size_t n) {
+            exact_sum res;
+#pragma omp parallel
+            {
+                exact_sum local;
+#pragma omp for nowait
+                for (size_t i = 0; i < n; i++)
+                    local.add(buff[i]);
+#pragma omp critical
+                res.add(local);
+            }
+            return res;
+        }
+
         inline size_t reduction_round_size(cpu, size_t size) { return size; }
         inline size_t reduction_allocation_size(cpu, size_t size) { return size; }
 
@@ -0,0 +1,258 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <mpi.h>
+
+#include "exact_sum.hpp"
+#include "functions.hpp"
+
+/**
+ *  The reductions of the reducibles distributed over the processes of an MPI communicator: the local reduction of the
+ *  backend is combined with the ones of the other processes.
+ *
+ *  The plain reductions combine the local results with MPI_Allreduce, so that the floating point sums depend on the
+ *  number of the processes. The reproducible sum accumulates the local values into an exact_sum, whose digits are
+ *  summed as integers by MPI: the result is the same for any number of processes and threads and for any
+ *  decomposition of the data. It is available for the host backends.
+ *
+ *  The reductions can be started without blocking; the returned handle gives the result when the communication
+ *  completes, so that the global norms can be overlapped with other work.
+ */
+namespace gridtools {
+    namespace reduction {
+        namespace distributed_impl_ {
+            template <class T, class = void>
+            struct mpi_type {
+                static MPI_Datatype get() {
+                    static MPI_Datatype res = [] {
+                        MPI_Datatype res;
+                        MPI_Type_contiguous(sizeof(T), MPI_BYTE, &res);
+                        MPI_Type_commit(&res);
+                        return res;
+                    }();
+                    return res;
+                }
+                static constexpr bool is_builtin = false;
+            };
+
+#define GT_REDUCTION_MPI_TYPE(type, mpi)          \
+    template <>                                   \
+    struct mpi_type<type> {                       \
+        static MPI_Datatype get() { return mpi; } \
+        static constexpr bool is_builtin = true;  \
+    }
+            GT_REDUCTION_MPI_TYPE(float, MPI_FLOAT);
+            GT_REDUCTION_MPI_TYPE(double, MPI_DOUBLE);
+            GT_REDUCTION_MPI_TYPE(int, MPI_INT);
+            GT_REDUCTION_MPI_TYPE(long, MPI_LONG);
+            GT_REDUCTION_MPI_TYPE(long long, MPI_LONG_LONG);
+            GT_REDUCTION_MPI_TYPE(unsigned, MPI_UNSIGNED);
+            GT_REDUCTION_MPI_TYPE(unsigned long, MPI_UNSIGNED_LONG);
+            GT_REDUCTION_MPI_TYPE(unsigned long long, MPI_UNSIGNED_LONG_LONG);
+#undef GT_REDUCTION_MPI_TYPE
+
+            // the MPI operation of a functor, MPI_OP_NULL if it has no builtin counterpart
+            inline MPI_Op builtin_op(plus) { return MPI_SUM; }
+            inline MPI_Op builtin_op(mul) { return MPI_PROD; }
+            inline MPI_Op builtin_op(min) { return MPI_MIN; }
+            inline MPI_Op builtin_op(max) { return MPI_MAX; }
+            inline MPI_Op builtin_op(bitwise_and) { return MPI_BAND; }
+            inline MPI_Op builtin_op(bitwise_or) { return MPI_BOR; }
+            inline MPI_Op builtin_op(bitwise_xor) { return MPI_BXOR; }
+            template <class F>
+            MPI_Op builtin_op(F) {
+                return MPI_OP_NULL;
+            }
+
+            template <class T, class F>
+            void apply(void *in, void *inout, int *len, MPI_Datatype *) {
+                for (int i = 0; i < *len; ++i)
+                    static_cast<T *>(inout)[i] = F()(static_cast<T *>(in)[i], static_cast<T *>(inout)[i]);
+            }
+
+            // the MPI operation that applies the stateless functor `F`, created once
+            template <class T, class F>
+            MPI_Op user_op() {
+                static_assert(std::is_empty<F>() && std::is_default_constructible<F>(),
+                    "the distributed reduction supports only stateless functors");
+                static MPI_Op res = [] {
+                    MPI_Op res;
+                    MPI_Op_create(&apply<T, F>, true, &res);
+                    return res;
+                }();
+                return res;
+            }
+
+            template <class T, class F>
+            MPI_Op op(F f) {
+                MPI_Op res = mpi_type<T>::is_builtin ? builtin_op(f) : MPI_OP_NULL;
+                return res == MPI_OP_NULL ? user_op<T, F>() : res;
+            }
+
+            /*
+             * The state of a reduction in flight, kept at a fixed address for MPI.
+             */
+            template <class T>
+            struct state {
+                MPI_Request m_request = MPI_REQUEST_NULL;
+                T m_value;
+                exact_sum m_sum;
+                bool m_exact = false;
+            };
+        } // namespace distributed_impl_
+
+        /**
+         *  The handle of a distributed reduction started without blocking. Must be completed with wait() before the
+         *  finalization of MPI; the destructor completes it otherwise.
+         */
+        template <class T>
+        class reduction_request {
+            std::unique_ptr<distributed_impl_::state<T>> m_state;
+
+            // MPI may still write into the state of a reduction in flight, it is released only once complete
+            void complete() {
+                if (m_state && m_state->m_request != MPI_REQUEST_NULL)
+                    MPI_Wait(&m_state->m_request, MPI_STATUS_IGNORE);
+            }
+
+          public:
+            explicit reduction_request(std::unique_ptr<distributed_impl_::state<T>> state)
+                : m_state(std::move(state)) {}
+
+            reduction_request(reduction_request &&) = default;
+
+            reduction_request &operator=(reduction_request &&other) {
+                if (this != &other) {
+                    complete();
+                    m_state = std::move(other.m_state);
+                }
+                return *this;
+            }
+
+            ~reduction_request() { complete(); }
+
+            /**
+             *  Whether the reduction is complete, the communication progresses by this call.
+             */
+            bool test() {
+                int flag;
+                MPI_Test(&m_state->m_request, &flag, MPI_STATUS_IGNORE);
+                return flag;
+            }
+
+            /**
+             *  Completes the reduction and returns its result.
+             */
+            T wait() {
+                MPI_Wait(&m_state->m_request, MPI_STATUS_IGNORE);
+                return m_state->m_exact ? T(m_state->m_sum.value()) : m_state->m_value;
+            }
+        };
+
+        /**
+         *  A reducible whose data is the part owned by the calling process of the data distributed over a
+         *  communicator, typically the one of the GCL process grid. All the reductions are collective.
+         */
+        template <class Reducible>
+        class distributed_reducible {
+            Reducible m_local;
+            MPI_Comm m_comm;
+
+            template <class F>
+            auto start(F f) const {
+                using value_t = decltype(m_local.reduce(f));
+                auto res = std::make_unique<distributed_impl_::state<value_t>>();
+                res->m_value = m_local.reduce(f);
+                MPI_Iallreduce(MPI_IN_PLACE,
+                    &res->m_value,
+                    1,
+                    distributed_impl_::mpi_type<value_t>::get(),
+                    distributed_impl_::op<value_t>(f),
+                    m_comm,
+                    &res->m_request);
+                return res;
+            }
+
+            auto start_reproducible() const {
+                using value_t = std::decay_t<decltype(m_local.neutral_value)>;
+                static_assert(
+                    std::is_floating_point<value_t>(), "the reproducible sum is for the floating point types");
+                auto res = std::make_unique<distributed_impl_::state<value_t>>();
+                res->m_exact = true;
+                res->m_sum = m_local.reduce_exact();
+                res->m_sum.normalize();
+                MPI_Iallreduce(
+                    MPI_IN_PLACE, res->m_sum.data(), exact_sum::size, MPI_INT64_T, MPI_SUM, m_comm, &res->m_request);
+                return res;
+            }
+
+          public:
+            /**
+             *  \param local The reducible of the data of the calling process
+             *  \param comm The communicator of the processes among which the data is distributed
+             */
+            distributed_reducible(Reducible local, MPI_Comm comm) : m_local(std::move(local)), m_comm(comm) {}
+
+            /**
+             *  The reducible of the data of the calling process, as a SID to be written by the computations.
+             */
+            Reducible &local() { return m_local; }
+            Reducible const &local() const { return m_local; }
+
+            /**
+             *  Reduces the data of all the processes with the functor `f`.
+             */
+            template <class F>
+            auto reduce(F f) const {
+                return reduction_request<decltype(m_local.reduce(f))>(start(f)).wait();
+            }
+
+            /**
+             *  Starts the reduction of the data of all the processes with the functor `f`.
+             */
+            template <class F>
+            auto ireduce(F f) const {
+                return reduction_request<decltype(m_local.reduce(f))>(start(f));
+            }
+
+            /**
+             *  The sum of the data of all the processes, rounded once from the exact sum, so that it does not depend
+             *  on the number of the processes and of the threads.
+             */
+            auto reproducible_sum() const {
+                using value_t = std::decay_t<decltype(m_local.neutral_value)>;
+                return reduction_request<value_t>(start_reproducible()).wait();
+            }
+
+            /**
+             *  Starts the reproducible sum of the data of all the processes.
+             */
+            auto ireproducible_sum() const {
+                using value_t = std::decay_t<decltype(m_local.neutral_value)>;
+                return reduction_request<value_t>(start_reproducible());
+            }
+        };
+
+        /**
+         *  Makes the distributed reducible of the local reducible `local` over the communicator `comm`, for instance
+         *  the one of the process grid of gcl::halo_exchange_dynamic_ut or of distributed_boundaries.
+         */
+        template <class Reducible>
+        distributed_reducible<Reducible> make_distributed_reducible(Reducible local, MPI_Comm comm) {
+            return {std::move(local), comm};
+        }
+    } // namespace reduction
+} // namespace gridtools
@@ -0,0 +1,155 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace gridtools {
+    namespace reduction {
+        /**
+         *  The exact sum of floating point values. The values are accumulated into a fixed point number that spans the
+         *  whole range of double, as digits of 32 bits held in 64 bits integers, so that the additions of the digits
+         *  never round and never overflow between the normalizations. The sum does not depend on the order of the
+         *  additions: the sums of the same values added by different threads or processes in any order, and merged
+         *  in any order, are equal to the last bit.
+         *
+         *  The result is the exact sum rounded to the nearest double. The infinities and NaN follow the IEEE rules of
+         *  the sum, independently of the order.
+         */
+        class exact_sum {
+          public:
+            // the number of the digits and the weight of the lowest one, the lowest bit of the denormals is 2^-1074
+            static constexpr int digits = 70;
+            static constexpr int lowest_exponent = -1088;
+            // the digits followed by the counts of +inf, -inf and NaN, all summed as integers when merged
+            static constexpr int size = digits + 3;
+
+          private:
+            static constexpr std::int64_t mask = 0xffffffff;
+            // the normalization is due when the digits might overflow at the next addition
+            static constexpr int max_pending = 1 << 30;
+
+            std::int64_t m_data[size] = {};
+            int m_pending = 0;
+
+            void add_digits(int digit, std::uint64_t mantissa, int shift, bool negative) {
+                std::uint64_t lo = mantissa << shift;
+                std::uint64_t hi = shift ? mantissa >> (64 - shift) : 0;
+                std::int64_t parts[3] = {std::int64_t(lo & mask), std::int64_t(lo >> 32), std::int64_t(hi)};
+                for (int d = 0; d < 3; ++d)
+                    m_data[digit + d] += negative ? -parts[d] : parts[d];
+                if (++m_pending == max_pending)
+                    normalize();
+            }
+
+          public:
+            exact_sum() = default;
+
+            exact_sum &add(double value) {
+                std::uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(double));
+                bool negative = bits >> 63;
+                int biased = int(bits >> 52 & 0x7ff);
+                std::uint64_t mantissa = bits & ((std::uint64_t(1) << 52) - 1);
+                if (biased == 0x7ff) {
+                    ++m_data[digits + (mantissa ? 2 : negative ? 1 : 0)];
+                    return *this;
+                }
+                if (biased)
+                    mantissa |= std::uint64_t(1) << 52;
+                if (!mantissa)
+                    return *this;
+                int position = (biased ? biased - 1075 : -1074) - lowest_exponent;
+                add_digits(position / 32, mantissa, position % 32, negative);
+                return *this;
+            }
+
+            template <class T, std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+            exact_sum &add(T value) {
+                return add(double(value));
+            }
+
+            exact_sum &add(exact_sum const &other) {
+                normalize();
+                exact_sum tmp = other;
+                tmp.normalize();
+                for (int i = 0; i < size; ++i)
+                    m_data[i] += tmp.m_data[i];
+                normalize();
+                return *this;
+            }
+
+            /**
+             *  Propagates the carries, so that all the digits but the highest one are in [0, 2^32). The normalized sums
+             *  of up to 2^31 processes can be added as integers digit by digit.
+             */
+            void normalize() {
+                for (int i = 0; i + 1 < digits; ++i) {
+                    std::int64_t low = m_data[i] & mask;
+                    m_data[i + 1] += (m_data[i] - low) / (mask + 1);
+                    m_data[i] = low;
+                }
+                m_pending = 0;
+            }
+
+            /**
+             *  The digits and the counts of the special values, to be summed as 64 bits integers by MPI.
+             */
+            std::int64_t *data() { return m_data; }
+            std::int64_t const *data() const { return m_data; }
+
+            /**
+             *  The sum rounded to the nearest double.
+             */
+            double value() const {
+                if (m_data[digits + 2] || (m_data[digits] && m_data[digits + 1]))
+                    return std::numeric_limits<double>::quiet_NaN();
+                if (m_data[digits] || m_data[digits + 1])
+                    return m_data[digits] ? std::numeric_limits<double>::infinity()
+                                          : -std::numeric_limits<double>::infinity();
+                exact_sum tmp = *this;
+                tmp.normalize();
+                bool negative = tmp.m_data[digits - 1] < 0;
+                if (negative) {
+                    for (int i = 0; i < digits; ++i)
+                        tmp.m_data[i] = -tmp.m_data[i];
+                    tmp.normalize();
+                }
+                auto const *d = tmp.m_data;
+                int h = digits - 1;
+                while (h >= 0 && !d[h])
+                    --h;
+                if (h < 0)
+                    return 0;
+                if (h == digits - 1)
+                    return negative ? -std::numeric_limits<double>::infinity()
+                                    : std::numeric_limits<double>::infinity();
+                auto digit = [&](int i) { return std::uint64_t(i >= 0 ? d[i] : 0); };
+                // the 64 highest bits, the lower ones being folded into the lowest bit for the rounding
+                int lz = 0;
+                while (!(digit(h) << lz & 0x80000000))
+                    ++lz;
+                std::uint64_t top = digit(h) << 32 | digit(h - 1);
+                std::uint64_t v = top << lz | (lz ? digit(h - 2) >> (32 - lz) : 0);
+                bool sticky = (digit(h - 2) << lz & mask) != 0;
+                for (int i = h - 3; i >= 0 && !sticky; --i)
+                    sticky = d[i] != 0;
+                if (sticky)
+                    v |= 1;
+                double res = std::ldexp(double(v), 32 * (h - 1) + lowest_exponent - lz);
+                return negative ? -res : res;
+            }
+        };
+    } // namespace reduction
+} // namespace gridtools
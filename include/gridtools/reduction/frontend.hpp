@@ -47,6 +47,13 @@ namespace gridtools {
                     return reduction_reduce(Backend(), neutral_value, f, m_origin(), m_size);
                 }
 
+                // the exact sum of the data, see exact_sum.hpp; the neutral value must be zero
+                auto reduce_exact() const {
+                    assert(m_size);
+                    assert(neutral_value == T());
+                    return reduction_exact_sum(Backend(), m_origin(), m_size);
+                }
+
                 friend Strides sid_get_strides(reducible const &obj) { return obj.m_strides; }
                 friend Origin sid_get_origin(reducible const &obj) { return {obj.m_origin}; }
                 friend zeros_type<Sizes> sid_get_lower_bounds(reducible const &obj) { return zeros(obj.m_sizes); }
@@ -11,6 +11,8 @@
 
 #include <cstdlib>
 
+#include "exact_sum.hpp"
+
 namespace gridtools {
     namespace reduction {
         struct naive {};
@@ -22,6 +24,14 @@ namespace gridtools {
             return res;
         }
 
+        template <class T>
+        exact_sum reduction_exact_sum(naive, T const *buff, size_t n) {
+            exact_sum res;
+            for (size_t i = 0; i != n; i++)
+                res.add(buff[i]);
+            return res;
+        }
+
         inline size_t reduction_round_size(naive, size_t size) { return size; }
         inline size_t reduction_allocation_size(naive, size_t size) { return size; }
 
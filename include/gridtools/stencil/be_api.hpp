@@ -411,11 +411,85 @@ namespace gridtools {
             using make_split_view = meta::rename<aggregated_view,
                 meta::transform<make_split_view_item, meta::flatten<meta::transform<fuse_stage_rows, Matrices>>>>;
 
+            namespace independent_groups_impl_ {
+                template <class Item>
+                using get_written_plhs = meta::transform<get_plh,
+                    meta::filter<meta::not_<get_is_const>::apply, typename Item::plh_map_t>>;
+
+                // a group is `list<list<item indices...>, list<accessed plhs...>, list<written plhs...>>`
+                template <class Index, class Item>
+                using make_group = meta::list<meta::list<Index>, typename Item::plhs_t, get_written_plhs<Item>>;
+
+                template <class Lhs, class Rhs>
+                using intersects =
+                    negation<meta::is_empty<meta::filter<meta::curry<meta::st_contains, Rhs>::template apply, Lhs>>>;
+
+                template <class Group>
+                struct conflicts_with {
+                    template <class Other>
+                    using apply = disjunction<intersects<meta::third<Group>, meta::second<Other>>,
+                        intersects<meta::third<Other>, meta::second<Group>>>;
+                };
+
+                template <class Groups>
+                using merge_groups = meta::list<meta::flatten<meta::transform<meta::first, Groups>>,
+                    meta::dedup<meta::flatten<meta::transform<meta::second, Groups>>>,
+                    meta::dedup<meta::flatten<meta::transform<meta::third, Groups>>>>;
+
+                namespace lazy {
+                    template <class Groups, class Group>
+                    struct add_group {
+                        template <class Other>
+                        using conflicts = typename conflicts_with<Group>::template apply<Other>;
+
+                        using type = meta::push_back<meta::filter<meta::not_<conflicts>::template apply, Groups>,
+                            merge_groups<meta::push_back<meta::filter<conflicts, Groups>, Group>>>;
+                    };
+                } // namespace lazy
+                GT_META_DELEGATE_TO_LAZY(add_group, (class Groups, class Group), (Groups, Group));
+
+                template <class Indices>
+                struct sort_group_f {
+                    template <class Group>
+                    using apply =
+                        meta::filter<meta::curry<meta::st_contains, meta::first<Group>>::template apply, Indices>;
+                };
+
+                template <class View,
+                    class Indices = meta::make_indices_for<View>,
+                    class Groups = meta::foldl<add_group,
+                        meta::list<>,
+                        meta::transform<make_group, Indices, meta::rename<meta::list, View>>>>
+                using make_independent_groups = meta::transform<sort_group_f<Indices>::template apply, Groups>;
+            } // namespace independent_groups_impl_
+
+            /**
+             *  Splits the items of the view into the groups that can be executed concurrently.
+             *
+             *  The item depends on the earlier one if one of them writes a placeholder that the other accesses.
+             *  The groups are the connected components of that dependency graph. The result is a list of the groups,
+             *  each group is the list of the item indices (`integral_constant`s) in the original order.
+             */
+            using independent_groups_impl_::make_independent_groups;
+
+            /**
+             *  Executes the `group`-th group of `Groups` (see `make_independent_groups`) by calling the corresponding
+             *  elements of `loops` in order with the given arguments.
+             */
+            template <class Groups, class Loops, class... Args>
+            void run_group(int_t group, Loops const &loops, Args const &... args) {
+                for_each<meta::make_indices_for<Groups>>([&](auto g) {
+                    if (group == decltype(g)::value)
+                        for_each<meta::at<Groups, decltype(g)>>(
+                            [&](auto i) { tuple_util::get<decltype(i)::value>(loops)(args...); });
+                });
+            }
+
             using core::is_backward;
             using core::is_forward;
             using core::is_parallel;
 
-            // used in gpu/fill_flush. TODO: get rid of that?
+            // used in common/fill_flush. TODO: get rid of that?
             using core::interval;
             using core::level;
         } // namespace be_api
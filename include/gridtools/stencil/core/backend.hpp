@@ -11,6 +11,9 @@
 
 #include <cassert>
 #include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 #include "../../common/for_each.hpp"
@@ -33,24 +36,150 @@ namespace gridtools {
                         std::move(data_stores));
                 }
 
+#ifndef NDEBUG
+                template <class BeSpec, class Grid>
+                void check_k_sizes(Grid const &grid) {
+                    for_each<be_api::make_fused_view<BeSpec>>([&](auto matrix) {
+                        for_each<decltype(matrix)>([&](auto info) {
+                            assert(((void)"domain k-size is too small", grid.k_size(info.interval()) >= 0));
+                        });
+                    });
+                }
+#else
+                template <class BeSpec, class Grid>
+                void check_k_sizes(Grid const &) {}
+#endif
+
                 template <class Spec>
                 struct call_entry_point_f {
                     template <class Backend, class Grid, class DataStores>
                     void operator()(Backend &&be, Grid const &grid, DataStores data_stores) const {
                         using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
-#ifndef NDEBUG
-                        for_each<be_api::make_fused_view<be_spec_t>>([&](auto matrix) {
-                            for_each<decltype(matrix)>([&](auto info) {
-                                assert(((void)"domain k-size is too small", grid.k_size(info.interval()) >= 0));
-                            });
-                        });
-#endif
+                        check_k_sizes<be_spec_t>(grid);
                         gridtools_backend_entry_point(
                             std::forward<Backend>(be), be_spec_t(), grid, shift_origin(grid, std::move(data_stores)));
                     }
                 };
+
+                /**
+                 *  The plan for the backends that don't provide `gridtools_backend_make_plan`: each call goes through
+                 *  the regular entry point.
+                 */
+                template <class Backend, class Spec, class Grid, class DataStores>
+                class default_plan {
+                    Backend m_be;
+                    Grid m_grid;
+                    std::unique_ptr<DataStores> m_data_stores;
+
+                  public:
+                    default_plan(Backend be, Grid const &grid, DataStores data_stores)
+                        : m_be(std::move(be)), m_grid(grid), m_data_stores(new DataStores(std::move(data_stores))) {}
+
+                    void rebind(DataStores data_stores) { m_data_stores.reset(new DataStores(std::move(data_stores))); }
+
+                    void operator()() const { gridtools_backend_entry_point(m_be, Spec(), m_grid, *m_data_stores); }
+                };
+
+                template <class Backend, class Spec, class Grid, class DataStores>
+                auto make_backend_plan(int, Backend &&be, Spec spec, Grid const &grid, DataStores data_stores)
+                    -> decltype(
+                        gridtools_backend_make_plan(std::forward<Backend>(be), spec, grid, std::move(data_stores))) {
+                    return gridtools_backend_make_plan(std::forward<Backend>(be), spec, grid, std::move(data_stores));
+                }
+
+                template <class Backend, class Spec, class Grid, class DataStores>
+                default_plan<std::decay_t<Backend>, Spec, Grid, DataStores> make_backend_plan(
+                    long, Backend &&be, Spec, Grid const &grid, DataStores data_stores) {
+                    return {std::forward<Backend>(be), grid, std::move(data_stores)};
+                }
+
+                /**
+                 *  Wraps the backend plan. The backend plan models the following concept:
+                 *    - `plan()` executes the computation;
+                 *    - `plan.rebind(data_stores)` replaces the data stores, the types of the data stores stay the same.
+                 */
+                template <class Plan, class Grid>
+                class plan {
+                    Plan m_plan;
+                    Grid m_grid;
+
+                  public:
+                    plan(Plan impl, Grid const &grid) : m_plan(std::move(impl)), m_grid(grid) {}
+
+                    template <class DataStores>
+                    void rebind(DataStores data_stores) {
+                        m_plan.rebind(shift_origin(m_grid, std::move(data_stores)));
+                    }
+
+                    void operator()() const { m_plan(); }
+                };
+
+                template <class Spec>
+                struct make_plan_f {
+                    template <class Backend, class Grid, class DataStores>
+                    auto operator()(Backend &&be, Grid const &grid, DataStores data_stores) const {
+                        using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
+                        // the grid is fixed for the lifetime of the plan, so the k-sizes are checked only once
+                        check_k_sizes<be_spec_t>(grid);
+                        auto impl = make_backend_plan(0,
+                            std::forward<Backend>(be),
+                            be_spec_t(),
+                            grid,
+                            shift_origin(grid, std::move(data_stores)));
+                        return plan<decltype(impl), Grid>(std::move(impl), grid);
+                    }
+                };
+
+                template <class Backend, class F>
+                auto backend_async(int, Backend const &be, F &&f)
+                    -> decltype(gridtools_backend_async(be, std::forward<F>(f))) {
+                    return gridtools_backend_async(be, std::forward<F>(f));
+                }
+
+                template <class Backend, class F>
+                auto backend_async(long, Backend const &, F &&f) {
+                    return std::async(std::launch::async, std::forward<F>(f));
+                }
+
+                /**
+                 *  Runs the task asynchronously in the way that suits the backend best.
+                 *  Backends could customize it with `gridtools_backend_async(backend, task)`, by default `std::async`
+                 *  is used.
+                 */
+                template <class Backend, class F>
+                auto backend_async(Backend const &be, F &&f) {
+                    return backend_async(0, be, std::forward<F>(f));
+                }
+
+                template <class Backend, class Dep, class F>
+                auto backend_async_after(int, Backend const &be, Dep &&dep, F &&f)
+                    -> decltype(gridtools_backend_async_after(be, std::forward<Dep>(dep), std::forward<F>(f))) {
+                    return gridtools_backend_async_after(be, std::forward<Dep>(dep), std::forward<F>(f));
+                }
+
+                template <class Backend, class Dep, class F>
+                auto backend_async_after(long, Backend const &, Dep &&dep, F &&f) {
+                    return std::async(
+                        std::launch::async, [dep = std::forward<Dep>(dep), f = std::forward<F>(f)]() mutable {
+                            dep.get();
+                            return f();
+                        });
+                }
+
+                /**
+                 *  Runs the task asynchronously once the future `dep` is ready, the caller doesn't wait for it.
+                 *  Backends could customize it with `gridtools_backend_async_after(backend, dep, task)`, by default
+                 *  `std::async` waits for `dep` and runs the task.
+                 */
+                template <class Backend, class Dep, class F>
+                auto backend_async_after(Backend const &be, Dep &&dep, F &&f) {
+                    return backend_async_after(0, be, std::forward<Dep>(dep), std::forward<F>(f));
+                }
             } // namespace backend_impl_
+            using backend_impl_::backend_async;
+            using backend_impl_::backend_async_after;
             using backend_impl_::call_entry_point_f;
+            using backend_impl_::make_plan_f;
         } // namespace core
     }     // namespace stencil
 } // namespace gridtools
@@ -9,6 +9,9 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 #include "../../common/defs.hpp"
@@ -20,8 +23,10 @@
 #include "../../sid/block.hpp"
 #include "../../sid/composite.hpp"
 #include "../../sid/concept.hpp"
+#include "../../thread_pool/concept.hpp"
 #include "../../thread_pool/omp.hpp"
 #include "../be_api.hpp"
+#include "../common/caches.hpp"
 #include "../common/dim.hpp"
 #include "execinfo.hpp"
 #include "loops.hpp"
@@ -31,63 +36,194 @@
 namespace gridtools {
     namespace stencil {
         namespace cpu_ifirst_backend {
-            template <class ThreadPool = thread_pool::omp>
+            template <class PlhInfo>
+            using is_ij_cached = std::is_same<typename PlhInfo::caches_t, meta::list<cache_type::ij>>;
+
+            template <class Mss>
+            using has_ij_caches = meta::any_of<is_ij_cached, typename Mss::plh_map_t>;
+
+            /**
+             *  For k-serial stencils the multistages with ij-caches are executed as a whole, all others are split into
+             *  stages.
+             */
+            template <class Matrix,
+                class Mss = be_api::make_fused_view_item<Matrix>,
+                class Stages = meta::transform<be_api::make_split_view_item, be_api::fuse_stage_rows<Matrix>>>
+            using make_items = meta::if_<has_ij_caches<Mss>, meta::list<Mss>, Stages>;
+
+            template <class Spec>
+            using make_view = meta::rename<be_api::aggregated_view, meta::flatten<meta::transform<make_items, Spec>>>;
+
+            template <class ThreadPool, int_t SimdWidth, class FuseAll, class... Cells, class Grid, class Composite>
+            auto make_stage_loop(
+                FuseAll, be_api::split_view_item<Cells...> stage, Grid const &grid, Composite composite) {
+                return make_loop<ThreadPool, SimdWidth, decltype(stage)>(
+                    FuseAll(), grid, std::move(composite), be_api::make_k_sizes(stage.cells(), grid));
+            }
+
+            template <class ThreadPool, int_t SimdWidth, class... IntervalInfos, class Grid, class Composite>
+            auto make_stage_loop(
+                std::false_type, be_api::fused_view_item<IntervalInfos...> mss, Grid const &grid, Composite composite) {
+                return make_fused_loop<ThreadPool, SimdWidth, decltype(mss)>(grid, std::move(composite));
+            }
+
+            template <class Spec, class Stages = be_api::make_split_view<Spec>>
+            using is_all_parallel = typename meta::all_of<be_api::is_parallel,
+                meta::transform<be_api::get_execution, Stages>>::type;
+
+            template <class Spec,
+                class Stages = be_api::make_split_view<Spec>,
+                class EnclosingExtent = meta::rename<enclosing_extent,
+                    meta::transform<be_api::get_extent, typename Stages::plh_map_t>>>
+            using can_fuse_all = bool_constant<is_all_parallel<Spec>::value && EnclosingExtent::kminus::value == 0 &&
+                                               EnclosingExtent::kplus::value == 0>;
+
+            template <class Spec>
+            using make_items_view = meta::if_<can_fuse_all<Spec>, be_api::make_split_view<Spec>, make_view<Spec>>;
+
+            template <class Spec>
+            using make_tmp_plh_map = be_api::remove_caches_from_plh_map<
+                meta::filter<meta::not_<is_ij_cached>::apply, typename make_items_view<Spec>::tmp_plh_map_t>>;
+
+            template <class Spec>
+            using make_ij_cache_plh_map = meta::filter<is_ij_cached, typename make_items_view<Spec>::tmp_plh_map_t>;
+
+            template <class ThreadPool, class Spec>
+            auto make_temporaries(tmp_allocator &alloc, pos3<std::size_t> const &block_size) {
+                return be_api::make_data_stores(make_tmp_plh_map<Spec>(), [&](auto info) {
+                    return make_tmp_storage<decltype(info.data()),
+                        decltype(info.extent()),
+                        can_fuse_all<Spec>::value,
+                        ThreadPool>(alloc, block_size);
+                });
+            }
+
+            template <class ThreadPool, class Spec>
+            auto make_ij_caches(tmp_allocator &alloc, pos3<std::size_t> const &block_size) {
+                return be_api::make_data_stores<be_api::get_key>(make_ij_cache_plh_map<Spec>(), [&](auto info) {
+                    return make_ij_cache_storage<decltype(info.data()), decltype(info.extent()), ThreadPool>(
+                        alloc, block_size);
+                });
+            }
+
+            template <class ThreadPool,
+                int_t SimdWidth,
+                class Spec,
+                class Grid,
+                class Temporaries,
+                class IjCaches,
+                class DataStores>
+            auto make_loops(Grid const &grid,
+                execinfo const &info,
+                Temporaries const &temporaries,
+                IjCaches const &ij_caches,
+                DataStores external_data_stores) {
+                using fuse_all_t = can_fuse_all<Spec>;
+
+                auto blocked_externals = tuple_util::transform(
+                    [block_size = tuple_util::make<hymap::keys<dim::i, dim::j>::values>(
+                         info.i_block_size(), info.j_block_size())](auto &&data_store) {
+                        return sid::block(std::forward<decltype(data_store)>(data_store), block_size);
+                    },
+                    std::move(external_data_stores));
+
+                auto data_stores = hymap::concat(std::move(blocked_externals), temporaries, ij_caches);
+
+                return tuple_util::transform(
+                    [&](auto stage) {
+                        using stage_t = decltype(stage);
+                        using plh_map_t = typename stage_t::plh_map_t;
+                        using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
+                        auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
+                            [&](auto info) {
+                                using info_t = decltype(info);
+                                using key_t =
+                                    meta::if_<is_ij_cached<info_t>, typename info_t::key_t, typename info_t::plh_t>;
+                                return sid::add_const(info.is_const(), at_key<key_t>(data_stores));
+                            },
+                            stage_t::plh_map()));
+                        return make_stage_loop<ThreadPool, SimdWidth>(fuse_all_t(), stage, grid, std::move(composite));
+                    },
+                    meta::rename<tuple, make_items_view<Spec>>());
+            }
+
+            /**
+             *  Everything that doesn't depend on the field pointers is prepared once: the temporaries (and the
+             *  allocator that owns them) and the blocking. The loops are rebuilt only when the fields are rebound.
+             */
+            template <class ThreadPool, int_t SimdWidth, class Spec, class Grid, class DataStores>
+            class plan {
+                using temporaries_t =
+                    decltype(make_temporaries<ThreadPool, Spec>(std::declval<tmp_allocator &>(), {}));
+                using ij_caches_t = decltype(make_ij_caches<ThreadPool, Spec>(std::declval<tmp_allocator &>(), {}));
+                using loops_t = decltype(make_loops<ThreadPool, SimdWidth, Spec>(std::declval<Grid const &>(),
+                    std::declval<execinfo const &>(),
+                    std::declval<temporaries_t const &>(),
+                    std::declval<ij_caches_t const &>(),
+                    std::declval<DataStores>()));
+
+                Grid m_grid;
+                execinfo m_info;
+                tmp_allocator m_alloc;
+                temporaries_t m_temporaries;
+                ij_caches_t m_ij_caches;
+                std::unique_ptr<loops_t> m_loops;
+
+                pos3<std::size_t> block_size() const {
+                    return make_pos3((std::size_t)m_info.i_block_size(),
+                        (std::size_t)m_info.j_block_size(),
+                        (std::size_t)m_grid.k_size());
+                }
+
+              public:
+                plan(Grid const &grid, DataStores data_stores)
+                    : m_grid(grid), m_info(ThreadPool(), grid),
+                      m_temporaries(make_temporaries<ThreadPool, Spec>(m_alloc, block_size())),
+                      m_ij_caches(make_ij_caches<ThreadPool, Spec>(m_alloc, block_size())) {
+                    rebind(std::move(data_stores));
+                }
+
+                void rebind(DataStores data_stores) {
+                    m_loops.reset(new loops_t(make_loops<ThreadPool, SimdWidth, Spec>(
+                        m_grid, m_info, m_temporaries, m_ij_caches, std::move(data_stores))));
+                }
+
+                void operator()() const {
+                    run_loops<ThreadPool, be_api::make_independent_groups<make_items_view<Spec>>>(
+                        can_fuse_all<Spec>(), m_grid, *m_loops);
+                }
+            };
+
+            /**
+             *  `SimdWidth` greater than one enables the explicit vectorization along i: the stages are evaluated for
+             *  `SimdWidth` points at once, the accessors yield `simd::vec` values instead of scalars.
+             *  It is only valid for the stencils which functors are branch free in the accessed values (arithmetic
+             *  operations and the functions from `gridtools::math`).
+             */
+            template <class ThreadPool = thread_pool::omp, int_t SimdWidth = 1>
             struct cpu_ifirst {
+                static_assert(SimdWidth > 0 && (SimdWidth & (SimdWidth - 1)) == 0, "SimdWidth must be a power of two");
+
+                template <class F>
+                friend auto gridtools_backend_async(cpu_ifirst, F &&f) {
+                    return thread_pool::async(ThreadPool(), std::forward<F>(f));
+                }
+
+                template <class Dep, class F>
+                friend auto gridtools_backend_async_after(cpu_ifirst, Dep &&dep, F &&f) {
+                    return thread_pool::async_after(ThreadPool(), std::forward<Dep>(dep), std::forward<F>(f));
+                }
+
+                template <class Spec, class Grid, class DataStores>
+                friend plan<ThreadPool, SimdWidth, Spec, Grid, DataStores> gridtools_backend_make_plan(
+                    cpu_ifirst, Spec, Grid const &grid, DataStores data_stores) {
+                    return {grid, std::move(data_stores)};
+                }
+
                 template <class Spec, class Grid, class DataStores>
                 friend void gridtools_backend_entry_point(
-                    cpu_ifirst, Spec, Grid const &grid, DataStores external_data_stores) {
-                    using stages_t = be_api::make_split_view<Spec>;
-                    using all_parrallel_t = typename meta::all_of<be_api::is_parallel,
-                        meta::transform<be_api::get_execution, stages_t>>::type;
-                    using enclosing_extent_t = meta::rename<enclosing_extent,
-                        meta::transform<be_api::get_extent, typename stages_t::plh_map_t>>;
-                    using fuse_all_t = bool_constant<all_parrallel_t::value && enclosing_extent_t::kminus::value == 0 &&
-                                                     enclosing_extent_t::kplus::value == 0>;
-
-                    tmp_allocator alloc;
-
-                    execinfo info(ThreadPool(), grid);
-
-                    using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
-                    auto temporaries = be_api::make_data_stores(tmp_plh_map_t(),
-                        [&alloc,
-                            block_size = make_pos3(
-                                (size_t)info.i_block_size(), (size_t)info.j_block_size(), (size_t)grid.k_size())](
-                            auto info) {
-                            return make_tmp_storage<decltype(info.data()),
-                                decltype(info.extent()),
-                                fuse_all_t::value,
-                                ThreadPool>(alloc, block_size);
-                        });
-
-                    auto blocked_externals = tuple_util::transform(
-                        [block_size = tuple_util::make<hymap::keys<dim::i, dim::j>::values>(
-                             info.i_block_size(), info.j_block_size())](auto &&data_store) {
-                            return sid::block(std::forward<decltype(data_store)>(data_store), block_size);
-                        },
-                        std::move(external_data_stores));
-
-                    auto data_stores = hymap::concat(std::move(blocked_externals), std::move(temporaries));
-
-                    auto loops = tuple_util::transform(
-                        [&](auto stage) {
-                            using stage_t = decltype(stage);
-                            auto k_sizes = tuple_util::transform(
-                                [&](auto cell) { return grid.k_size(cell.interval()); }, stage_t::cells());
-
-                            using plh_map_t = typename stage_t::plh_map_t;
-                            using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
-                            auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
-                                [&](auto info) {
-                                    return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
-                                },
-                                stage_t::plh_map()));
-                            return make_loop<ThreadPool, stage_t>(
-                                fuse_all_t(), grid, std::move(composite), std::move(k_sizes));
-                        },
-                        meta::rename<tuple, stages_t>());
-
-                    run_loops<ThreadPool>(fuse_all_t(), grid, std::move(loops));
+                    cpu_ifirst, Spec, Grid const &grid, DataStores data_stores) {
+                    plan<ThreadPool, SimdWidth, Spec, Grid, DataStores>(grid, std::move(data_stores))();
                 }
             };
         } // namespace cpu_ifirst_backend
@@ -14,20 +14,24 @@
 
 #include "../../common/defs.hpp"
 #include "../../common/for_each.hpp"
+#include "../../common/integral_constant.hpp"
 #include "../../common/omp.hpp"
 #include "../../common/tuple_util.hpp"
 #include "../../meta.hpp"
 #include "../../sid/concept.hpp"
 #include "../../thread_pool/concept.hpp"
+#include "../be_api.hpp"
 #include "../common/dim.hpp"
 #include "execinfo.hpp"
+#include "simd.hpp"
 
 namespace gridtools {
     namespace stencil {
         namespace cpu_ifirst_backend {
             namespace loops_impl_ {
                 template <class Stage, class Ptr, class Strides>
-                GT_FORCE_INLINE void i_loop(int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                GT_FORCE_INLINE void vector_i_loop(
+                    integral_constant<int_t, 1>, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
 #pragma omp simd
                     for (int_t i = 0; i < size; ++i) {
                         using namespace literals;
@@ -37,7 +41,33 @@ namespace gridtools {
                     sid::shift(ptr, sid::get_stride<dim::i>(strides), -size);
                 }
 
-                template <class Ptr, class Strides>
+                /**
+                 *  Evaluates the stage for `Width` points at once. The remainder is processed by the narrower
+                 *  vectors of the half, quarter etc. width, the last point (if any) -- by the scalar code.
+                 */
+                template <int_t Width, class Stage, class Ptr, class Strides>
+                GT_FORCE_INLINE void vector_i_loop(
+                    integral_constant<int_t, Width>, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    int_t i = 0;
+                    for (; i + Width <= size; i += Width) {
+                        stage.template operator()<simd_deref_f<Width, Strides>>(ptr, strides);
+                        sid::shift(ptr, sid::get_stride<dim::i>(strides), integral_constant<int_t, Width>());
+                    }
+                    vector_i_loop(integral_constant<int_t, Width / 2>(), size - i, stage, ptr, strides);
+                    sid::shift(ptr, sid::get_stride<dim::i>(strides), -i);
+                }
+
+                template <int_t SimdWidth, class Stage, class Ptr, class Strides>
+                GT_FORCE_INLINE void i_loop(int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    vector_i_loop(
+                        integral_constant<int_t, has_static_i_strides<Ptr, Strides>::value ? SimdWidth : 1>(),
+                        size,
+                        stage,
+                        ptr,
+                        strides);
+                }
+
+                template <int_t SimdWidth, class Ptr, class Strides>
                 struct k_i_loops_f {
                     int_t m_i_size;
                     Ptr &m_ptr;
@@ -46,19 +76,19 @@ namespace gridtools {
                     template <class Cell, class KSize>
                     GT_FORCE_INLINE void operator()(Cell cell, KSize k_size) const {
                         for (int_t k = 0; k < k_size; ++k) {
-                            i_loop(m_i_size, cell, m_ptr, m_strides);
+                            i_loop<SimdWidth>(m_i_size, cell, m_ptr, m_strides);
                             cell.inc_k(m_ptr, m_strides);
                         }
                     }
                 };
 
-                template <class Ptr, class Strides>
-                GT_FORCE_INLINE k_i_loops_f<Ptr, Strides> make_k_i_loops(
+                template <int_t SimdWidth, class Ptr, class Strides>
+                GT_FORCE_INLINE k_i_loops_f<SimdWidth, Ptr, Strides> make_k_i_loops(
                     int_t i_size, Ptr &ptr, Strides const &strides) {
                     return {i_size, ptr, strides};
                 }
 
-                template <class ThreadPool, class Stage, class Grid, class Composite, class KSizes>
+                template <class ThreadPool, int_t SimdWidth, class Stage, class Grid, class Composite, class KSizes>
                 auto make_loop(std::true_type, Grid const &grid, Composite composite, KSizes k_sizes) {
                     using extent_t = typename Stage::extent_t;
                     using ptr_diff_t = sid::ptr_diff_type<Composite>;
@@ -87,7 +117,7 @@ namespace gridtools {
                             tuple_util::for_each(
                                 [&ptr, &strides, &cur, k = info.k, i_size](auto cell, auto k_size) {
                                     if (k >= cur && k < cur + k_size)
-                                        i_loop(i_size, cell, ptr, strides);
+                                        i_loop<SimdWidth>(i_size, cell, ptr, strides);
                                     cur += k_size;
                                 },
                                 Stage::cells(),
@@ -97,22 +127,27 @@ namespace gridtools {
                     };
                 }
 
-                template <class ThreadPool, class Grid, class Loops>
+                /**
+                 *  The independent groups of loops (see `be_api::make_independent_groups`) are distributed over the
+                 *  threads in addition to the blocks.
+                 */
+                template <class ThreadPool, class Groups, class Grid, class Loops>
                 void run_loops(std::true_type, Grid const &grid, Loops loops) {
                     execinfo info(ThreadPool(), grid);
                     int_t i_blocks = info.i_blocks();
                     int_t j_blocks = info.j_blocks();
                     int_t k_size = grid.k_size();
                     thread_pool::parallel_for_loop(ThreadPool(),
-                        [&](auto i, auto k, auto j) {
-                            tuple_util::for_each([block = info.block(i, j, k)](auto &&loop) { loop(block); }, loops);
+                        [&](auto group, auto i, auto k, auto j) {
+                            be_api::run_group<Groups>(group, loops, info.block(i, j, k));
                         },
+                        int_t(meta::length<Groups>::value),
                         i_blocks,
                         k_size,
                         j_blocks);
                 }
 
-                template <class ThreadPool, class Stage, class Grid, class Composite, class KSizes>
+                template <class ThreadPool, int_t SimdWidth, class Stage, class Grid, class Composite, class KSizes>
                 auto make_loop(std::false_type, Grid const &grid, Composite composite, KSizes k_sizes) {
                     using extent_t = typename Stage::extent_t;
                     using ptr_diff_t = sid::ptr_diff_type<Composite>;
@@ -138,7 +173,7 @@ namespace gridtools {
                         int_t j_size = extent_t::extend(dim::j(), info.j_block_size);
                         int_t i_size = extent_t::extend(dim::i(), info.i_block_size);
 
-                        auto k_i_loops = make_k_i_loops(i_size, ptr, strides);
+                        auto k_i_loops = make_k_i_loops<SimdWidth>(i_size, ptr, strides);
                         for (int_t j = 0; j < j_size; ++j) {
                             using namespace literals;
                             tuple_util::for_each(k_i_loops, Stage::cells(), k_sizes);
@@ -148,17 +183,71 @@ namespace gridtools {
                     };
                 }
 
-                template <class ThreadPool, class Grid, class Loops>
+                /**
+                 * Loop over the whole multistage for k-serial stencils: in contrast to the stage loops above, k is the
+                 * outer loop and all stages are executed for one k-level before advancing.
+                 */
+                template <class ThreadPool, int_t SimdWidth, class Mss, class Grid, class Composite>
+                auto make_fused_loop(Grid const &grid, Composite composite) {
+                    using ptr_diff_t = sid::ptr_diff_type<Composite>;
+
+                    auto strides = sid::get_strides(composite);
+                    ptr_diff_t offset{};
+                    sid::shift(
+                        offset, sid::get_stride<dim::k>(strides), grid.k_start(Mss::interval(), Mss::execution()));
+
+                    return [origin = sid::get_origin(composite) + offset,
+                               strides = std::move(strides),
+                               k_sizes = be_api::make_k_sizes(Mss::interval_infos(), grid)](
+                               execinfo_block_kserial const &info) {
+                        sid::ptr_diff_type<Composite> offset{};
+                        sid::shift(
+                            offset, sid::get_stride<dim::thread>(strides), thread_pool::get_thread_num(ThreadPool()));
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), info.i_block);
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), info.j_block);
+                        auto ptr = origin() + offset;
+
+                        tuple_util::for_each(
+                            [&](auto interval, int_t k_size) {
+                                for (int_t k = 0; k < k_size; ++k) {
+                                    tuple_util::for_each(
+                                        [&](auto cell) {
+                                            using namespace literals;
+                                            using extent_t = typename decltype(cell)::extent_t;
+                                            int_t j_size = extent_t::extend(dim::j(), info.j_block_size);
+                                            int_t i_size = extent_t::extend(dim::i(), info.i_block_size);
+                                            auto cell_ptr = ptr;
+                                            sid::shift(
+                                                cell_ptr, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                                            sid::shift(
+                                                cell_ptr, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+                                            for (int_t j = 0; j < j_size; ++j) {
+                                                i_loop<SimdWidth>(i_size, cell, cell_ptr, strides);
+                                                sid::shift(cell_ptr, sid::get_stride<dim::j>(strides), 1_c);
+                                            }
+                                        },
+                                        interval.cells());
+                                    interval.inc_k(ptr, strides);
+                                }
+                            },
+                            Mss::interval_infos(),
+                            k_sizes);
+                    };
+                }
+
+                template <class ThreadPool, class Groups, class Grid, class Loops>
                 void run_loops(std::false_type, Grid const &grid, Loops loops) {
                     execinfo info(ThreadPool(), grid);
                     thread_pool::parallel_for_loop(ThreadPool(),
-                        [&](auto i, auto j) {
-                            tuple_util::for_each([block = info.block(i, j)](auto &&loop) { loop(block); }, loops);
+                        [&](auto group, auto i, auto j) {
+                            be_api::run_group<Groups>(group, loops, info.block(i, j));
                         },
+                        int_t(meta::length<Groups>::value),
                         info.i_blocks(),
                         info.j_blocks());
                 }
             } // namespace loops_impl_
+            using loops_impl_::make_fused_loop;
             using loops_impl_::make_loop;
             using loops_impl_::run_loops;
         } // namespace cpu_ifirst_backend
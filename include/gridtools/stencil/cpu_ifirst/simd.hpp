@@ -0,0 +1,97 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/simd.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../common/dim.hpp"
+#include "../common/intent.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace simd_impl_ {
+                template <class Key, class Strides>
+                using i_stride_type = std::decay_t<decltype(
+                    sid::get_stride_element<Key, dim::i>(std::declval<Strides const &>()))>;
+
+                template <class Strides>
+                struct is_static_i_stride_f {
+                    template <class Key>
+                    using apply = std::is_empty<i_stride_type<Key, Strides>>;
+                };
+
+                /**
+                 *  The vectorized evaluation is possible only if the i-strides are known at compile time:
+                 *  all lanes are addressed from the pointer to the first lane by a default constructed stride.
+                 */
+                template <class Ptr, class Strides>
+                using has_static_i_strides =
+                    meta::all_of<is_static_i_stride_f<Strides>::template apply, get_keys<Ptr>>;
+
+                template <int_t N,
+                    class T,
+                    int_t Stride,
+                    class Ptr,
+                    std::enable_if_t<!std::is_const<T>::value, int> = 0>
+                GT_FORCE_INLINE simd::vec_ref<T, N, Stride> load(T &, integral_constant<int_t, Stride>, Ptr ptr) {
+                    return simd::vec_ref<T, N, Stride>(&*ptr);
+                }
+
+                template <int_t N, class T, class Stride, class Ptr>
+                GT_FORCE_INLINE simd::vec<std::decay_t<T>, N> load(T &&, Stride stride, Ptr ptr) {
+                    simd::vec<std::decay_t<T>, N> res;
+                    for (int_t l = 0; l < N; ++l) {
+                        res[l] = *ptr;
+                        sid::shift(ptr, stride, integral_constant<int_t, 1>());
+                    }
+                    return res;
+                }
+
+                /**
+                 *  Deref that yields `N` consecutive along i points at once.
+                 *
+                 *  Writable data with the compile time i-stride is accessed via `vec_ref` proxy, the rest is loaded
+                 *  into `vec` (with the broadcast if the i-stride is zero).
+                 */
+                template <int_t N, class Strides>
+                struct deref_f {
+                    template <class Key, class Ptr>
+                    GT_FORCE_INLINE auto operator()(Key, Ptr ptr) const {
+                        return load<N>(*ptr, i_stride_type<Key, Strides>(), ptr);
+                    }
+                };
+            } // namespace simd_impl_
+
+            using simd_impl_::has_static_i_strides;
+
+            template <int_t N, class Strides>
+            using simd_deref_f = simd_impl_::deref_f<N, Strides>;
+        } // namespace cpu_ifirst_backend
+
+        template <class T, int N, int Stride>
+        struct apply_intent_type<intent::inout, simd::vec_ref<T, N, Stride>> {
+            using type = simd::vec_ref<T, N, Stride>;
+        };
+
+        template <class T, int N, int Stride>
+        struct apply_intent_type<intent::in, simd::vec_ref<T, N, Stride>> {
+            using type = simd::vec<T, N>;
+        };
+    } // namespace stencil
+} // namespace gridtools
@@ -19,6 +19,7 @@
 #include "../../sid/synthetic.hpp"
 #include "../../thread_pool/concept.hpp"
 #include "../common/dim.hpp"
+#include "../common/extent.hpp"
 #include "pos3.hpp"
 
 namespace gridtools {
@@ -72,6 +73,16 @@ namespace gridtools {
                 template <class T, class Extent>
                 using strides_kind = strides_kind_impl<sizeof(T), Extent>;
 
+                template <std::size_t, class>
+                struct ij_cache_strides_kind_impl;
+
+                /**
+                 * @brief Strides kind tag of the ij-cache tiles. Those are always two-dimensional, so they should not
+                 * share the kind with the temporaries of the same data type and extent.
+                 */
+                template <class T, class Extent>
+                using ij_cache_strides_kind = ij_cache_strides_kind_impl<sizeof(T), Extent>;
+
                 /**
                  * @brief Strides, depending on data type due to padding to cache-line size. Specialization for non-zero
                  * extents along k-dimension.
@@ -138,6 +149,28 @@ namespace gridtools {
                     .template set<sid::property::strides_kind, _impl_tmp::strides_kind<T, Extent>>()
                     .template set<sid::property::ptr_diff, int_t>();
             }
+
+            /**
+             * @brief Storage for ij-cached temporaries: a single i/j tile per thread (block size plus extent).
+             *
+             * The tile has no k-stride, hence it is reused for every k-level. This is valid because the ij-cached data
+             * is never accessed with k-offsets and all stages of a multistage are executed for one k-level before the
+             * next one is processed (see `make_fused_loop`).
+             */
+            template <class T, class Extent, class ThreadPool, class Allocator>
+            auto make_ij_cache_storage(Allocator &allocator, pos3<std::size_t> const &block_size) {
+                using extent_t = to_horizontal_extent<Extent>;
+                auto tile_size = make_pos3(block_size.i, block_size.j, std::size_t(1));
+                return sid::synthetic()
+                    .set<sid::property::origin>(
+                        allocate(allocator,
+                            meta::lazy::id<T>(),
+                            _impl_tmp::storage_size<T, extent_t, ThreadPool>(tile_size)) +
+                        _impl_tmp::origin_offset<T, extent_t, true>(tile_size))
+                    .template set<sid::property::strides>(_impl_tmp::strides<T, extent_t, true>(tile_size))
+                    .template set<sid::property::strides_kind, _impl_tmp::ij_cache_strides_kind<T, extent_t>>()
+                    .template set<sid::property::ptr_diff, int_t>();
+            }
         } // namespace cpu_ifirst_backend
     }     // namespace stencil
 } // namespace gridtools
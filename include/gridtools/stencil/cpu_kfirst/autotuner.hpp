@@ -0,0 +1,265 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "../../common/defs.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/omp.hpp"
+#include "entry_point.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_kfirst_backend {
+            namespace autotuner_impl_ {
+                /**
+                 *  Stable (across runs of the same binary) hash of the stencil specification type.
+                 *  FNV-1a over the mangled type name.
+                 */
+                template <class Spec>
+                std::string spec_hash() {
+                    std::uint64_t res = 14695981039346656037ull;
+                    for (char const *c = typeid(Spec).name(); *c; ++c) {
+                        res ^= (unsigned char)*c;
+                        res *= 1099511628211ull;
+                    }
+                    std::ostringstream out;
+                    out << std::hex << res;
+                    return out.str();
+                }
+            } // namespace autotuner_impl_
+
+            struct block_sizes {
+                int_t i;
+                int_t j;
+            };
+
+            /**
+             *  The tuning is done separately for each combination of these parameters.
+             */
+            struct tuning_key {
+                std::string spec;
+                int_t i_size;
+                int_t j_size;
+                int_t k_size;
+                int_t threads;
+
+                friend bool operator<(tuning_key const &lhs, tuning_key const &rhs) {
+                    return std::tie(lhs.spec, lhs.i_size, lhs.j_size, lhs.k_size, lhs.threads) <
+                           std::tie(rhs.spec, rhs.i_size, rhs.j_size, rhs.k_size, rhs.threads);
+                }
+            };
+
+            template <class Spec, class Grid>
+            tuning_key make_tuning_key(Grid const &grid, int_t threads) {
+                return {autotuner_impl_::spec_hash<Spec>(), grid.i_size(), grid.j_size(), grid.k_size(), threads};
+            }
+
+            /**
+             *  Chooses the i/j block sizes for the `cpu_kfirst` backend at run time.
+             *
+             *  For every tuning key the first `candidates.size() * trials` calls are used for measuring: each candidate
+             *  tiling is run `trials` times and the fastest one wins. All further calls use the winner.
+             *
+             *  If a file name is given, the winners are loaded from that file on construction and the file is
+             *  rewritten each time the tuning of a new key is finished. The file has one line per tuning key:
+             *    <spec hash> <i size> <j size> <k size> <threads> <i block size> <j block size>
+             *
+             *  The file is replaced atomically by renaming a temporary file over it, so that a reader never sees a
+             *  partially written file. The processes that write the same file, like the MPI ranks that inherit
+             *  `GT_CPU_KFIRST_TUNING_FILE`, still overwrite each other's results: give them distinct files or let a
+             *  single rank save.
+             */
+            class autotuner {
+                struct entry {
+                    std::size_t calls = 0;
+                    std::vector<double> times;
+                    bool done = false;
+                    block_sizes best = {};
+                };
+
+                std::string m_filename;
+                std::vector<block_sizes> m_candidates;
+                std::size_t m_trials;
+                mutable std::mutex m_mutex;
+                std::map<tuning_key, entry> m_entries;
+
+                bool write() const {
+                    if (m_filename.empty())
+                        return true;
+                    std::random_device rd;
+                    std::string tmp = m_filename + ".tmp" + std::to_string(rd()) + std::to_string(rd());
+                    {
+                        std::ofstream out(tmp);
+                        for (auto const &item : m_entries)
+                            if (item.second.done)
+                                out << item.first.spec << " " << item.first.i_size << " " << item.first.j_size << " "
+                                    << item.first.k_size << " " << item.first.threads << " " << item.second.best.i
+                                    << " " << item.second.best.j << "\n";
+                        out.close();
+                        if (!out) {
+                            std::remove(tmp.c_str());
+                            return false;
+                        }
+                    }
+                    if (std::rename(tmp.c_str(), m_filename.c_str()) == 0)
+                        return true;
+                    std::remove(tmp.c_str());
+                    return false;
+                }
+
+                void load() {
+                    std::ifstream in(m_filename);
+                    tuning_key key;
+                    block_sizes sizes;
+                    while (in >> key.spec >> key.i_size >> key.j_size >> key.k_size >> key.threads >> sizes.i >>
+                           sizes.j) {
+                        if (sizes.i <= 0 || sizes.j <= 0)
+                            continue;
+                        auto &e = m_entries[key];
+                        e.done = true;
+                        e.best = sizes;
+                    }
+                }
+
+              public:
+                static std::vector<block_sizes> default_candidates() {
+                    return {{8, 8}, {16, 8}, {8, 16}, {16, 16}, {32, 8}, {32, 16}, {64, 8}, {4, 4}};
+                }
+
+                explicit autotuner(std::string filename = {},
+                    std::vector<block_sizes> candidates = default_candidates(),
+                    std::size_t trials = 2)
+                    : m_filename(std::move(filename)), m_candidates(std::move(candidates)),
+                      m_trials(std::max<std::size_t>(trials, 1)) {
+                    assert(!m_candidates.empty());
+                    if (!m_filename.empty())
+                        load();
+                }
+
+                autotuner(autotuner const &) = delete;
+                autotuner &operator=(autotuner const &) = delete;
+
+                /**
+                 *  Writes the finished tunings to the file, returns false if it could not be written. The file is also
+                 *  rewritten each time the tuning of a key is finished, where a failure is ignored: the winners stay
+                 *  in memory and can be saved again explicitly.
+                 */
+                bool save() const {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    return write();
+                }
+
+                /**
+                 *  If the tuning for the given key is finished, stores the winner into `dst` and returns true.
+                 */
+                bool lookup(tuning_key const &key, block_sizes &dst) const {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_entries.find(key);
+                    if (it == m_entries.end() || !it->second.done)
+                        return false;
+                    dst = it->second.best;
+                    return true;
+                }
+
+                /**
+                 *  Invokes `fun(block_sizes)` exactly once with either the next candidate to measure or the winner.
+                 */
+                template <class Fun>
+                void operator()(tuning_key const &key, Fun &&fun) {
+                    std::size_t candidate;
+                    block_sizes sizes;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto &e = m_entries[key];
+                        if (e.done) {
+                            sizes = e.best;
+                            candidate = m_candidates.size();
+                        } else {
+                            candidate = std::min(e.calls++ / m_trials, m_candidates.size() - 1);
+                            sizes = m_candidates[candidate];
+                        }
+                    }
+                    if (candidate == m_candidates.size()) {
+                        std::forward<Fun>(fun)(sizes);
+                        return;
+                    }
+
+                    auto start = std::chrono::steady_clock::now();
+                    std::forward<Fun>(fun)(sizes);
+                    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto &e = m_entries[key];
+                    if (e.done)
+                        return;
+                    e.times.resize(m_candidates.size(), std::numeric_limits<double>::infinity());
+                    e.times[candidate] = std::min(e.times[candidate], time);
+                    if (e.calls < m_candidates.size() * m_trials)
+                        return;
+                    e.best = m_candidates[std::min_element(e.times.begin(), e.times.end()) - e.times.begin()];
+                    e.done = true;
+                    e.times.clear();
+                    write();
+                }
+            };
+
+            /**
+             *  The tuner that is used if none is provided explicitly.
+             *  The tuning file could be set by `GT_CPU_KFIRST_TUNING_FILE` env variable.
+             */
+            inline autotuner &default_autotuner() {
+                static autotuner res([] {
+                    char const *env_value = std::getenv("GT_CPU_KFIRST_TUNING_FILE");
+                    return env_value ? std::string(env_value) : std::string();
+                }());
+                return res;
+            }
+
+            /**
+             *  `cpu_kfirst` backend that selects its block sizes with the autotuner.
+             */
+            template <class ThreadPool = thread_pool::omp>
+            struct cpu_kfirst_autotuned {
+                std::shared_ptr<autotuner> tuner;
+            };
+
+            template <class ThreadPool, class Spec, class Grid, class DataStores>
+            void gridtools_backend_entry_point(
+                cpu_kfirst_autotuned<ThreadPool> be, Spec spec, Grid const &grid, DataStores data_stores) {
+                autotuner &tuner = be.tuner ? *be.tuner : default_autotuner();
+                tuner(make_tuning_key<Spec>(grid, thread_pool::get_max_threads(ThreadPool())),
+                    [&](block_sizes sizes) {
+                        gridtools_backend_entry_point(
+                            cpu_kfirst<int_t, int_t, ThreadPool>{sizes.i, sizes.j}, spec, grid, std::move(data_stores));
+                    });
+            }
+        } // namespace cpu_kfirst_backend
+        using cpu_kfirst_backend::cpu_kfirst_autotuned;
+    } // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,342 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/for_each.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/allocator.hpp"
+#include "../../sid/as_const.hpp"
+#include "../../sid/block.hpp"
+#include "../../sid/composite.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/contiguous.hpp"
+#include "../../sid/loop.hpp"
+#include "../../sid/sid_shift_origin.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/omp.hpp"
+#include "../be_api.hpp"
+#include "../common/dim.hpp"
+#include "../common/fill_flush.hpp"
+#include "k_cache.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_kfirst_backend {
+            template <class ThreadPool, class Stage, class Grid, class DataStores, class IBlockSize, class JBlockSize>
+            auto make_stage_loop(ThreadPool, Stage, Grid const &grid, DataStores &data_stores, IBlockSize, JBlockSize) {
+                using extent_t = typename Stage::extent_t;
+
+                using plh_map_t = typename Stage::plh_map_t;
+                using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
+                auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
+                    [&](auto info) {
+                        return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
+                    },
+                    Stage::plh_map()));
+                using ptr_diff_t = sid::ptr_diff_type<decltype(composite)>;
+
+                auto strides = sid::get_strides(composite);
+                ptr_diff_t offset{};
+                sid::shift(offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+                sid::shift(
+                    offset, sid::get_stride<dim::k>(strides), grid.k_start(Stage::interval(), Stage::execution()));
+
+                auto shift_back = -grid.k_size(Stage::interval()) * Stage::k_step();
+                auto k_sizes =
+                    tuple_util::transform([&](auto cell) { return grid.k_size(cell.interval()); }, Stage::cells());
+                auto k_loop = [k_sizes = std::move(k_sizes), shift_back](auto &ptr, auto const &strides) {
+                    tuple_util::for_each(
+                        [&ptr, &strides](auto cell, auto size) {
+                            for (int_t k = 0; k < size; ++k) {
+                                cell(ptr, strides);
+                                cell.inc_k(ptr, strides);
+                            }
+                        },
+                        Stage::cells(),
+                        k_sizes);
+                    sid::shift(ptr, sid::get_stride<dim::k>(strides), shift_back);
+                };
+                return [origin = sid::get_origin(composite) + offset,
+                           strides = std::move(strides),
+                           k_loop = std::move(k_loop)](int_t i_block, int_t j_block, int_t i_size, int_t j_size) {
+                    ptr_diff_t offset{};
+                    sid::shift(
+                        offset, sid::get_stride<dim::thread>(strides), thread_pool::get_thread_num(ThreadPool()));
+                    sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), i_block);
+                    sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), j_block);
+                    auto i_loop = sid::make_loop<dim::i>(extent_t::extend(dim::i(), i_size));
+                    auto j_loop = sid::make_loop<dim::j>(extent_t::extend(dim::j(), j_size));
+                    i_loop(j_loop(k_loop))(origin() + offset, strides);
+                };
+            }
+
+            template <class Info, class DataStores, class KCaches, std::enable_if_t<!is_k_cached<Info>::value, int> = 0>
+            auto get_sid(Info info, DataStores &data_stores, KCaches const &) {
+                return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
+            }
+
+            template <class Info, class DataStores, class KCaches, std::enable_if_t<is_k_cached<Info>::value, int> = 0>
+            auto get_sid(Info info, DataStores &, KCaches const &k_caches) {
+                return at_key<decltype(info.key())>(k_caches).sid();
+            }
+
+            /**
+             *  The loop for the multistage with k-caches.
+             *
+             *  In contrast to the stage loops, k is the outer loop here: for each k-level all stages are executed over
+             *  their i/j extents within the block. This way the values of the k-cached placeholders are needed only
+             *  within the small window of k-levels that is kept in the k-caches.
+             */
+            template <class ThreadPool,
+                class... IntervalInfos,
+                class Grid,
+                class DataStores,
+                class IBlockSize,
+                class JBlockSize>
+            auto make_stage_loop(ThreadPool,
+                be_api::fused_view_item<IntervalInfos...>,
+                Grid const &grid,
+                DataStores &data_stores,
+                IBlockSize i_block_size,
+                JBlockSize j_block_size) {
+                using mss_t = be_api::fused_view_item<IntervalInfos...>;
+
+                auto k_caches =
+                    make_k_caches<mss_t>(i_block_size, j_block_size, thread_pool::get_max_threads(ThreadPool()));
+
+                using plh_map_t = typename mss_t::plh_map_t;
+                using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
+                auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
+                    [&](auto info) { return get_sid(info, data_stores, k_caches); }, mss_t::plh_map()));
+                using ptr_diff_t = sid::ptr_diff_type<decltype(composite)>;
+
+                auto strides = sid::get_strides(composite);
+                ptr_diff_t offset{};
+                auto k_start = grid.k_start(mss_t::interval(), mss_t::execution());
+                sid::shift(offset, sid::get_stride<dim::k>(strides), k_start);
+                unshift_k_caches(k_caches, offset, strides, k_start);
+
+                auto k_sizes = be_api::make_k_sizes(mss_t::interval_infos(), grid);
+
+                return [origin = sid::get_origin(composite) + offset,
+                           strides = std::move(strides),
+                           k_sizes = std::move(k_sizes),
+                           k_caches = std::move(k_caches)](int_t i_block, int_t j_block, int_t i_size, int_t j_size) {
+                    int_t thread = thread_pool::get_thread_num(ThreadPool());
+                    ptr_diff_t offset{};
+                    sid::shift(offset, sid::get_stride<dim::thread>(strides), thread);
+                    sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), i_block);
+                    sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), j_block);
+                    auto ptr = origin() + offset;
+                    tuple_util::for_each(
+                        [&](int_t size, auto info) {
+                            for (int_t k = 0; k < size; ++k) {
+                                tuple_util::for_each(
+                                    [&](auto cell) {
+                                        using extent_t = typename decltype(cell)::extent_t;
+                                        auto i_loop = sid::make_loop<dim::i>(extent_t::extend(dim::i(), i_size));
+                                        auto j_loop = sid::make_loop<dim::j>(extent_t::extend(dim::j(), j_size));
+                                        auto cell_ptr = ptr;
+                                        sid::shift(
+                                            cell_ptr, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                                        sid::shift(
+                                            cell_ptr, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+                                        i_loop(j_loop(cell))(cell_ptr, strides);
+                                    },
+                                    info.cells());
+                                info.inc_k(ptr, strides);
+                                slide_k_caches(k_caches, ptr, strides, thread, info.k_step());
+                            }
+                        },
+                        k_sizes,
+                        mss_t::interval_infos());
+                };
+            }
+
+            /**
+             *  Multistages with k-caches are executed as a whole (see above), all others are split into stages.
+             */
+            template <class Matrix,
+                class Mss = be_api::make_fused_view_item<Matrix>,
+                class Stages = meta::transform<be_api::make_split_view_item, be_api::fuse_stage_rows<Matrix>>>
+            using make_items = meta::if_<has_k_caches<Mss>, meta::list<Mss>, Stages>;
+
+            template <class Spec>
+            using make_view = meta::rename<be_api::aggregated_view, meta::flatten<meta::transform<make_items, Spec>>>;
+
+            using tmp_allocator = decltype(sid::make_cached_allocator(&std::make_unique<char[]>));
+
+            template <class Stages>
+            using make_tmp_plh_map = be_api::remove_caches_from_plh_map<
+                meta::filter<meta::not_<is_k_cached>::apply, typename Stages::tmp_plh_map_t>>;
+
+            template <class ThreadPool, class Stages, class Grid, class IBlockSize, class JBlockSize>
+            auto make_temporaries(
+                tmp_allocator &alloc, Grid const &grid, IBlockSize i_block_size, JBlockSize j_block_size) {
+                return be_api::make_data_stores(make_tmp_plh_map<Stages>(), [&](auto info) {
+                    auto extent = info.extent();
+                    auto interval = Stages::interval();
+                    auto num_colors = info.num_colors();
+                    auto offsets =
+                        tuple_util::make<hymap::keys<dim::i, dim::j, dim::k>::values>(-extent.minus(dim::i()),
+                            -extent.minus(dim::j()),
+                            -grid.k_start(interval) - extent.minus(dim::k()));
+                    auto sizes =
+                        tuple_util::make<hymap::keys<dim::c, dim::k, dim::j, dim::i, dim::thread>::values>(num_colors,
+                            grid.k_size(interval, extent),
+                            extent.extend(dim::j(), j_block_size),
+                            extent.extend(dim::i(), i_block_size),
+                            thread_pool::get_max_threads(ThreadPool()));
+
+                    using stride_kind = meta::list<decltype(extent), decltype(num_colors)>;
+                    return sid::shift_sid_origin(
+                        sid::make_contiguous<decltype(info.data()), int_t, stride_kind>(alloc, sizes), offsets);
+                });
+            }
+
+            template <class ThreadPool,
+                class Stages,
+                class Grid,
+                class IBlockSize,
+                class JBlockSize,
+                class Temporaries,
+                class DataStores>
+            auto make_stage_loops(Grid const &grid,
+                IBlockSize i_block_size,
+                JBlockSize j_block_size,
+                Temporaries const &temporaries,
+                DataStores external_data_stores) {
+                auto blocked_external_data_stores = tuple_util::transform(
+                    [&](auto &&data_store) {
+                        return sid::block(std::forward<decltype(data_store)>(data_store),
+                            hymap::keys<dim::i, dim::j>::values<IBlockSize, JBlockSize>(i_block_size, j_block_size));
+                    },
+                    fill_flush::transform_data_stores<typename Stages::plh_map_t>(std::move(external_data_stores)));
+
+                auto data_stores = hymap::concat(std::move(blocked_external_data_stores), temporaries);
+
+                return tuple_util::transform(
+                    [&](auto stage) {
+                        return make_stage_loop(ThreadPool(), stage, grid, data_stores, i_block_size, j_block_size);
+                    },
+                    meta::rename<tuple, Stages>());
+            }
+
+            /**
+             *  The temporaries and the blocking are prepared once. The stage loops (and the k-caches they own) are
+             *  rebuilt only when the fields are rebound.
+             */
+            template <class ThreadPool, class IBlockSize, class JBlockSize, class Spec, class Grid, class DataStores>
+            class plan {
+                using stages_t = make_view<fill_flush::transform_spec<Spec>>;
+                using temporaries_t = decltype(make_temporaries<ThreadPool, stages_t>(
+                    std::declval<tmp_allocator &>(), std::declval<Grid const &>(), IBlockSize(), JBlockSize()));
+                using stage_loops_t = decltype(make_stage_loops<ThreadPool, stages_t>(std::declval<Grid const &>(),
+                    IBlockSize(),
+                    JBlockSize(),
+                    std::declval<temporaries_t const &>(),
+                    std::declval<DataStores>()));
+
+                Grid m_grid;
+                IBlockSize m_i_block_size;
+                JBlockSize m_j_block_size;
+                tmp_allocator m_alloc;
+                temporaries_t m_temporaries;
+                std::unique_ptr<stage_loops_t> m_stage_loops;
+
+              public:
+                plan(Grid const &grid, IBlockSize i_block_size, JBlockSize j_block_size, DataStores data_stores)
+                    : m_grid(grid), m_i_block_size(i_block_size), m_j_block_size(j_block_size),
+                      m_alloc(sid::make_cached_allocator(&std::make_unique<char[]>)),
+                      m_temporaries(
+                          make_temporaries<ThreadPool, stages_t>(m_alloc, grid, i_block_size, j_block_size)) {
+                    assert(i_block_size > 0 && j_block_size > 0);
+                    rebind(std::move(data_stores));
+                }
+
+                void rebind(DataStores data_stores) {
+                    assert(fill_flush::validate_k_bounds<Spec>(m_grid, data_stores));
+                    m_stage_loops.reset(new stage_loops_t(make_stage_loops<ThreadPool, stages_t>(
+                        m_grid, m_i_block_size, m_j_block_size, m_temporaries, std::move(data_stores))));
+                }
+
+                void operator()() const {
+                    int_t total_i = m_grid.i_size();
+                    int_t total_j = m_grid.j_size();
+
+                    int_t NBI = (total_i + m_i_block_size - 1) / m_i_block_size;
+                    int_t NBJ = (total_j + m_j_block_size - 1) / m_j_block_size;
+
+                    // the independent groups of stages are distributed over the threads in addition to the blocks
+                    using groups_t = be_api::make_independent_groups<stages_t>;
+                    auto const &stage_loops = *m_stage_loops;
+                    thread_pool::parallel_for_loop(ThreadPool(),
+                        [&](int_t group, int_t bj, int_t bi) {
+                            int_t i_size = bi + 1 == NBI ? total_i - bi * m_i_block_size : m_i_block_size;
+                            int_t j_size = bj + 1 == NBJ ? total_j - bj * m_j_block_size : m_j_block_size;
+                            be_api::run_group<groups_t>(group, stage_loops, bi, bj, i_size, j_size);
+                        },
+                        int_t(meta::length<groups_t>::value),
+                        NBJ,
+                        NBI);
+                }
+            };
+
+            /**
+             *  The i/j block sizes could be given either as `integral_constant`s (compile time tiling) or as `int_t`
+             *  (run time tiling). In the latter case the sizes are taken from the backend instance:
+             *  `cpu_kfirst<int_t, int_t>{i_block_size, j_block_size}`
+             */
+            template <class IBlockSize = integral_constant<int_t, 8>,
+                class JBlockSize = integral_constant<int_t, 8>,
+                class ThreadPool = thread_pool::omp>
+            struct cpu_kfirst {
+                IBlockSize i_block_size = {};
+                JBlockSize j_block_size = {};
+            };
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class F>
+            auto gridtools_backend_async(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool>, F &&f) {
+                return thread_pool::async(ThreadPool(), std::forward<F>(f));
+            }
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class Dep, class F>
+            auto gridtools_backend_async_after(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool>, Dep &&dep, F &&f) {
+                return thread_pool::async_after(ThreadPool(), std::forward<Dep>(dep), std::forward<F>(f));
+            }
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class Spec, class Grid, class DataStores>
+            plan<ThreadPool, IBlockSize, JBlockSize, Spec, Grid, DataStores> gridtools_backend_make_plan(
+                cpu_kfirst<IBlockSize, JBlockSize, ThreadPool> be, Spec, Grid const &grid, DataStores data_stores) {
+                return {grid, be.i_block_size, be.j_block_size, std::move(data_stores)};
+            }
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class Spec, class Grid, class DataStores>
+            void gridtools_backend_entry_point(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool> be,
+                Spec,
+                Grid const &grid,
+                DataStores external_data_stores) {
+                plan<ThreadPool, IBlockSize, JBlockSize, Spec, Grid, DataStores>(
+                    grid, be.i_block_size, be.j_block_size, std::move(external_data_stores))();
+            }
+        } // namespace cpu_kfirst_backend
+        using cpu_kfirst_backend::cpu_kfirst;
+    } // namespace stencil
+} // namespace gridtools
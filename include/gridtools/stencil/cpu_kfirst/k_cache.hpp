@@ -0,0 +1,204 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "../../common/defs.hpp"
+#include "../../common/for_each.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/simple_ptr_holder.hpp"
+#include "../../sid/synthetic.hpp"
+#include "../be_api.hpp"
+#include "../common/caches.hpp"
+#include "../common/dim.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_kfirst_backend {
+            namespace k_cache_impl_ {
+                template <class Key>
+                struct strides_kind;
+
+                /**
+                 *  The pointer into a k-cache: the entry of the plane table of the current k-level and the offset
+                 *  within the plane. Shifting along k (or to another thread) moves along the tables, all other
+                 *  dimensions move within the plane.
+                 */
+                template <class T>
+                struct ring_ptr {
+                    T *const *m_plane;
+                    int_t m_offset;
+
+                    T &operator*() const { return (*m_plane)[m_offset]; }
+
+                    ring_ptr &operator+=(int_t offset) {
+                        m_offset += offset;
+                        return *this;
+                    }
+                };
+
+                struct ring_ptr_diff {
+                    int_t m_planes = 0;
+                    int_t m_offset = 0;
+
+                    ring_ptr_diff &operator+=(int_t offset) {
+                        m_offset += offset;
+                        return *this;
+                    }
+                };
+
+                template <class T>
+                ring_ptr<T> operator+(ring_ptr<T> lhs, ring_ptr_diff rhs) {
+                    return {lhs.m_plane + rhs.m_planes, lhs.m_offset + rhs.m_offset};
+                }
+
+                // the stride of the dimensions that move along the plane tables: k and thread
+                struct table_stride {
+                    int_t m_value;
+                };
+
+                template <class T, class Offset>
+                void sid_shift(ring_ptr<T> &ptr, table_stride stride, Offset offset) {
+                    ptr.m_plane += stride.m_value * offset;
+                }
+
+                template <class Offset>
+                void sid_shift(ring_ptr_diff &diff, table_stride stride, Offset offset) {
+                    diff.m_planes += stride.m_value * offset;
+                }
+
+                /**
+                 *  k-cache for a single placeholder.
+                 *
+                 *  Each thread owns a window of `Plus - Minus + 1` horizontal planes, one per accessible k-offset.
+                 *  A plane covers the i/j block extended by the extent of the multistage.
+                 *  The window is a ring buffer: the planes are reached through a table per thread that maps the
+                 *  k-offsets to the planes, starting from a base plane. When the computation advances along k, only
+                 *  the base rotates and the table is rewritten, the planes themselves stay in place. So the cache
+                 *  stays in L1 for the whole column sweep without copying planes.
+                 */
+                template <class Key, class T, int_t Minus, int_t Plus>
+                class storage {
+                    static constexpr int_t size = Plus - Minus + 1;
+                    // the tables of the threads are padded to separate cache lines
+                    static constexpr int_t table_size = (size * sizeof(T *) + 63) / 64 * 64 / sizeof(T *);
+
+                    int_t m_j_size;
+                    int_t m_plane_size;
+                    int_t m_i_offset;
+                    int_t m_j_offset;
+                    std::unique_ptr<T[]> m_data;
+                    std::unique_ptr<T *[]> m_tables_data;
+                    T **m_tables;
+
+                    void set_table(int_t thread, int_t base) const {
+                        T *first = m_data.get() + thread * m_plane_size * size;
+                        T **table = m_tables + thread * table_size;
+                        for (int_t n = 0; n < size; ++n)
+                            table[n] = first + (base + n) % size * m_plane_size;
+                    }
+
+                    int_t base(int_t thread) const {
+                        return (m_tables[thread * table_size] - (m_data.get() + thread * m_plane_size * size)) /
+                               m_plane_size;
+                    }
+
+                  public:
+                    storage(int_t i_size, int_t j_size, int_t i_offset, int_t j_offset, int_t num_threads)
+                        : m_j_size(j_size), m_plane_size(i_size * j_size), m_i_offset(i_offset), m_j_offset(j_offset),
+                          m_data(new T[m_plane_size * size * num_threads]),
+                          m_tables_data(new T *[table_size * num_threads + 64 / sizeof(T *)]) {
+                        void *tables = m_tables_data.get();
+                        std::size_t bytes = table_size * num_threads * sizeof(T *);
+                        std::size_t space = bytes + 64;
+                        m_tables = static_cast<T **>(std::align(64, bytes, tables, space));
+                        for (int_t thread = 0; thread < num_threads; ++thread)
+                            set_table(thread, 0);
+                    }
+
+                    auto sid() const {
+                        return sid::synthetic()
+                            .set<sid::property::origin>(sid::make_simple_ptr_holder(
+                                ring_ptr<T>{m_tables - Minus, m_i_offset * m_j_size + m_j_offset}))
+                            .template set<sid::property::strides>(
+                                tuple_util::make<hymap::keys<dim::i, dim::j, dim::k, dim::thread>::values>(
+                                    m_j_size, integral_constant<int_t, 1>(), table_stride{1}, table_stride{table_size}))
+                            .template set<sid::property::strides_kind, strides_kind<Key>>()
+                            .template set<sid::property::ptr_diff, ring_ptr_diff>();
+                    }
+
+                    template <int_t Step>
+                    void slide(int_t thread, integral_constant<int_t, Step>) const {
+                        set_table(thread, (base(thread) + Step + size) % size);
+                    }
+                };
+
+                template <class PlhInfo>
+                using is_k_cached = std::is_same<typename PlhInfo::caches_t, meta::list<cache_type::k>>;
+
+                template <class Mss>
+                using has_k_caches = meta::any_of<is_k_cached, typename Mss::plh_map_t>;
+
+                template <class Mss>
+                auto make_k_caches(int_t i_size, int_t j_size, int_t num_threads) {
+                    using extent_t = typename Mss::extent_t;
+                    return be_api::make_data_stores<be_api::get_key>(
+                        meta::filter<is_k_cached, typename Mss::plh_map_t>(), [&](auto info) {
+                            using info_t = decltype(info);
+                            return storage<typename info_t::key_t,
+                                std::remove_const_t<typename info_t::data_t>,
+                                info_t::extent_t::kminus::value,
+                                info_t::extent_t::kplus::value>(extent_t::extend(dim::i(), i_size),
+                                extent_t::extend(dim::j(), j_size),
+                                -extent_t::minus(dim::i()),
+                                -extent_t::minus(dim::j()),
+                                num_threads);
+                        });
+                }
+
+                /**
+                 *  The k-caches stay in place when the computation advances along k.
+                 *  Undoes the shift by `offset` along k of the k-cache part of the pointer (or of the pointer diff).
+                 */
+                template <class KCaches, class Ptr, class Strides, class Offset>
+                void unshift_k_caches(KCaches const &, Ptr &ptr, Strides const &strides, Offset offset) {
+                    for_each<get_keys<KCaches>>([&](auto key) {
+                        using key_t = decltype(key);
+                        sid::shift(at_key<key_t>(ptr), sid::get_stride_element<key_t, dim::k>(strides), -offset);
+                    });
+                }
+
+                /**
+                 *  Moves all k-caches of the thread one step along k.
+                 *  Should be called after the pointer is advanced.
+                 */
+                template <class KCaches, class Ptr, class Strides, class Step>
+                void slide_k_caches(
+                    KCaches const &k_caches, Ptr &ptr, Strides const &strides, int_t thread, Step step) {
+                    tuple_util::for_each([&](auto const &k_cache) { k_cache.slide(thread, step); }, k_caches);
+                    unshift_k_caches(k_caches, ptr, strides, step);
+                }
+            } // namespace k_cache_impl_
+
+            using k_cache_impl_::has_k_caches;
+            using k_cache_impl_::is_k_cached;
+            using k_cache_impl_::make_k_caches;
+            using k_cache_impl_::slide_k_caches;
+            using k_cache_impl_::unshift_k_caches;
+        } // namespace cpu_kfirst_backend
+    }     // namespace stencil
+} // namespace gridtools
@@ -14,6 +14,7 @@
 #include "common/intent.hpp"
 #include "frontend/axis.hpp"
 #include "frontend/expandable_run.hpp"
+#include "frontend/fused_run.hpp"
 #include "frontend/make_grid.hpp"
 #include "frontend/make_param_list.hpp"
 #include "frontend/run.hpp"
@@ -0,0 +1,139 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../../common/tuple.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "run.hpp"
+
+/**
+ *  Fusion of the consecutive computations into a single one.
+ *
+ *  `fuse(specs...)` concatenates the multi-stages of the given specifications. The placeholders that are shared by the
+ *  specifications refer to the same field. Because the backend sees the whole sequence at once, it can fuse the
+ *  stages across what otherwise would be the separate runs and keep the intermediate fields in cache.
+ *
+ *  `make_fused_run(fields...)` is the deferred form of a sequence of `run` calls: the fields are bound once and each
+ *  computation added with `then<Is...>(comp)` gets the fields with the given positions. Fields with the same position
+ *  are the same field for all computations.
+ *
+ *  Note that the fused computation has the semantics of a single `run`: if an intermediate field is read with a
+ *  horizontal extent, it is computed in the halo as well instead of being read from there. Hence the computations
+ *  should not be fused across halo exchanges or boundary conditions of the intermediate fields.
+ */
+namespace gridtools {
+    namespace stencil {
+        namespace fused_run_impl_ {
+            template <class... Msses>
+            frontend_impl_::spec<Msses...> as_spec(frontend_impl_::spec<Msses...>);
+
+            template <class Spec, class... Specs>
+            constexpr meta::concat<decltype(as_spec(Spec())), decltype(as_spec(Specs()))...> fuse(Spec, Specs...) {
+                return {};
+            }
+
+            template <class Comp, size_t... Is>
+            struct bound_comp {
+                Comp m_comp;
+
+                template <class... Args>
+                auto operator()(Args... args) const {
+                    static_assert(conjunction<bool_constant<(Is < sizeof...(Args))>...>::value,
+                        "The field position is out of range.");
+                    return m_comp(tuple_util::get<Is>(tuple<Args...>(args...))...);
+                }
+            };
+
+            template <class F>
+            struct single_stage_comp {
+                template <class... Args>
+                auto operator()(Args... args) const {
+                    return execute_parallel().stage(F(), args...);
+                }
+            };
+
+            template <class... BoundComps>
+            struct fused_comp {
+                tuple<BoundComps...> m_comps;
+
+                template <class... Args>
+                auto operator()(Args... args) const {
+                    return tuple_util::apply([&](auto const &... comps) { return fuse(comps(args...)...); }, m_comps);
+                }
+            };
+
+            template <class Fields, class Comp>
+            class fused_run;
+
+            /**
+             *  The sequence of the computations together with the fields they are applied to.
+             *  Nothing is executed until `run(backend, grid)` is called.
+             */
+            template <class... Fields, class... BoundComps>
+            class fused_run<tuple<Fields...>, fused_comp<BoundComps...>> {
+                tuple<Fields...> m_fields;
+                fused_comp<BoundComps...> m_comp;
+
+              public:
+                fused_run(tuple<Fields...> fields, fused_comp<BoundComps...> comp)
+                    : m_fields(std::move(fields)), m_comp(std::move(comp)) {}
+
+                template <size_t... Is, class Comp>
+                fused_run<tuple<Fields...>, fused_comp<BoundComps..., bound_comp<Comp, Is...>>> then(
+                    Comp comp) const {
+                    using comps_t = tuple<BoundComps..., bound_comp<Comp, Is...>>;
+                    return {m_fields,
+                        {tuple_util::apply(
+                            [&](auto const &... comps) { return comps_t(comps..., bound_comp<Comp, Is...>{comp}); },
+                            m_comp.m_comps)}};
+                }
+
+                template <size_t... Is, class F>
+                auto then_single_stage(F) const {
+                    return then<Is...>(single_stage_comp<F>());
+                }
+
+                // the specification of the fused computation, usable with `run`, `make_stencil_plan` etc.
+                fused_comp<BoundComps...> const &comp() const { return m_comp; }
+
+                template <class Backend, class Grid>
+                void run(Backend &&be, Grid const &grid) const {
+                    static_assert(sizeof...(BoundComps) > 0, "No computations to run.");
+                    tuple_util::apply(
+                        [&](auto const &... fields) {
+                            stencil::run(m_comp, std::forward<Backend>(be), grid, fields...);
+                        },
+                        m_fields);
+                }
+
+                template <class Backend, class Grid>
+                auto make_plan(Backend be, Grid const &grid) const {
+                    static_assert(sizeof...(BoundComps) > 0, "No computations to run.");
+                    return tuple_util::apply(
+                        [&](auto const &... fields) { return make_stencil_plan(m_comp, be, grid, fields...); },
+                        m_fields);
+                }
+            };
+
+            template <class... Fields>
+            fused_run<tuple<std::decay_t<Fields>...>, fused_comp<>> make_fused_run(Fields &&... fields) {
+                static_assert(
+                    conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                return {tuple<std::decay_t<Fields>...>(std::forward<Fields>(fields)...), {}};
+            }
+        } // namespace fused_run_impl_
+        using fused_run_impl_::fuse;
+        using fused_run_impl_::make_fused_run;
+    } // namespace stencil
+} // namespace gridtools
@@ -11,11 +11,14 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
 #include "../../common/for_each.hpp"
 #include "../../common/hymap.hpp"
+#include "../../common/tuple.hpp"
+#include "../../common/tuple_util.hpp"
 #include "../../meta.hpp"
 #include "../../sid/concept.hpp"
 #include "../common/caches.hpp"
@@ -198,23 +201,29 @@ namespace gridtools {
                 using apply = core::check_valid_apply_overloads<Functor, Interval>;
             };
 
-            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
-            auto run_impl(Comp comp, Backend &&be, Grid const &grid, std::index_sequence<Is...>, Fields &&... fields)
-                -> void_t<decltype(comp(arg<Is>()...))> {
-                using spec_t = decltype(comp(arg<Is>()...));
+            template <class Spec, class Grid>
+            struct validate_spec {
                 static_assert(
-                    meta::is_instantiation_of<spec, spec_t>::value, "Invalid stencil composition specification.");
+                    meta::is_instantiation_of<spec, Spec>::value, "Invalid stencil composition specification.");
                 static_assert(
                     meta::is_instantiation_of<core::interval, typename Grid::interval_t>::value, "Invalid grid.");
-                using functors_t = meta::transform<meta::first, meta::flatten<meta::transform<meta::second, spec_t>>>;
+                using functors_t = meta::transform<meta::first, meta::flatten<meta::transform<meta::second, Spec>>>;
                 static_assert(meta::all_of<check_valid_apply_overloads<typename Grid::interval_t>::template apply,
                                   functors_t>::value,
                     "Invalid stencil operator detected.");
 
-                using data_store_map_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
+                using type = Spec;
+            };
+
 #ifndef NDEBUG
-                using extent_map_t = core::get_extent_map_from_msses<spec_t>;
-                auto check_bounds = [origin = grid.origin(), size = grid.size()](auto arg, auto const &field) {
+            /**
+             *  Asserts that the fields cover the computation domain extended by the extents with which the stencil
+             *  accesses them.
+             */
+            template <class Spec, class Grid, size_t... Is, class... Fields>
+            void check_bounds(Grid const &grid, std::index_sequence<Is...>, Fields const &... fields) {
+                using extent_map_t = core::get_extent_map_from_msses<Spec>;
+                auto check = [origin = grid.origin(), size = grid.size()](auto arg, auto const &field) {
                     using extent_t = core::lookup_extent_map<extent_map_t, decltype(arg)>;
                     // There is no check in k-direction because at the fields may be used within subintervals
                     // TODO(anstaf): find the proper place to check k-bounds
@@ -228,8 +237,20 @@ namespace gridtools {
                     return 0;
                 };
                 using loop_t = int[sizeof...(Is)];
-                (void)loop_t{check_bounds(arg<Is>(), fields)...};
+                (void)loop_t{check(arg<Is>(), fields)...};
+            }
+#else
+            template <class Spec, class Grid, class Indices, class... Fields>
+            void check_bounds(Grid const &, Indices, Fields const &...) {}
 #endif
+
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            auto run_impl(Comp comp, Backend &&be, Grid const &grid, std::index_sequence<Is...>, Fields &&... fields)
+                -> void_t<decltype(comp(arg<Is>()...))> {
+                using spec_t = typename validate_spec<decltype(comp(arg<Is>()...)), Grid>::type;
+
+                using data_store_map_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
+                check_bounds<spec_t>(grid, std::index_sequence<Is...>(), fields...);
                 core::call_entry_point_f<spec_t>()(std::forward<Backend>(be), grid, data_store_map_t{fields...});
             }
 
@@ -257,6 +278,123 @@ namespace gridtools {
                     std::forward<Fields>(fields)...);
             }
 
+            template <class Spec, class Backend, class Grid, class Indices, class... Fields>
+            class stencil_plan;
+
+            /**
+             *  A computation with the specification, the backend, the grid and the fields bound once.
+             *
+             *  `plan()` executes it, `plan(fields...)` rebinds the fields (for example when the time levels are
+             *  rotated) and executes. The new fields should have the same types (and for the data stores, the same
+             *  sizes and layouts) as the ones the plan was created with.
+             */
+            template <class Spec, class Backend, class Grid, size_t... Is, class... Fields>
+            class stencil_plan<Spec, Backend, Grid, std::index_sequence<Is...>, Fields...> {
+                using fields_t = tuple<Fields...>;
+                using data_stores_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
+                using plan_t = decltype(core::make_plan_f<Spec>()(
+                    std::declval<Backend>(), std::declval<Grid const &>(), std::declval<data_stores_t>()));
+
+                // the fields are kept on the heap: the backend plan refers to them
+                std::unique_ptr<fields_t> m_fields;
+                Grid m_grid;
+                plan_t m_plan;
+
+                static data_stores_t data_stores(fields_t &fields) { return {tuple_util::get<Is>(fields)...}; }
+
+                fields_t &checked_fields() {
+                    check_bounds<Spec>(m_grid, std::index_sequence<Is...>(), tuple_util::get<Is>(*m_fields)...);
+                    return *m_fields;
+                }
+
+              public:
+                template <class... Args>
+                stencil_plan(Backend be, Grid const &grid, Args &&... fields)
+                    : m_fields(new fields_t(std::forward<Args>(fields)...)), m_grid(grid),
+                      m_plan(core::make_plan_f<Spec>()(std::move(be), grid, data_stores(checked_fields()))) {}
+
+                template <class... Args>
+                void rebind(Args &&... fields) {
+                    static_assert(sizeof...(Args) == sizeof...(Fields), "Wrong number of fields.");
+                    m_fields.reset(new fields_t(std::forward<Args>(fields)...));
+                    m_plan.rebind(data_stores(checked_fields()));
+                }
+
+                void operator()() const { m_plan(); }
+
+                template <class Arg, class... Args>
+                void operator()(Arg &&field, Args &&... fields) {
+                    rebind(std::forward<Arg>(field), std::forward<Args>(fields)...);
+                    m_plan();
+                }
+            };
+
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            auto make_stencil_plan_impl(
+                Comp comp, Backend be, Grid const &grid, std::index_sequence<Is...>, Fields &&... fields)
+                -> stencil_plan<typename validate_spec<decltype(comp(arg<Is>()...)), Grid>::type,
+                    Backend,
+                    Grid,
+                    std::index_sequence<Is...>,
+                    std::decay_t<Fields>...> {
+                return {std::move(be), grid, std::forward<Fields>(fields)...};
+            }
+
+            template <class... Ts>
+            void make_stencil_plan_impl(Ts...) {
+                static_assert(sizeof...(Ts) < 0, "Unexpected first argument of gridtools::stencil::make_stencil_plan.");
+            }
+
+            /**
+             *  Does the setup of `run(comp, be, grid, fields...)` (the temporaries allocation etc.) once and returns
+             *  the callable that does the rest. The fields are copied into the plan. In debug builds the fields are
+             *  checked against the grid as in `run`, when the plan is created and on every rebind.
+             *
+             *  Only the backends that provide `gridtools_backend_make_plan` (`cpu_ifirst` and `cpu_kfirst`) benefit
+             *  from the plan, for the others each execution does the full setup as `run` does.
+             */
+            template <class Comp, class Backend, class Grid, class... Fields>
+            auto make_stencil_plan(Comp comp, Backend be, Grid const &grid, Fields &&... fields) {
+                static_assert(
+                    conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                return make_stencil_plan_impl(
+                    comp, std::move(be), grid, std::index_sequence_for<Fields...>(), std::forward<Fields>(fields)...);
+            }
+
+            // the task that does `run(comp, be, grid, fields...)` with the copies of the fields
+            template <class Comp, class Backend, class Grid, class... Fields>
+            auto make_run_task(Comp comp, Backend be, Grid const &grid, Fields &&... fields) {
+                static_assert(
+                    conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                return [comp,
+                           be,
+                           grid,
+                           fields = tuple<std::decay_t<Fields>...>(std::forward<Fields>(fields)...)]() mutable {
+                    tuple_util::apply([&](auto &... args) { run(comp, be, grid, args...); }, fields);
+                };
+            }
+
+            /**
+             *  Starts `run(comp, be, grid, fields...)` asynchronously and returns the future of it.
+             *  The fields are copied, the data they refer to must stay alive until the future is ready.
+             *  The backend decides where the computation is executed (see `core::backend_async`).
+             */
+            template <class Comp, class Backend, class Grid, class... Fields>
+            auto run_async(Comp comp, Backend be, Grid const &grid, Fields &&... fields) {
+                return core::backend_async(be, make_run_task(comp, be, grid, std::forward<Fields>(fields)...));
+            }
+
+            /**
+             *  As `run_async`, but the computation starts once the future `dep` (for example the one of a previous
+             *  `run_async`) is ready. The call doesn't wait for `dep`, the computation is enqueued right away (see
+             *  `core::backend_async_after`). The exception of `dep` is propagated to the returned future.
+             */
+            template <class Dep, class Comp, class Backend, class Grid, class... Fields>
+            auto run_async_after(Dep &&dep, Comp comp, Backend be, Grid const &grid, Fields &&... fields) {
+                return core::backend_async_after(
+                    be, std::forward<Dep>(dep), make_run_task(comp, be, grid, std::forward<Fields>(fields)...));
+            }
+
             template <class... Msses, class Arg>
             constexpr core::lookup_extent_map<core::get_extent_map_from_msses<spec<Msses...>>, Arg> get_arg_extent(
                 spec<Msses...>, Arg) {
@@ -284,8 +422,11 @@ namespace gridtools {
         using frontend_impl_::execute_parallel;
         using frontend_impl_::get_arg_extent;
         using frontend_impl_::get_arg_intent;
+        using frontend_impl_::make_stencil_plan;
         using frontend_impl_::multi_pass;
         using frontend_impl_::run;
+        using frontend_impl_::run_async;
+        using frontend_impl_::run_async_after;
         using frontend_impl_::run_single_stage;
     } // namespace stencil
 } // namespace gridtools
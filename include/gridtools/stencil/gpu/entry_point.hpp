@@ -30,7 +30,7 @@
 #include "../common/caches.hpp"
 #include "../common/dim.hpp"
 #include "../common/extent.hpp"
-#include "fill_flush.hpp"
+#include "../common/fill_flush.hpp"
 #include "ij_cache.hpp"
 #include "k_cache.hpp"
 #include "launch_kernel.hpp"
@@ -25,9 +25,27 @@
  *     thread_pool_parallel_for_loop(pool, func, lim0, lim1, lim2);
  *     etc.
  *   They are optional and could be provided for performance reasons.
+ *
+ *   Another optional function runs a task asynchronously and returns a future of the result:
+ *     thread_pool_async(pool, task);
+ *   If it is not provided, `std::async` with the `std::launch::async` policy is used.
+ *
+ *   And one more runs a task asynchronously after the future `dep` is ready, without waiting for it:
+ *     thread_pool_async_after(pool, dep, task);
+ *   If it is not provided, the task and the wait for `dep` are run by `std::async`.
+ *
+ *   The pool could lend one of its cores to a helper thread (like the MPI progress thread) with the pair:
+ *     thread_pool_reserve_core(pool);
+ *     thread_pool_release_core(pool);
+ *   While reserved, the parallel loops of the pool use one thread less. `thread_pool_reserve_core` returns the cpu the
+ *   helper thread should be pinned to or -1 if there is none. The calls nest, a release undoes the latest reserve.
+ *   If they are not provided, the pool keeps all its threads.
  */
 
+#include <future>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "../common/stride_util.hpp"
 #include "../common/tuple_util.hpp"
@@ -62,10 +80,81 @@ namespace gridtools {
                 -> decltype(thread_pool_parallel_for_loop(obj, f, limits...)) {
                 return thread_pool_parallel_for_loop(obj, f, limits...);
             }
+
+            template <class T, class F>
+            auto async_impl(int, T const &obj, F &&f) -> decltype(thread_pool_async(obj, std::forward<F>(f))) {
+                return thread_pool_async(obj, std::forward<F>(f));
+            }
+
+            template <class T, class F>
+            std::future<std::result_of_t<std::decay_t<F>()>> async_impl(long, T const &, F &&f) {
+                return std::async(std::launch::async, std::forward<F>(f));
+            }
+
+            template <class T, class F>
+            auto async(T const &obj, F &&f) {
+                return async_impl(0, obj, std::forward<F>(f));
+            }
+
+            template <class T, class Dep, class F>
+            auto async_after_impl(int, T const &obj, Dep &&dep, F &&f)
+                -> decltype(thread_pool_async_after(obj, std::forward<Dep>(dep), std::forward<F>(f))) {
+                return thread_pool_async_after(obj, std::forward<Dep>(dep), std::forward<F>(f));
+            }
+
+            template <class T, class Dep, class F>
+            std::future<std::result_of_t<std::decay_t<F>()>> async_after_impl(long, T const &, Dep &&dep, F &&f) {
+                return std::async(
+                    std::launch::async, [dep = std::forward<Dep>(dep), f = std::forward<F>(f)]() mutable {
+                        dep.get();
+                        return f();
+                    });
+            }
+
+            /**
+             *  Runs `f` asynchronously once the future `dep` is ready and returns the future of the result.
+             *  The caller doesn't wait for `dep`. The exception of `dep` is propagated to the returned future.
+             */
+            template <class T, class Dep, class F>
+            auto async_after(T const &obj, Dep &&dep, F &&f) {
+                return async_after_impl(0, obj, std::forward<Dep>(dep), std::forward<F>(f));
+            }
+
+            template <class T>
+            auto reserve_core_impl(int, T const &obj) -> decltype(thread_pool_reserve_core(obj)) {
+                return thread_pool_reserve_core(obj);
+            }
+
+            template <class T>
+            int reserve_core_impl(long, T const &) {
+                return -1;
+            }
+
+            template <class T>
+            auto release_core_impl(int, T const &obj) -> decltype(thread_pool_release_core(obj)) {
+                thread_pool_release_core(obj);
+            }
+
+            template <class T>
+            void release_core_impl(long, T const &) {}
+
+            template <class T>
+            int reserve_core(T const &obj) {
+                return reserve_core_impl(0, obj);
+            }
+
+            template <class T>
+            void release_core(T const &obj) {
+                release_core_impl(0, obj);
+            }
         } // namespace concept_impl_
 
+        using concept_impl_::async;
+        using concept_impl_::async_after;
         using concept_impl_::get_max_threads;
         using concept_impl_::get_thread_num;
         using concept_impl_::parallel_for_loop;
+        using concept_impl_::release_core;
+        using concept_impl_::reserve_core;
     } // namespace thread_pool
 } // namespace gridtools
@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include <utility>
+
+#include <hpx/include/async.hpp>
 #include <hpx/include/parallel_for_loop.hpp>
 #include <hpx/include/runtime.hpp>
 
@@ -24,6 +27,21 @@ namespace gridtools {
             friend void thread_pool_parallel_for_loop(hpx, F const &f, I lim) {
                 ::hpx::parallel::for_loop(::hpx::parallel::execution::par, 0, lim, f);
             }
+
+            // the task runs on an hpx thread: the parallel loops inside of it suspend it instead of blocking
+            template <class F>
+            friend auto thread_pool_async(hpx, F &&f) {
+                return ::hpx::async(std::forward<F>(f));
+            }
+
+            // `dep` is an hpx future: the task is attached to it as a continuation
+            template <class Dep, class F>
+            friend auto thread_pool_async_after(hpx, Dep &&dep, F &&f) {
+                return std::forward<Dep>(dep).then([f = std::forward<F>(f)](auto &&dep) mutable {
+                    dep.get();
+                    return f();
+                });
+            }
         };
     } // namespace thread_pool
 } // namespace gridtools
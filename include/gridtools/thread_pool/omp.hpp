@@ -14,8 +14,18 @@
 #include <omp.h>
 #endif
 
+#include <vector>
+
 namespace gridtools {
     namespace thread_pool {
+        namespace omp_impl_ {
+            // the numbers of threads of the calling thread before the reservations of the cores
+            inline std::vector<int> &reserved() {
+                thread_local std::vector<int> res;
+                return res;
+            }
+        } // namespace omp_impl_
+
         struct omp {
 #if defined(_OPENMP) || defined(GT_HIP_OPENMP_WORKAROUND)
             friend auto thread_pool_get_thread_num(omp) { return omp_get_thread_num(); }
@@ -44,6 +54,24 @@ namespace gridtools {
                         for (I i = 0; i < i_lim; ++i)
                             f(i, j, k);
             }
+
+            // only the number of threads of the parallel regions of the calling thread is reduced, the threads are not
+            // pinned to the cores by this pool
+            friend int thread_pool_reserve_core(omp) {
+                int threads = omp_get_max_threads();
+                omp_impl_::reserved().push_back(threads);
+                if (threads > 1)
+                    omp_set_num_threads(threads - 1);
+                return -1;
+            }
+
+            friend void thread_pool_release_core(omp) {
+                auto &reserved = omp_impl_::reserved();
+                if (reserved.empty())
+                    return;
+                omp_set_num_threads(reserved.back());
+                reserved.pop_back();
+            }
 #endif
         };
     } // namespace thread_pool
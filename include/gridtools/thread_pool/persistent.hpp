@@ -0,0 +1,413 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace gridtools {
+    namespace thread_pool {
+        /**
+         *  Placement of the worker threads of the persistent pool.
+         *
+         *  none:    the threads are not pinned;
+         *  compact: the threads fill the cores of the first NUMA domain before moving to the next one;
+         *  scatter: consecutive threads are placed round robin on the NUMA domains.
+         */
+        enum class affinity { none, compact, scatter };
+
+        namespace persistent_impl_ {
+            inline int &thread_num() {
+                thread_local int res = 0;
+                return res;
+            }
+
+            inline bool &in_parallel_region() {
+                thread_local bool res = false;
+                return res;
+            }
+
+            constexpr int spin_count = 1 << 10;
+            constexpr int yield_count = 1 << 14;
+
+            // busy waiting step: the first `spin_count` steps just pause the cpu, then the time slice is yielded
+            inline void relax(int step) {
+                if (step >= spin_count)
+                    std::this_thread::yield();
+#if defined(__x86_64__) || defined(__i386__)
+                else
+                    __builtin_ia32_pause();
+#endif
+            }
+
+            // parses the linux cpu list format, like "0-3,8,10-11"
+            inline std::vector<int> parse_cpu_list(std::string const &src) {
+                std::vector<int> res;
+                std::istringstream in(src);
+                std::string item;
+                while (std::getline(in, item, ',')) {
+                    if (item.empty() || item == "\n")
+                        continue;
+                    auto dash = item.find('-');
+                    int first = std::atoi(item.substr(0, dash).c_str());
+                    int last = dash == std::string::npos ? first : std::atoi(item.substr(dash + 1).c_str());
+                    for (int cpu = first; cpu <= last; ++cpu)
+                        res.push_back(cpu);
+                }
+                return res;
+            }
+
+            /**
+             *  The order in which the CPUs are assigned to the threads.
+             *  Only the CPUs the process is allowed to run on are taken into account.
+             */
+            inline std::vector<int> cpu_order(affinity aff) {
+                std::vector<int> res;
+#ifdef __linux__
+                if (aff == affinity::none)
+                    return res;
+                cpu_set_t allowed;
+                if (sched_getaffinity(0, sizeof(allowed), &allowed))
+                    return res;
+                std::vector<std::vector<int>> domains;
+                for (int node = 0;; ++node) {
+                    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                    std::string list;
+                    if (!std::getline(in, list))
+                        break;
+                    std::vector<int> cpus;
+                    for (int cpu : parse_cpu_list(list))
+                        if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                            cpus.push_back(cpu);
+                    if (!cpus.empty())
+                        domains.push_back(std::move(cpus));
+                }
+                if (domains.empty()) {
+                    domains.emplace_back();
+                    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                        if (CPU_ISSET(cpu, &allowed))
+                            domains.back().push_back(cpu);
+                }
+                if (aff == affinity::compact) {
+                    for (auto const &cpus : domains)
+                        res.insert(res.end(), cpus.begin(), cpus.end());
+                } else {
+                    for (std::size_t i = 0; res.size() < (std::size_t)CPU_COUNT(&allowed); ++i)
+                        for (auto const &cpus : domains)
+                            if (i < cpus.size())
+                                res.push_back(cpus[i]);
+                }
+#endif
+                return res;
+            }
+
+            inline void pin_current_thread(int cpu) {
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+            }
+
+            /**
+             *  A set of worker threads that live as long as the pool.
+             *
+             *  The dispatch of a loop is signalled by bumping the generation counter, the workers busy wait on it for
+             *  `yield_count` steps before falling asleep on the condition variable. The calling thread participates
+             *  as the thread number zero and busy waits until all workers report the completion.
+             *  The iteration space is split statically into contiguous chunks, one per active thread. The last threads
+             *  are inactive while their cores are reserved for a helper thread, see `reserve_core`. They don't busy
+             *  wait.
+             */
+            class pool {
+                struct job {
+                    void (*m_fun)(void const *, long, long);
+                    void const *m_context;
+                    long m_size;
+                    int m_threads;
+                };
+
+                int m_num_threads;
+                std::vector<int> m_cpus;
+                int m_reserved = 0;
+                std::atomic<int> m_active_threads;
+                job m_job = {};
+                std::atomic<unsigned> m_generation{0};
+                std::atomic<int> m_pending{0};
+                std::atomic<int> m_sleeping{0};
+                std::atomic<bool> m_stop{false};
+                std::mutex m_mutex;
+                std::condition_variable m_wake_up;
+                std::mutex m_busy;
+                std::vector<std::thread> m_workers;
+
+                std::mutex m_tasks_mutex;
+                std::condition_variable m_tasks_added;
+                std::deque<std::function<void()>> m_tasks;
+                bool m_tasks_stop = false;
+                std::thread m_task_runner;
+
+                void execute(int thread) const {
+                    if (thread >= m_job.m_threads)
+                        return;
+                    long first = m_job.m_size * thread / m_job.m_threads;
+                    long last = m_job.m_size * (thread + 1) / m_job.m_threads;
+                    if (first < last)
+                        m_job.m_fun(m_job.m_context, first, last);
+                }
+
+                unsigned wait_for_job(int thread, unsigned seen) {
+                    int spin = thread < m_active_threads.load(std::memory_order_relaxed) ? yield_count : 0;
+                    for (int i = 0; i < spin; ++i) {
+                        unsigned cur = m_generation.load(std::memory_order_acquire);
+                        if (cur != seen)
+                            return cur;
+                        relax(i);
+                    }
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    ++m_sleeping;
+                    m_wake_up.wait(lock, [&] { return m_generation.load(std::memory_order_acquire) != seen; });
+                    --m_sleeping;
+                    return m_generation.load(std::memory_order_acquire);
+                }
+
+                void worker(int thread, int cpu) {
+                    thread_num() = thread;
+                    in_parallel_region() = true;
+                    if (cpu >= 0)
+                        pin_current_thread(cpu);
+                    unsigned seen = 0;
+                    while (true) {
+                        seen = wait_for_job(thread, seen);
+                        if (m_stop.load(std::memory_order_acquire))
+                            return;
+                        execute(thread);
+                        m_pending.fetch_sub(1, std::memory_order_release);
+                    }
+                }
+
+                void notify() {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_generation.fetch_add(1, std::memory_order_release);
+                    }
+                    if (m_sleeping.load())
+                        m_wake_up.notify_all();
+                }
+
+                void run_tasks() {
+                    while (true) {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock<std::mutex> lock(m_tasks_mutex);
+                            m_tasks_added.wait(lock, [&] { return m_tasks_stop || !m_tasks.empty(); });
+                            if (m_tasks.empty())
+                                return;
+                            task = std::move(m_tasks.front());
+                            m_tasks.pop_front();
+                        }
+                        task();
+                    }
+                }
+
+                int cpu_of(int thread) const { return m_cpus.empty() ? -1 : m_cpus[thread % m_cpus.size()]; }
+
+              public:
+                pool(int num_threads, affinity aff)
+                    : m_num_threads(std::max(num_threads, 1)), m_cpus(cpu_order(aff)), m_active_threads(m_num_threads) {
+                    for (int thread = 1; thread < m_num_threads; ++thread)
+                        m_workers.emplace_back([this, thread, cpu = cpu_of(thread)] { worker(thread, cpu); });
+                }
+
+                pool(pool const &) = delete;
+                pool &operator=(pool const &) = delete;
+
+                ~pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(m_tasks_mutex);
+                        m_tasks_stop = true;
+                    }
+                    m_tasks_added.notify_one();
+                    if (m_task_runner.joinable())
+                        m_task_runner.join();
+                    m_stop.store(true, std::memory_order_release);
+                    notify();
+                    for (auto &worker : m_workers)
+                        worker.join();
+                }
+
+                int num_threads() const { return m_num_threads; }
+
+                /**
+                 *  Nested calls are executed serially by the calling thread. Concurrent calls from different threads
+                 *  are serialized.
+                 */
+                template <class F, class I>
+                void parallel_for(F const &f, I lim) {
+                    auto fun = [](void const *context, long first, long last) {
+                        auto const &f = *static_cast<F const *>(context);
+                        for (long i = first; i < last; ++i)
+                            f(I(i));
+                    };
+                    if (lim <= 0)
+                        return;
+                    if (m_active_threads.load(std::memory_order_relaxed) == 1 || lim == 1 || in_parallel_region()) {
+                        fun(&f, 0, lim);
+                        return;
+                    }
+                    std::lock_guard<std::mutex> busy(m_busy);
+                    m_job = {fun, &f, (long)lim, m_active_threads.load(std::memory_order_relaxed)};
+                    m_pending.store(m_num_threads - 1, std::memory_order_relaxed);
+                    notify();
+                    in_parallel_region() = true;
+                    execute(0);
+                    in_parallel_region() = false;
+                    for (int i = 0; m_pending.load(std::memory_order_acquire); ++i)
+                        relax(i);
+                }
+
+                /**
+                 *  Takes the last active thread out of the parallel loops and returns the cpu it is pinned to, or -1 if
+                 *  the threads are not pinned or if only the calling thread is left. Undone by `release_core`.
+                 */
+                int reserve_core() {
+                    std::lock_guard<std::mutex> busy(m_busy);
+                    ++m_reserved;
+                    int active = std::max(m_num_threads - m_reserved, 1);
+                    bool reserved = active < m_active_threads.load(std::memory_order_relaxed);
+                    m_active_threads.store(active, std::memory_order_relaxed);
+                    return reserved ? cpu_of(active) : -1;
+                }
+
+                void release_core() {
+                    std::lock_guard<std::mutex> busy(m_busy);
+                    if (m_reserved == 0)
+                        return;
+                    --m_reserved;
+                    m_active_threads.store(std::max(m_num_threads - m_reserved, 1), std::memory_order_relaxed);
+                }
+
+                /**
+                 *  The tasks are executed one by one in the order of submission by a dedicated thread, that is
+                 *  started on the first call. Hence a task must not wait for the tasks that are submitted after it.
+                 */
+                template <class F>
+                std::future<std::result_of_t<std::decay_t<F>()>> async(F &&f) {
+                    auto task =
+                        std::make_shared<std::packaged_task<std::result_of_t<std::decay_t<F>()>()>>(std::forward<F>(f));
+                    auto res = task->get_future();
+                    {
+                        std::lock_guard<std::mutex> lock(m_tasks_mutex);
+                        if (!m_task_runner.joinable())
+                            m_task_runner = std::thread([this] { run_tasks(); });
+                        m_tasks.emplace_back([task] { (*task)(); });
+                    }
+                    m_tasks_added.notify_one();
+                    return res;
+                }
+            };
+
+            inline int env_num_threads() {
+                if (char const *value = std::getenv("GT_THREAD_POOL_NUM_THREADS"))
+                    if (int res = std::atoi(value))
+                        return res;
+                return std::max<int>(std::thread::hardware_concurrency(), 1);
+            }
+
+            inline affinity env_affinity() {
+                char const *value = std::getenv("GT_THREAD_POOL_AFFINITY");
+                if (value && !std::strcmp(value, "compact"))
+                    return affinity::compact;
+                if (value && !std::strcmp(value, "scatter"))
+                    return affinity::scatter;
+                return affinity::none;
+            }
+
+            inline std::unique_ptr<pool> &instance() {
+                static std::unique_ptr<pool> res;
+                return res;
+            }
+
+            inline pool &get_pool() {
+                static std::once_flag flag;
+                std::call_once(flag, [] {
+                    if (!instance())
+                        instance().reset(new pool(env_num_threads(), env_affinity()));
+                });
+                return *instance();
+            }
+        } // namespace persistent_impl_
+
+        /**
+         *  (Re)creates the persistent pool with the given parameters. If not called, the pool is created on the first
+         *  use with the number of threads and the affinity taken from `GT_THREAD_POOL_NUM_THREADS` and
+         *  `GT_THREAD_POOL_AFFINITY` (`none`, `compact` or `scatter`) environment variables.
+         *  Must not be called while the pool is in use.
+         */
+        inline void init_persistent(int num_threads, affinity aff = affinity::none) {
+            persistent_impl_::get_pool();
+            persistent_impl_::instance().reset();
+            persistent_impl_::instance().reset(new persistent_impl_::pool(num_threads, aff));
+        }
+
+        /**
+         *  Thread pool that keeps its (optionally pinned) worker threads alive between the parallel loops.
+         *  Cheaper than `omp` when many small loops are issued in a sequence.
+         */
+        struct persistent {
+            friend int thread_pool_get_thread_num(persistent) { return persistent_impl_::thread_num(); }
+            friend int thread_pool_get_max_threads(persistent) { return persistent_impl_::get_pool().num_threads(); }
+
+            template <class F, class I>
+            friend void thread_pool_parallel_for_loop(persistent, F const &f, I lim) {
+                persistent_impl_::get_pool().parallel_for(f, lim);
+            }
+
+            friend int thread_pool_reserve_core(persistent) { return persistent_impl_::get_pool().reserve_core(); }
+            friend void thread_pool_release_core(persistent) { persistent_impl_::get_pool().release_core(); }
+
+            template <class F>
+            friend auto thread_pool_async(persistent, F &&f) {
+                return persistent_impl_::get_pool().async(std::forward<F>(f));
+            }
+
+            // the continuation is queued right away, the task thread waits for `dep` when the task is reached
+            template <class Dep, class F>
+            friend auto thread_pool_async_after(persistent, Dep &&dep, F &&f) {
+                return persistent_impl_::get_pool().async(
+                    [dep = std::forward<Dep>(dep), f = std::forward<F>(f)]() mutable {
+                        dep.get();
+                        return f();
+                    });
+            }
+        };
+    } // namespace thread_pool
+} // namespace gridtools
@@ -168,20 +168,20 @@ namespace gridtools {
         } // namespace cpu_kfirst_backend
 
         namespace cpu_ifirst_backend {
-            template <class>
+            template <class, int_t>
             struct cpu_ifirst;
 
-            template <class T>
-            storage::cpu_ifirst backend_storage_traits(cpu_ifirst<T>);
+            template <class T, int_t SimdWidth>
+            storage::cpu_ifirst backend_storage_traits(cpu_ifirst<T, SimdWidth>);
 
-            template <class T>
-            std::false_type backend_supports_icosahedral(cpu_ifirst<T>);
+            template <class T, int_t SimdWidth>
+            std::false_type backend_supports_icosahedral(cpu_ifirst<T, SimdWidth>);
 
-            template <class T>
-            timer_omp backend_timer_impl(cpu_ifirst<T>);
+            template <class T, int_t SimdWidth>
+            timer_omp backend_timer_impl(cpu_ifirst<T, SimdWidth>);
 
-            template <class T>
-            char const *backend_name(cpu_ifirst<T> const &) {
+            template <class T, int_t SimdWidth>
+            char const *backend_name(cpu_ifirst<T, SimdWidth> const &) {
                 return "cpu_ifirst";
             }
 
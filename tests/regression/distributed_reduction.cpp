@@ -0,0 +1,144 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/reduction/distributed.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <gridtools/common/integral_constant.hpp>
+#include <gridtools/gcl/GCL.hpp>
+#include <gridtools/reduction.hpp>
+#include <gridtools/reduction/cpu.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+
+using namespace gridtools;
+using namespace reduction;
+
+namespace {
+    // the values of the global data, spanning many orders of magnitude and cancelling each other
+    double global_value(int i) { return (i % 7 - 3) * std::ldexp(1. + i % 11 / 11., (i * 37) % 120 - 60); }
+
+    constexpr int global_size = 1 << 12;
+
+    struct absmax {
+        double operator()(double x, double y) const { return std::abs(x) > std::abs(y) ? std::abs(x) : std::abs(y); }
+    };
+
+    // the reducible of the part of the global data owned by the caller in `comm`
+    template <class T = double>
+    auto make_local(MPI_Comm comm) {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        int n = global_size / size;
+        auto res = make_distributed_reducible(make_reducible<cpu, storage::cpu_ifirst>(T(0), n), comm);
+        auto ptr = sid::get_origin(res.local())();
+        auto stride = sid::get_stride<integral_constant<int, 0>>(sid::get_strides(res.local()));
+        for (int i = 0; i < n; ++i)
+            ptr[i * stride] = T(global_value(rank * n + i));
+        return res;
+    }
+
+    TEST(exact_sum, cancellation) {
+        exact_sum sum;
+        sum.add(1e16).add(1.).add(-1e16);
+        EXPECT_EQ(sum.value(), 1.);
+
+        sum = {};
+        sum.add(std::numeric_limits<double>::max()).add(std::numeric_limits<double>::max());
+        sum.add(-std::numeric_limits<double>::max());
+        EXPECT_EQ(sum.value(), std::numeric_limits<double>::max());
+
+        sum = {};
+        sum.add(std::numeric_limits<double>::denorm_min()).add(-0.5).add(0.5f);
+        EXPECT_EQ(sum.value(), std::numeric_limits<double>::denorm_min());
+
+        // the ties are rounded to even, the bits far below the rounding position break them
+        sum = {};
+        sum.add(1.).add(std::ldexp(1., -53));
+        EXPECT_EQ(sum.value(), 1.);
+        sum.add(std::ldexp(1., -200));
+        EXPECT_EQ(sum.value(), 1. + std::ldexp(1., -52));
+    }
+
+    TEST(exact_sum, special_values) {
+        double inf = std::numeric_limits<double>::infinity();
+        EXPECT_EQ(exact_sum().add(1.).add(inf).value(), inf);
+        EXPECT_EQ(exact_sum().add(-inf).add(1.).value(), -inf);
+        EXPECT_TRUE(std::isnan(exact_sum().add(inf).add(-inf).value()));
+        EXPECT_TRUE(std::isnan(exact_sum().add(std::nan("")).value()));
+    }
+
+    TEST(exact_sum, order_independent) {
+        std::vector<double> values(global_size);
+        for (int i = 0; i < global_size; ++i)
+            values[i] = global_value(i);
+        exact_sum expected;
+        for (double v : values)
+            expected.add(v);
+        std::shuffle(values.begin(), values.end(), std::mt19937(42));
+        exact_sum lhs, rhs;
+        for (int i = 0; i < global_size; ++i)
+            (i % 3 ? lhs : rhs).add(values[i]);
+        EXPECT_EQ(lhs.add(rhs).value(), expected.value());
+    }
+
+    TEST(distributed_reducible, reduce) {
+        auto testee = make_local(MPI_COMM_WORLD);
+        double expected_max = 0;
+        for (int i = 0; i < global_size; ++i)
+            expected_max = std::max(expected_max, std::abs(global_value(i)));
+        EXPECT_EQ(testee.reduce(absmax()), expected_max);
+        EXPECT_EQ(testee.reduce(reduction::max()), expected_max);
+
+        auto ints = make_local<int>(MPI_COMM_WORLD);
+        int expected_sum = 0, expected_int_max = int(global_value(0));
+        for (int i = 0; i < global_size; ++i) {
+            expected_sum += int(global_value(i));
+            expected_int_max = std::max(expected_int_max, int(global_value(i)));
+        }
+        auto request = ints.ireduce(plus());
+        EXPECT_EQ(request.wait(), expected_sum);
+
+        // a pending request is completed before being replaced
+        request = ints.ireduce(plus());
+        request = ints.ireduce(reduction::max());
+        EXPECT_EQ(request.wait(), expected_int_max);
+        request = ints.ireduce(plus());
+        EXPECT_EQ(request.wait(), expected_sum);
+    }
+
+    TEST(distributed_reducible, reproducible_sum) {
+        exact_sum exact;
+        for (int i = 0; i < global_size; ++i)
+            exact.add(global_value(i));
+        double expected = exact.value();
+
+        auto testee = make_local(MPI_COMM_WORLD);
+        EXPECT_EQ(testee.reproducible_sum(), expected);
+        auto request = testee.ireproducible_sum();
+        while (!request.test())
+            ;
+        EXPECT_EQ(request.wait(), expected);
+
+        // the same data on half of the processes
+        MPI_Comm half;
+        MPI_Comm_split(MPI_COMM_WORLD, gcl::pid() % 2, gcl::pid(), &half);
+        EXPECT_EQ(make_local(half).reproducible_sum(), expected);
+        MPI_Comm_free(&half);
+    }
+} // namespace
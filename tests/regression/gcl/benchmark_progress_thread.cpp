@@ -0,0 +1,92 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/gcl/low_level/progress_thread.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <mpi.h>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/gcl/GCL.hpp>
+
+#include "progress_thread_domain.hpp"
+
+using namespace gridtools;
+using namespace gcl;
+using namespace progress_thread_domain;
+
+namespace {
+    /*
+     * Measures how much of the exchange of large halos is hidden behind a computation of about the same duration,
+     * without and with the progress thread. The overlap is the fraction of the shorter of the two phases that is
+     * hidden: 0 if they run one after the other, 1 if they run fully concurrently. The times are reported, not
+     * checked, since they depend on the MPI implementation and on the machine.
+     */
+    TEST(progress_thread, overlap_benchmark) {
+        MPI_Comm comm = make_cart_comm();
+        domain d = {64, 64, 64, 3};
+        testee_t testee({true, false, true}, comm);
+        d.add_halos(testee);
+        testee.setup(2);
+
+        auto const &grid = testee.comm();
+        auto a = d.make_field(grid, true);
+        auto b = d.make_field(grid, true);
+        std::vector<double> work(d.size(), 1);
+        constexpr int steps = 10;
+
+        auto time = [&](auto &&f) {
+            f();
+            MPI_Barrier(comm);
+            double start = MPI_Wtime();
+            for (int step = 0; step < steps; ++step)
+                f();
+            double res = (MPI_Wtime() - start) / steps;
+            MPI_Allreduce(MPI_IN_PLACE, &res, 1, MPI_DOUBLE, MPI_MAX, comm);
+            return res;
+        };
+        auto exchange = [&] {
+            testee.pack(a.data(), b.data());
+            testee.exchange();
+            testee.unpack(a.data(), b.data());
+        };
+        double t_exchange = time(exchange);
+
+        // the number of sweeps that makes the computation take about as long as the exchange
+        double t_sweep = time([&] { compute(work, 1); });
+        int sweeps = std::max(1, int(t_exchange / t_sweep));
+        double t_compute = time([&] { compute(work, sweeps); });
+
+        auto overlapped = [&] {
+            testee.pack(a.data(), b.data());
+            testee.start_exchange();
+            compute(work, sweeps);
+            testee.wait();
+            testee.unpack(a.data(), b.data());
+        };
+        auto overlap = [&](double t) { return (t_exchange + t_compute - t) / std::min(t_exchange, t_compute); };
+        double t_plain = time(overlapped);
+        testee.use_progress_thread();
+        double t_progress = time(overlapped);
+        testee.use_progress_thread(false);
+
+        if (pid() == 0)
+            std::cout << "exchange " << t_exchange << " s, compute " << t_compute << " s, overlapped " << t_plain
+                      << " s (overlap " << overlap(t_plain) << "), with the progress thread " << t_progress
+                      << " s (overlap " << overlap(t_progress) << ")" << std::endl;
+
+        auto expected = d.make_field(grid, false);
+        EXPECT_EQ(a, expected);
+        MPI_Comm_free(&comm);
+    }
+} // namespace
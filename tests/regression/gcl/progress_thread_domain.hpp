@@ -0,0 +1,80 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <vector>
+
+#include <mpi.h>
+
+#include <gridtools/common/layout_map.hpp>
+#include <gridtools/gcl/halo_exchange.hpp>
+
+/*
+ *  The halo exchange of the tests and of the benchmark of the progress thread.
+ */
+namespace progress_thread_domain {
+    using namespace gridtools;
+    using namespace gcl;
+
+    using testee_t = halo_exchange_dynamic_ut<layout_map<0, 1, 2>, layout_map<0, 1, 2>, double, cpu>;
+
+    /*
+     * Every process owns a subdomain of the global domain, periodic in i and k. The values encode the global
+     * coordinates, the halos outside of the global domain keep -1.
+     */
+    struct domain {
+        int ni, nj, nk, h;
+
+        int ti() const { return ni + 2 * h; }
+        int tj() const { return nj + 2 * h; }
+        int tk() const { return nk + 2 * h; }
+        int size() const { return ti() * tj() * tk(); }
+
+        void add_halos(testee_t &testee) const {
+            testee.add_halo<0>(h, h, h, ni + h - 1, ti());
+            testee.add_halo<1>(h, h, h, nj + h - 1, tj());
+            testee.add_halo<2>(h, h, h, nk + h - 1, tk());
+        }
+
+        std::vector<double> make_field(MPI_3D_process_grid_t<3> const &grid, bool core_only) const {
+            int NI = grid.dimensions(0) * ni, NJ = grid.dimensions(1) * nj;
+            std::vector<double> res(size(), -1);
+            for (int i = 0; i < ti(); ++i)
+                for (int j = 0; j < tj(); ++j)
+                    for (int k = 0; k < tk(); ++k) {
+                        int gi = grid.coordinates(0) * ni + i - h;
+                        int gj = grid.coordinates(1) * nj + j - h;
+                        bool in_core = i >= h && i < ni + h && j >= h && j < nj + h && k >= h && k < nk + h;
+                        if ((core_only && !in_core) || gj < 0 || gj >= NJ)
+                            continue;
+                        res[(i * tj() + j) * tk() + k] = ((gi + NI) % NI * 1000. + gj) * 1000. + (k - h + nk) % nk;
+                    }
+            return res;
+        }
+    };
+
+    inline MPI_Comm make_cart_comm() {
+        int nprocs;
+        MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+        int dims[3] = {0, 0, 0}, period[3] = {1, 1, 1};
+        MPI_Dims_create(nprocs, 3, dims);
+        MPI_Comm res;
+        MPI_Cart_create(MPI_COMM_WORLD, 3, dims, period, false, &res);
+        return res;
+    }
+
+    // a computation that does not touch the fields being exchanged
+    inline double compute(std::vector<double> &a, int sweeps) {
+        for (int s = 0; s < sweeps; ++s)
+            for (std::size_t i = 1; i + 1 < a.size(); ++i)
+                a[i] = (a[i - 1] + a[i] + a[i + 1]) / 3;
+        return a[a.size() / 2];
+    }
+} // namespace progress_thread_domain
@@ -0,0 +1,133 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/gcl/global_io.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <mpi.h>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/array.hpp>
+#include <gridtools/gcl/GCL.hpp>
+#include <gridtools/gcl/decomposition.hpp>
+#include <gridtools/gcl/low_level/proc_grids_3D.hpp>
+
+using namespace gridtools;
+using namespace gcl;
+
+namespace {
+    constexpr int NI = 9, NJ = 7, NK = 5;
+
+    double global_value(int i, int j, int k) { return (i * 100. + j) * 100. + k; }
+
+    std::vector<double> make_global() {
+        std::vector<double> res(NI * NJ * NK);
+        for (int i = 0; i < NI; ++i)
+            for (int j = 0; j < NJ; ++j)
+                for (int k = 0; k < NK; ++k)
+                    res[(i * NJ + j) * NK + k] = global_value(i, j, k);
+        return res;
+    }
+
+    /*
+     * The fields of the calling process, laid out with the last dimension being the fastest as the global array,
+     * with unevenly sized blocks and halos.
+     */
+    struct local_domain {
+        MPI_3D_process_grid_t<3> grid;
+        decomposition decomp;
+
+        local_domain()
+            : grid({false, false, false}, MPI_COMM_WORLD, array<int, 3>{0, 0, 0}),
+              decomp({NI, NJ, NK}, grid, {2, 1, 1}) {}
+
+        int index(int i, int j, int k) const {
+            return (i * decomp.total_length(1) + j) * decomp.total_length(2) + k;
+        }
+
+        // the compute domain holds the global values, the halos `halo_value`
+        std::vector<double> make_field(bool filled, double halo_value = -1) const {
+            auto h = decomp.halos();
+            std::vector<double> res(decomp.total_length(0) * decomp.total_length(1) * decomp.total_length(2));
+            for (int i = 0; i < decomp.total_length(0); ++i)
+                for (int j = 0; j < decomp.total_length(1); ++j)
+                    for (int k = 0; k < decomp.total_length(2); ++k) {
+                        bool in_core = i >= (int)h[0].begin() && i <= (int)h[0].end() && j >= (int)h[1].begin() &&
+                                       j <= (int)h[1].end() && k >= (int)h[2].begin() && k <= (int)h[2].end();
+                        res[index(i, j, k)] = in_core && filled ? global_value(decomp.positional_offset(0) + i,
+                                                                      decomp.positional_offset(1) + j,
+                                                                      decomp.positional_offset(2) + k)
+                                                                : halo_value;
+                    }
+            return res;
+        }
+
+        array<int, 3> offsets() const {
+            return {decomp.global_offset(0), decomp.global_offset(1), decomp.global_offset(2)};
+        }
+    };
+
+    TEST(global_io, gather) {
+        local_domain d;
+        global_io<double> testee(MPI_COMM_WORLD, d.decomp.halos(), array<int, 3>{NI, NJ, NK}, d.offsets());
+        EXPECT_EQ(testee.global_size(), NI * NJ * NK);
+        auto field = d.make_field(true);
+        for (int root : {0, procs() - 1}) {
+            std::vector<double> result(pid() == root ? NI * NJ * NK : 0);
+            testee.gather(field.data(), result.data(), root);
+            if (pid() == root) {
+                EXPECT_EQ(result, make_global());
+            }
+        }
+    }
+
+    TEST(global_io, scatter) {
+        local_domain d;
+        global_io<double> testee(MPI_COMM_WORLD, d.decomp.halos(), array<int, 3>{NI, NJ, NK}, d.offsets());
+        int root = procs() / 2;
+        std::vector<double> global = pid() == root ? make_global() : std::vector<double>();
+        auto field = d.make_field(false);
+        testee.scatter(global.data(), field.data(), root);
+        EXPECT_EQ(field, d.make_field(true));
+    }
+
+    TEST(global_io, write_and_read) {
+        local_domain d;
+        global_io<double> testee(MPI_COMM_WORLD, d.decomp.halos(), array<int, 3>{NI, NJ, NK}, d.offsets());
+        char const *filename = "test_global_io.dat";
+        auto field = d.make_field(true);
+        auto halos_only = d.make_field(false, 0);
+        // two fields in the same file
+        testee.write(filename, halos_only.data());
+        testee.write(filename, field.data(), NI * NJ * NK * sizeof(double));
+
+        if (pid() == 0) {
+            std::vector<double> content(2 * NI * NJ * NK);
+            std::ifstream file(filename, std::ios::binary);
+            file.read(reinterpret_cast<char *>(content.data()), content.size() * sizeof(double));
+            EXPECT_TRUE(file);
+            EXPECT_EQ(std::vector<double>(content.begin(), content.begin() + NI * NJ * NK),
+                std::vector<double>(NI * NJ * NK, 0));
+            EXPECT_EQ(std::vector<double>(content.begin() + NI * NJ * NK, content.end()), make_global());
+        }
+
+        auto read = d.make_field(false);
+        testee.read(filename, read.data(), NI * NJ * NK * sizeof(double));
+        EXPECT_EQ(read, field);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (pid() == 0)
+            std::remove(filename);
+        EXPECT_THROW(testee.read("test_global_io_missing.dat", read.data()), std::runtime_error);
+    }
+} // namespace
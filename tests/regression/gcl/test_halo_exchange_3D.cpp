@@ -77,6 +77,7 @@ class halo_exchange_3D_test : public testing::TestWithParam<test_spec> {
         return {val(i, 0), val(j, 1), val(k, 2), field_no};
     }
 
+  protected:
     template <int... Is>
     auto make_storages(layout_map<Is...>) const {
         auto make_storage = [&](int field_no) {
@@ -192,6 +193,111 @@ TEST_P(halo_exchange_3D_all, test) {
     });
 }
 
+TEST_P(halo_exchange_3D_all, persistent_requests) {
+    using bools_t = meta::list<std::true_type, std::false_type>;
+    for_each<bools_t>([&](auto p0) {
+        for_each<bools_t>([&](auto p1) {
+            using layout_t = layout_map<0, 1, 2>;
+            using testee_t = gcl::halo_exchange_dynamic_ut<layout_t, layout_map<0, 1, 2>, value_type, gcl_arch_t>;
+            testee_t testee({p0, p1, true}, CartComm);
+            auto storages = make_storages(layout_t());
+            auto halo_descriptors = make_halo_descriptors(storages, 0);
+            for_each<meta::make_indices_c<num_fields>>(
+                [&](auto f) { testee.template add_halo<decltype(f)::value>(halo_descriptors[f.value]); });
+            testee.setup(3);
+            testee.use_persistent_requests();
+            auto field = [&](int f) { return storages[f]->get_target_ptr(); };
+            // the requests are reused by the second exchange and recreated for the different number of fields
+            exchange(std::false_type(), testee, field(0), field(1), field(2));
+            exchange(std::false_type(), testee, field(0), field(1), field(2));
+            exchange(std::false_type(), testee, field(0), field(2));
+            verify(storages, {p0, p1, true});
+        });
+    });
+}
+
+#ifndef GT_GCL_GPU
+TEST_P(halo_exchange_3D_all, shared_memory) {
+    using bools_t = meta::list<std::true_type, std::false_type>;
+    for_each<bools_t>([&](auto persistent) {
+        for_each<bools_t>([&](auto p0) {
+            for_each<bools_t>([&](auto p1) {
+                using layout_t = layout_map<0, 1, 2>;
+                using testee_t = gcl::halo_exchange_dynamic_ut<layout_t, layout_map<0, 1, 2>, value_type, gcl_arch_t>;
+                testee_t testee({p0, p1, true}, CartComm);
+                auto storages = make_storages(layout_t());
+                auto halo_descriptors = make_halo_descriptors(storages, 0);
+                for_each<meta::make_indices_c<num_fields>>(
+                    [&](auto f) { testee.template add_halo<decltype(f)::value>(halo_descriptors[f.value]); });
+                testee.setup(3);
+                testee.use_shared_memory();
+                testee.use_persistent_requests(persistent);
+                auto field = [&](int f) { return storages[f]->get_target_ptr(); };
+                // the slots of the shared window are reused by the consecutive exchanges
+                exchange(std::false_type(), testee, field(0), field(1), field(2));
+                exchange(std::false_type(), testee, field(0), field(1), field(2));
+                exchange(std::false_type(), testee, field(0), field(2));
+                verify(storages, {p0, p1, true});
+            });
+        });
+    });
+}
+#endif
+
+TEST_P(halo_exchange_3D_all, face_exchange) {
+    using layouts_t = meta::list<layout_map<0, 1, 2>, layout_map<2, 0, 1>>;
+    using bools_t = meta::list<std::true_type, std::false_type>;
+    for_each<layouts_t>([&](auto layout) {
+        for_each<bools_t>([&](auto use_vector_interface) {
+            for_each<bools_t>([&](auto p0) {
+                for_each<bools_t>([&](auto p1) {
+                    using testee_t =
+                        gcl::halo_exchange_dynamic_ut<decltype(layout), layout_map<0, 1, 2>, value_type, gcl_arch_t>;
+                    testee_t testee({p0, p1, true}, CartComm);
+                    auto storages = make_storages(layout);
+                    auto halo_descriptors = make_halo_descriptors(storages, 0);
+                    for_each<meta::make_indices_c<num_fields>>(
+                        [&](auto f) { testee.template add_halo<decltype(f)::value>(halo_descriptors[f.value]); });
+                    testee.setup(3);
+                    testee.use_face_exchange();
+                    auto field = [&](int f) { return storages[f]->get_target_ptr(); };
+                    exchange(use_vector_interface, testee, field(0), field(1), field(2));
+                    // the edges and the corners are the same as with the exchange with all neighbors
+                    verify(storages, {p0, p1, true});
+                });
+            });
+        });
+    });
+}
+
+TEST_P(halo_exchange_3D_all, datatypes) {
+    using layouts_t = meta::list<layout_map<0, 1, 2>, layout_map<2, 0, 1>>;
+    using bools_t = meta::list<std::true_type, std::false_type>;
+    for_each<layouts_t>([&](auto layout) {
+        for_each<bools_t>([&](auto use_vector_interface) {
+            for_each<bools_t>([&](auto p0) {
+                for_each<bools_t>([&](auto p1) {
+                    using testee_t =
+                        gcl::halo_exchange_dynamic_ut<decltype(layout), layout_map<0, 1, 2>, value_type, gcl_arch_t>;
+                    testee_t testee({p0, p1, true}, CartComm);
+                    auto storages = make_storages(layout);
+                    auto halo_descriptors = make_halo_descriptors(storages, 0);
+                    for_each<meta::make_indices_c<num_fields>>(
+                        [&](auto f) { testee.template add_halo<decltype(f)::value>(halo_descriptors[f.value]); });
+                    testee.setup(3);
+                    testee.use_datatypes();
+                    auto field = [&](int f) { return storages[f]->get_target_ptr(); };
+                    // the second exchange reuses the datatypes, the third one rebuilds them for other fields
+                    exchange(use_vector_interface, testee, field(0), field(1), field(2));
+                    exchange(use_vector_interface, testee, field(0), field(1), field(2));
+                    exchange(use_vector_interface, testee, field(2), field(0));
+                    verify(storages, {p0, p1, true});
+                });
+            });
+        });
+    });
+}
+
 INSTANTIATE_TEST_SUITE_P(tests,
     halo_exchange_3D_all,
     testing::Values(test_spec{.dims = {123, 56, 76},
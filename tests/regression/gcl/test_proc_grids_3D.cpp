@@ -0,0 +1,97 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/gcl/low_level/proc_grids_3D.hpp>
+
+#include <cstdlib>
+
+#include <mpi.h>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/array.hpp>
+#include <gridtools/gcl/GCL.hpp>
+
+using namespace gridtools;
+using namespace gcl;
+
+TEST(node_aware_dims, blocks) {
+    auto res = proc_grids_3D_impl_::node_aware_dims(16, 8, {0, 0, 0});
+    EXPECT_EQ(res.second, (array<int, 3>{2, 2, 2}));
+    EXPECT_EQ(res.first[0] * res.first[1] * res.first[2], 16);
+    EXPECT_EQ(res.first[0] + res.first[1] + res.first[2], 8);
+
+    // a single layer: the nodes are squares in it
+    res = proc_grids_3D_impl_::node_aware_dims(32, 4, {0, 0, 1});
+    EXPECT_EQ(res.second, (array<int, 3>{2, 2, 1}));
+    EXPECT_EQ(res.first[2], 1);
+
+    res = proc_grids_3D_impl_::node_aware_dims(8, 4, {8, 1, 1});
+    EXPECT_EQ(res.second, (array<int, 3>{4, 1, 1}));
+
+    // the blocks do not fit in the grid
+    res = proc_grids_3D_impl_::node_aware_dims(6, 4, {0, 0, 0});
+    EXPECT_EQ(res.first, (array<int, 3>{0, 0, 0}));
+}
+
+TEST(MPI_3D_process_grid_t, neighbor_counts) {
+    MPI_3D_process_grid_t<3> grid({true, false, true}, MPI_COMM_WORLD, node_aware_t());
+    EXPECT_EQ(grid.size(), procs());
+    EXPECT_EQ(grid.dimensions(0) * grid.dimensions(1) * grid.dimensions(2), procs());
+
+    int neighbors = 0;
+    for (int i = -1; i <= 1; ++i)
+        for (int j = -1; j <= 1; ++j)
+            for (int k = -1; k <= 1; ++k)
+                neighbors += (i || j || k) && grid.proc(i, j, k) != -1;
+    EXPECT_EQ(grid.intra_node_neighbors() + grid.inter_node_neighbors(), neighbors);
+
+    MPI_3D_process_grid_t<3> copy(grid);
+    EXPECT_EQ(copy.intra_node_neighbors(), grid.intra_node_neighbors());
+    EXPECT_EQ(copy.inter_node_neighbors(), grid.inter_node_neighbors());
+}
+
+TEST(MPI_3D_process_grid_t, lazy_neighbor_counts) {
+    MPI_3D_process_grid_t<3> grid({true, true, true}, MPI_COMM_WORLD, array<int, 3>{0, 0, 0});
+    // copied before the neighbors are counted
+    MPI_3D_process_grid_t<3> copy(grid);
+
+    int neighbors = 0;
+    for (int i = -1; i <= 1; ++i)
+        for (int j = -1; j <= 1; ++j)
+            for (int k = -1; k <= 1; ++k)
+                neighbors += (i || j || k) && grid.proc(i, j, k) != -1;
+    EXPECT_EQ(grid.inter_node_neighbors() + grid.intra_node_neighbors(), neighbors);
+    EXPECT_EQ(copy.intra_node_neighbors(), grid.intra_node_neighbors());
+}
+
+TEST(make_node_aware_cart_comm, emulated_nodes) {
+    // the pairs of consecutive ranks emulate the nodes
+    MPI_Comm node;
+    MPI_Comm_split(MPI_COMM_WORLD, pid() / 2, pid(), &node);
+    if (procs() % 2) {
+        MPI_Comm_free(&node);
+        return;
+    }
+
+    MPI_Comm cart = make_node_aware_cart_comm(MPI_COMM_WORLD, {0, 0, 1}, node);
+    MPI_3D_process_grid_t<3> grid({false, false, false}, cart);
+    MPI_Comm_free(&cart);
+
+    // the partner is a face neighbor of the caller
+    auto counts = grid.node_neighbors(node);
+    EXPECT_EQ(counts.first, 1);
+
+    int crds[3];
+    grid.coords(crds[0], crds[1], crds[2]);
+    int partner[3];
+    MPI_Sendrecv(crds, 3, MPI_INT, pid() ^ 1, 0, partner, 3, MPI_INT, pid() ^ 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    EXPECT_EQ(std::abs(crds[0] - partner[0]) + std::abs(crds[1] - partner[1]) + std::abs(crds[2] - partner[2]), 1);
+    MPI_Comm_free(&node);
+}
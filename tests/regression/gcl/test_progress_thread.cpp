@@ -0,0 +1,93 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/gcl/low_level/progress_thread.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <mpi.h>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/gcl/GCL.hpp>
+#include <gridtools/thread_pool/persistent.hpp>
+
+#include "progress_thread_domain.hpp"
+
+using namespace gridtools;
+using namespace gcl;
+using namespace progress_thread_domain;
+
+namespace {
+    class progress_thread_test : public testing::TestWithParam<bool> {};
+
+    TEST_P(progress_thread_test, matches_global_domain) {
+        MPI_Comm comm = make_cart_comm();
+        domain d = {6, 5, 4, 2};
+        testee_t testee({true, false, true}, comm);
+        d.add_halos(testee);
+        testee.setup(2);
+        testee.use_persistent_requests(GetParam());
+        testee.use_progress_thread();
+
+        auto const &grid = testee.comm();
+        auto a = d.make_field(grid, true);
+        auto b = d.make_field(grid, true);
+        std::vector<double> work(1000, 1);
+        for (int step = 0; step < 3; ++step) {
+            testee.pack(a.data(), b.data());
+            testee.start_exchange();
+            compute(work, 10);
+            testee.wait();
+            testee.unpack(a.data(), b.data());
+        }
+        auto expected = d.make_field(grid, false);
+        EXPECT_EQ(a, expected);
+        EXPECT_EQ(b, expected);
+
+        // switching the thread off keeps the exchange working
+        testee.use_progress_thread(false);
+        a = d.make_field(grid, true);
+        testee.pack(a.data(), b.data());
+        testee.exchange();
+        testee.unpack(a.data(), b.data());
+        EXPECT_EQ(a, expected);
+        MPI_Comm_free(&comm);
+    }
+
+    INSTANTIATE_TEST_SUITE_P(persistent, progress_thread_test, testing::Bool());
+
+    TEST(progress_thread, reserves_a_core) {
+        thread_pool::init_persistent(3, thread_pool::affinity::compact);
+        thread_pool::persistent pool;
+        // the highest thread number that takes part in a parallel loop
+        auto last_thread = [&] {
+            std::vector<int> threads(6);
+            thread_pool::parallel_for_loop(
+                pool, [&](int i) { threads[i] = thread_pool::get_thread_num(pool); }, int(threads.size()));
+            return *std::max_element(threads.begin(), threads.end());
+        };
+        EXPECT_EQ(last_thread(), 2);
+
+        progress_thread testee(pool);
+        int value = 0;
+        MPI_Request request;
+        MPI_Irecv(&value, 1, MPI_INT, pid(), 0, MPI_COMM_WORLD, &request);
+        testee.start({&request});
+        EXPECT_EQ(last_thread(), 1);
+        testee.stop();
+        EXPECT_EQ(last_thread(), 2);
+
+        int one = 1;
+        MPI_Send(&one, 1, MPI_INT, pid(), 0, MPI_COMM_WORLD);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        EXPECT_EQ(value, 1);
+    }
+} // namespace
@@ -11,6 +11,7 @@
 #include <gridtools/boundaries/distributed_boundaries.hpp>
 
 #include <functional>
+#include <stdexcept>
 
 #include <gtest/gtest.h>
 #include <mpi.h>
@@ -161,3 +162,85 @@ TEST_F(distributed_boundaries_test, exchange) {
     expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
     expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
 }
+
+TEST_F(distributed_boundaries_test, face_exchange) {
+    testee.use_face_exchange();
+    testee.exchange(
+        bind_bc(value_boundary<triplet>(triplet{42, 42, 42}), a), bind_bc(copy_boundary(), b, _1).associate(c), d);
+    expect_a([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{42, 42, 42} : a_init(i, j, k); });
+    expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
+    expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
+}
+
+TEST_F(distributed_boundaries_test, datatypes) {
+    testee.use_datatypes();
+    testee.exchange(
+        bind_bc(value_boundary<triplet>(triplet{42, 42, 42}), a), bind_bc(copy_boundary(), b, _1).associate(c), d);
+    expect_a([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{42, 42, 42} : a_init(i, j, k); });
+    expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
+    expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
+}
+
+#ifndef GT_GCL_GPU
+TEST_F(distributed_boundaries_test, shared_memory) {
+    testee.use_shared_memory();
+    testee.exchange(
+        bind_bc(value_boundary<triplet>(triplet{42, 42, 42}), a), bind_bc(copy_boundary(), b, _1).associate(c), d);
+    expect_a([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{42, 42, 42} : a_init(i, j, k); });
+    expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
+    expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
+}
+
+TEST_F(distributed_boundaries_test, aggregated_exchange) {
+    testee.use_aggregated_exchange();
+    testee.exchange(
+        bind_bc(value_boundary<triplet>(triplet{42, 42, 42}), a), bind_bc(copy_boundary(), b, _1).associate(c), d);
+    expect_a([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{42, 42, 42} : a_init(i, j, k); });
+    expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
+    expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
+}
+
+TEST_F(distributed_boundaries_test, aggregated_exchange_settings) {
+    // the settings made before the aggregated exchange apply to its pattern once created
+    testee.use_persistent_requests();
+    testee.use_progress_thread();
+    testee.use_aggregated_exchange();
+    for (int n = 0; n < 2; ++n)
+        testee.exchange(
+            bind_bc(value_boundary<triplet>(triplet{42, 42, 42}), a), bind_bc(copy_boundary(), b, _1).associate(c), d);
+    expect_a([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{42, 42, 42} : a_init(i, j, k); });
+    expect_b([&](int i, int j, int k) { return from_abroad(i, j) ? c_init(i, j, k) : b_init(i, j, k); });
+    expect_d([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : d_init(i, j, k); });
+}
+
+TEST_F(distributed_boundaries_test, mixed_stores) {
+    // a store of another value type and layout, with the same compute domain and the halos of the width 1
+    constexpr int h = 1, ci = d1 - 2 * halo_size, cj = d2 - 2 * halo_size;
+    auto global = [&](int i, int j, int k) { return (i - h + pi * ci) * 1000. + (j - h + pj * cj) * 10. + k; };
+    auto region_e = [](int index, int size) { return index < h ? -1 : index >= size - h ? 1 : 0; };
+    auto e = storage::builder<storage_traits_t>
+                 .type<double>()
+                 .layout<0, 2, 1>()
+                 .halos(h, h, 0)
+                 .dimensions(ci + 2 * h, cj + 2 * h, d3)
+                 .initializer([&](int i, int j, int k) {
+                     return region_e(i, ci + 2 * h) == 0 && region_e(j, cj + 2 * h) == 0 ? global(i, j, k) : -1.;
+                 })();
+
+    testee.exchange(a, e);
+
+    expect_a([&](int i, int j, int k) { return from_abroad(i, j) ? triplet{} : a_init(i, j, k); });
+    auto view = e->const_host_view();
+    for (int i = 0; i < ci + 2 * h; ++i)
+        for (int j = 0; j < cj + 2 * h; ++j)
+            for (int k = 0; k < d3; ++k) {
+                bool filled = testee.proc_grid().proc(region_e(i, ci + 2 * h), region_e(j, cj + 2 * h), 0) != -1;
+                EXPECT_EQ(view(i, j, k), filled ? global(i, j, k) : -1.)
+                    << gcl::pid() << ": " << i << ", " << j << ", " << k;
+            }
+}
+#else
+TEST_F(distributed_boundaries_test, aggregated_exchange) {
+    EXPECT_THROW(testee.use_aggregated_exchange(), std::runtime_error);
+}
+#endif
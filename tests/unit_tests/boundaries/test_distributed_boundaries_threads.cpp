@@ -0,0 +1,79 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/boundaries/distributed_boundaries.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/boundaries/comm_traits.hpp>
+#include <gridtools/boundaries/value.hpp>
+#include <gridtools/common/timer/timer_dummy.hpp>
+#include <gridtools/gcl/low_level/thread_comm.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+using namespace gridtools;
+using namespace boundaries;
+
+namespace {
+    constexpr int halo_size = 2;
+    constexpr int d1 = 8;
+    constexpr int d2 = 7;
+    constexpr int d3 = 3;
+
+    const auto builder =
+        storage::builder<storage::cpu_kfirst>.type<double>().halos(halo_size, halo_size, 0).dimensions(d1, d2, d3);
+
+    using storage_t = decltype(builder());
+    using testee_t =
+        distributed_boundaries<comm_traits<storage_t, gcl::cpu, timer_dummy, gcl::thread_3D_process_grid_t<3>>>;
+
+    halo_descriptor make_halo(int size) {
+        return {halo_size, halo_size, halo_size, (uint_t)(size - halo_size - 1), (uint_t)size};
+    }
+
+    // the subdomains are owned by the threads, periodic in i, with the value boundary in j
+    TEST(distributed_boundaries_threads, exchange) {
+        gcl::run_threads(4, [](gcl::thread_comm const &comm) {
+            testee_t testee(array<halo_descriptor, 3>{{make_halo(d1), make_halo(d2), {0, 0, 0, d3 - 1, d3}}},
+                {true, false, false},
+                1,
+                comm);
+            int pi, pj, pk, PI, PJ, PK;
+            testee.proc_grid().coords(pi, pj, pk);
+            testee.proc_grid().dims(PI, PJ, PK);
+            int ci = d1 - 2 * halo_size, cj = d2 - 2 * halo_size;
+            auto global = [&](int gi, int gj, int k) {
+                gi = (gi + PI * ci) % (PI * ci);
+                return 1000. * gi + 10 * gj + k;
+            };
+            auto is_core = [](int i, int j) {
+                return i >= halo_size && i < d1 - halo_size && j >= halo_size && j < d2 - halo_size;
+            };
+
+            auto field = builder
+                             .initializer([&](int i, int j, int k) {
+                                 return is_core(i, j) ? global(i - halo_size + pi * ci, j - halo_size + pj * cj, k)
+                                                      : -1.;
+                             })
+                             .build();
+            testee.exchange(bind_bc(value_boundary<double>(42), field));
+
+            auto view = field->const_host_view();
+            for (int i = 0; i < d1; ++i)
+                for (int j = 0; j < d2; ++j)
+                    for (int k = 0; k < d3; ++k) {
+                        int gj = j - halo_size + pj * cj;
+                        double expected = gj < 0 || gj >= PJ * cj ? 42. : global(i - halo_size + pi * ci, gj, k);
+                        EXPECT_EQ(view(i, j, k), expected) << comm.rank() << ": " << i << ", " << j << ", " << k;
+                    }
+        });
+    }
+} // namespace
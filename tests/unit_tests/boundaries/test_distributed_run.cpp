@@ -0,0 +1,236 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/boundaries/distributed_run.hpp>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <gridtools/boundaries/comm_traits.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/sid.hpp>
+
+#include <gcl_select.hpp>
+#include <storage_select.hpp>
+#include <timer_select.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace boundaries;
+    using namespace stencil;
+    using namespace cartesian;
+
+    constexpr int halo_size = 2;
+    constexpr int d1 = 11;
+    constexpr int d2 = 10;
+    constexpr int d3 = 3;
+
+    struct lap {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = 4 * eval(in()) - eval(in(1, 0)) - eval(in(-1, 0)) - eval(in(0, 1)) - eval(in(0, -1));
+        }
+    };
+
+    struct diffuse {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) =
+                .5 * eval(in()) + .125 * (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1)));
+        }
+    };
+
+    MPI_Comm make_comm() {
+        int dims[3] = {0, 0, 1};
+        MPI_Dims_create(gcl::procs(), 3, dims);
+        int period[3] = {1, 1, 1};
+        MPI_Comm res;
+        MPI_Cart_create(gcl::world(), 3, dims, period, false, &res);
+        return res;
+    }
+
+    const auto builder = storage::builder<storage_traits_t>.type<double>().halos(halo_size, halo_size, 0).dimensions(
+        d1, d2, d3);
+
+    using storage_t = decltype(builder());
+    using testee_t = distributed_boundaries<comm_traits<storage_t, gcl_arch_t, timer_impl_t>>;
+
+    halo_descriptor make_halo(int size) {
+        return {halo_size, halo_size, halo_size, (uint_t)(size - halo_size - 1), (uint_t)size};
+    }
+
+    TEST(split_domain, covers_compute_domain_once) {
+        auto di = make_halo(d1);
+        auto dj = make_halo(d2);
+        auto check = [&](auto extent, bool has_interior) {
+            auto domain = split_domain(di, dj, extent);
+            EXPECT_EQ(domain.has_interior, has_interior);
+            std::vector<int> count(d1 * d2);
+            auto mark = [&](halo_descriptor const &hi, halo_descriptor const &hj) {
+                for (int i = hi.begin(); i <= (int)hi.end(); ++i)
+                    for (int j = hj.begin(); j <= (int)hj.end(); ++j)
+                        ++count[i * d2 + j];
+            };
+            if (domain.has_interior)
+                mark(domain.interior_i, domain.interior_j);
+            for (auto const &strip : domain.strips)
+                mark(strip.first, strip.second);
+            for (int i = 0; i < d1; ++i)
+                for (int j = 0; j < d2; ++j)
+                    EXPECT_EQ(count[i * d2 + j], i >= halo_size && i < d1 - halo_size && j >= halo_size &&
+                                                     j < d2 - halo_size)
+                        << i << ", " << j;
+        };
+        check(extent<>(), true);
+        check(extent<-1, 1, -1, 1>(), true);
+        check(extent<-2, 0, 0, 1>(), true);
+        check(extent<-4, 4, -1, 1>(), false);
+    }
+
+    TEST(distributed_run, lap_of_lap) {
+        testee_t testee(array<halo_descriptor, 3>{{make_halo(d1), make_halo(d2), {0, 0, 0, d3 - 1, d3}}},
+            {true, true, false},
+            1,
+            make_comm());
+        int pi, pj, pk, PI, PJ, PK;
+        testee.proc_grid().coords(pi, pj, pk);
+        testee.proc_grid().dims(PI, PJ, PK);
+
+        int ci = d1 - 2 * halo_size, cj = d2 - 2 * halo_size;
+        auto global = [&](int gi, int gj, int k) -> double {
+            gi = (gi % (PI * ci) + PI * ci) % (PI * ci);
+            gj = (gj % (PJ * cj) + PJ * cj) % (PJ * cj);
+            return (7 * gi + 13 * gj + k) % 17;
+        };
+        auto global_lap = [&](int gi, int gj, int k) {
+            return 4 * global(gi, gj, k) - global(gi + 1, gj, k) - global(gi - 1, gj, k) - global(gi, gj + 1, k) -
+                   global(gi, gj - 1, k);
+        };
+        auto to_global_i = [&](int i) { return i - halo_size + pi * ci; };
+        auto to_global_j = [&](int j) { return j - halo_size + pj * cj; };
+        auto is_core = [](int i, int j) {
+            return i >= halo_size && i < d1 - halo_size && j >= halo_size && j < d2 - halo_size;
+        };
+
+        auto in = builder.initializer([&](int i, int j, int k) {
+            return is_core(i, j) ? global(to_global_i(i), to_global_j(j), k) : -1.;
+        })();
+        auto out = builder();
+
+        auto comp = [](auto in, auto out) {
+            GT_DECLARE_TMP(double, tmp);
+            return execute_parallel().stage(lap(), in, tmp).stage(lap(), tmp, out);
+        };
+        distributed_run(testee, std::make_tuple(in), comp, cpu_kfirst<>(), d3, in, out);
+
+        auto view = out->const_host_view();
+        for (int i = halo_size; i < d1 - halo_size; ++i)
+            for (int j = halo_size; j < d2 - halo_size; ++j)
+                for (int k = 0; k < d3; ++k) {
+                    int gi = to_global_i(i), gj = to_global_j(j);
+                    double expected = 4 * global_lap(gi, gj, k) - global_lap(gi + 1, gj, k) -
+                                      global_lap(gi - 1, gj, k) - global_lap(gi, gj + 1, k) -
+                                      global_lap(gi, gj - 1, k);
+                    EXPECT_DOUBLE_EQ(view(i, j, k), expected) << gcl::pid() << ": " << i << ", " << j << ", " << k;
+                }
+    }
+
+    TEST(deep_halo_run, same_as_step_by_step) {
+        // the halos of the width 2 allow for two steps of `diffuse` per exchange
+        testee_t testee(array<halo_descriptor, 3>{{make_halo(d1), make_halo(d2), {0, 0, 0, d3 - 1, d3}}},
+            {true, true, false},
+            1,
+            make_comm());
+        int pi, pj, pk;
+        testee.proc_grid().coords(pi, pj, pk);
+
+        auto init = builder.initializer([&](int i, int j, int k) { return (i * 7 + j * 5 + k + pi * 11 + pj) % 13; });
+        auto a = init();
+        auto b = builder();
+        auto ref_a = init();
+        auto ref_b = builder();
+
+        auto comp = [](auto in, auto out) { return execute_parallel().stage(diffuse(), in, out); };
+        for (int n = 0; n < 2; ++n) {
+            deep_halo_run(testee, std::make_tuple(a), 2, comp, cpu_kfirst<>(), d3, [&](int step) {
+                return step % 2 ? std::make_tuple(b, a) : std::make_tuple(a, b);
+            });
+            for (int step = 0; step < 2; ++step) {
+                testee.exchange(ref_a);
+                run(comp, cpu_kfirst<>(), make_grid(testee.halos()[0], testee.halos()[1], d3), ref_a, ref_b);
+                std::swap(ref_a, ref_b);
+            }
+        }
+
+        auto view = a->const_host_view();
+        auto ref_view = ref_a->const_host_view();
+        for (int i = halo_size; i < d1 - halo_size; ++i)
+            for (int j = halo_size; j < d2 - halo_size; ++j)
+                for (int k = 0; k < d3; ++k)
+                    EXPECT_DOUBLE_EQ(view(i, j, k), ref_view(i, j, k))
+                        << gcl::pid() << ": " << i << ", " << j << ", " << k;
+
+        EXPECT_THROW(deep_halo_run(testee,
+                         std::make_tuple(a),
+                         3,
+                         comp,
+                         cpu_kfirst<>(),
+                         d3,
+                         [&](int step) { return step % 2 ? std::make_tuple(b, a) : std::make_tuple(a, b); }),
+            std::runtime_error);
+    }
+
+    TEST(direct_pack, same_as_pack) {
+        testee_t testee(array<halo_descriptor, 3>{{make_halo(d1), make_halo(d2), {0, 0, 0, d3 - 1, d3}}},
+            {true, true, false},
+            1,
+            make_comm());
+        int pi, pj, pk;
+        testee.proc_grid().coords(pi, pj, pk);
+
+        auto out = builder();
+        auto ref_out = builder();
+        auto comp = [](auto in, auto out) { return execute_parallel().stage(diffuse(), in, out); };
+        auto grid = make_grid(testee.halos()[0], testee.halos()[1], d3);
+        for (int n = 0; n < 2; ++n) {
+            auto in =
+                builder.initializer([&](int i, int j, int k) { return (i * 7 + j * 5 + k + pi * 11 + pj + n) % 13; })();
+            run(comp, cpu_kfirst<>(), grid, in, std::get<0>(testee.direct_pack(out)));
+            testee.exchange(out);
+            run(comp, cpu_kfirst<>(), grid, in, ref_out);
+            testee.exchange(ref_out);
+
+            auto view = out->const_host_view();
+            auto ref_view = ref_out->const_host_view();
+            for (int i = 0; i < d1; ++i)
+                for (int j = 0; j < d2; ++j)
+                    for (int k = 0; k < d3; ++k)
+                        EXPECT_DOUBLE_EQ(view(i, j, k), ref_view(i, j, k))
+                            << gcl::pid() << ": " << i << ", " << j << ", " << k;
+        }
+
+        testee.direct_pack(out);
+        EXPECT_THROW(testee.exchange(ref_out), std::runtime_error);
+    }
+} // namespace
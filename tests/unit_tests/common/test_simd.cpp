@@ -0,0 +1,71 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/common/simd.hpp>
+
+#include <cmath>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace gridtools {
+    namespace simd {
+        namespace {
+            static_assert(std::is_same<decltype(vec<int, 4>() * 2.), vec<double, 4>>::value, "");
+            static_assert(std::is_same<decltype(-vec_ref<float, 2, 3>(nullptr)), vec<float, 2>>::value, "");
+            static_assert(std::is_same<decltype(math::max(vec<double, 4>(), 0)), vec<double, 4>>::value, "");
+
+            TEST(simd, arithmetic) {
+                vec<double, 4> a;
+                for (int l = 0; l < 4; ++l)
+                    a[l] = l;
+                auto b = 2 * a - 1 / (a + 1);
+                for (int l = 0; l < 4; ++l)
+                    EXPECT_DOUBLE_EQ(b[l], 2. * l - 1. / (l + 1));
+                b += a;
+                for (int l = 0; l < 4; ++l)
+                    EXPECT_DOUBLE_EQ(b[l], 3. * l - 1. / (l + 1));
+            }
+
+            TEST(simd, ref) {
+                double data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+                vec_ref<double, 4, 2> even(data);
+                vec_ref<double, 4, 2> odd(data + 1);
+                vec<double, 4> loaded = odd;
+                for (int l = 0; l < 4; ++l)
+                    EXPECT_EQ(loaded[l], 2 * l + 1);
+                even = odd;
+                even += 1.;
+                odd *= even;
+                for (int l = 0; l < 4; ++l) {
+                    EXPECT_EQ(data[2 * l], 2 * l + 2);
+                    EXPECT_EQ(data[2 * l + 1], (2 * l + 1) * (2 * l + 2));
+                }
+            }
+
+            TEST(simd, math) {
+                vec<double, 2> a;
+                a[0] = -4;
+                a[1] = 9;
+                auto b = math::sqrt(math::fabs(a));
+                EXPECT_DOUBLE_EQ(b[0], 2);
+                EXPECT_DOUBLE_EQ(b[1], 3);
+                auto c = math::min(a, 1.);
+                EXPECT_DOUBLE_EQ(c[0], -4);
+                EXPECT_DOUBLE_EQ(c[1], 1);
+                auto d = math::pow(b, b);
+                EXPECT_DOUBLE_EQ(d[0], 4);
+                EXPECT_DOUBLE_EQ(d[1], 27);
+                auto e = math::max(a, b);
+                EXPECT_DOUBLE_EQ(e[0], 2);
+                EXPECT_DOUBLE_EQ(e[1], 9);
+            }
+        } // namespace
+    }     // namespace simd
+} // namespace gridtools
@@ -0,0 +1,91 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/gcl/decomposition.hpp>
+
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/array.hpp>
+#include <gridtools/gcl/low_level/thread_comm.hpp>
+
+namespace gridtools {
+    namespace gcl {
+        namespace {
+            using grid_t = thread_3D_process_grid_t<3>;
+
+            TEST(decomposition, split) {
+                EXPECT_EQ(decomposition_impl_::split(10, 3, {}, 1), (std::vector<int>{0, 4, 7, 10}));
+                EXPECT_EQ(decomposition_impl_::split(9, 3, {}, 3), (std::vector<int>{0, 3, 6, 9}));
+                EXPECT_THROW(decomposition_impl_::split(8, 3, {}, 3), std::runtime_error);
+                EXPECT_THROW(decomposition_impl_::split(4, 2, {1, 1}, 1), std::runtime_error);
+
+                // the heavy points at the start get smaller parts
+                EXPECT_EQ(decomposition_impl_::split(8, 2, {3, 3, 1, 1, 1, 1, 1, 1}, 1), (std::vector<int>{0, 2, 8}));
+                // the parts are never narrower than the halos
+                EXPECT_EQ(decomposition_impl_::split(6, 2, {100, 1, 1, 1, 1, 1}, 2), (std::vector<int>{0, 2, 6}));
+            }
+
+            TEST(decomposition, covers_the_global_domain) {
+                array<int, 3> global_sizes = {23, 17, 10};
+                std::vector<std::vector<int>> owners(23 * 17 * 10);
+                std::mutex mutex;
+                run_threads(6, [&](thread_comm const &comm) {
+                    grid_t grid({true, true, false}, comm, {3, 2, 1});
+                    decomposition testee(global_sizes, grid, {2, 2, 0});
+                    EXPECT_DOUBLE_EQ(testee.imbalance(), 8. / (23. / 3) * 9. / (17. / 2));
+                    for (int d = 0; d < 3; ++d) {
+                        auto halo = testee.halo(d);
+                        EXPECT_EQ(halo.begin(), testee.halos()[d].begin());
+                        EXPECT_EQ(halo.end() - halo.begin() + 1, testee.local_size(d));
+                        EXPECT_EQ(halo.total_length(), testee.total_lengths()[d]);
+                        EXPECT_EQ(testee.positional_offset(d) + (int)halo.begin(), testee.global_offset(d));
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (int i = 0; i < testee.local_size(0); ++i)
+                        for (int j = 0; j < testee.local_size(1); ++j)
+                            for (int k = 0; k < testee.local_size(2); ++k) {
+                                int gi = testee.global_offset(0) + i, gj = testee.global_offset(1) + j,
+                                    gk = testee.global_offset(2) + k;
+                                owners[(gi * 17 + gj) * 10 + gk].push_back(comm.rank());
+                            }
+                });
+                for (auto const &o : owners)
+                    EXPECT_EQ(o.size(), 1);
+            }
+
+            TEST(decomposition, column_weights) {
+                array<int, 3> global_sizes = {40, 12, 5};
+                // the columns of the first quarter in i are three times as costly
+                auto weights = column_weights(global_sizes, [](int i, int) { return i < 10 ? 3. : 1.; });
+                EXPECT_EQ(weights[0][0], 3. * 12);
+                EXPECT_EQ(weights[1][0], 3. * 10 + 30);
+                EXPECT_TRUE(weights[2].empty());
+
+                std::vector<double> costs(4);
+                std::mutex mutex;
+                run_threads(4, [&](thread_comm const &comm) {
+                    grid_t grid({false, false, false}, comm, {4, 1, 1});
+                    decomposition testee(global_sizes, grid, {1, 1, 0}, weights);
+                    double cost = 0;
+                    for (int i = 0; i < testee.local_size(0); ++i)
+                        cost += weights[0][testee.global_offset(0) + i];
+                    std::lock_guard<std::mutex> lock(mutex);
+                    costs[grid.coordinates(0)] = cost;
+                });
+                // the total cost of 60 columns of 12 points is split evenly
+                for (double cost : costs)
+                    EXPECT_EQ(cost, 60. * 12 / 4);
+            }
+        } // namespace
+    }     // namespace gcl
+} // namespace gridtools
@@ -0,0 +1,116 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/gcl/high_level/halo_precision.hpp>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/layout_map.hpp>
+#include <gridtools/gcl/halo_exchange.hpp>
+#include <gridtools/gcl/low_level/thread_comm.hpp>
+
+namespace gridtools {
+    namespace gcl {
+        namespace {
+            template <typename T>
+            T round_trip(halo_precision p, T value) {
+                char buffer[sizeof(T)];
+                encode_halo(p, &value, 1, buffer);
+                T res;
+                decode_halo(p, buffer, 1, &res);
+                return res;
+            }
+
+            TEST(halo_precision, element_size) {
+                EXPECT_EQ(halo_element_size<double>(halo_precision::full), 8);
+                EXPECT_EQ(halo_element_size<double>(halo_precision::single), 4);
+                EXPECT_EQ(halo_element_size<double>(halo_precision::bfloat16), 2);
+                EXPECT_EQ(halo_element_size<double>(halo_precision::truncated), 4);
+                EXPECT_EQ(halo_element_size<float>(halo_precision::truncated), 2);
+                EXPECT_THROW(check_halo_precision<int>(halo_precision::single), std::runtime_error);
+                EXPECT_NO_THROW(check_halo_precision<int>(halo_precision::full));
+            }
+
+            TEST(halo_precision, round_trip) {
+                double third = 1. / 3;
+                EXPECT_EQ(round_trip(halo_precision::full, third), third);
+                EXPECT_EQ(round_trip(halo_precision::single, third), double(float(third)));
+                // 0x3eaaaaab rounded up to 0x3eab
+                EXPECT_EQ(round_trip(halo_precision::bfloat16, third), 0.333984375);
+                EXPECT_EQ(round_trip(halo_precision::bfloat16, 1.f / 3), 0.333984375f);
+                EXPECT_NEAR(round_trip(halo_precision::truncated, third), third, third * std::ldexp(1., -21));
+                EXPECT_EQ(round_trip(halo_precision::truncated, -2.5), -2.5);
+                // the truncated representation keeps the range of double
+                EXPECT_NEAR(round_trip(halo_precision::truncated, 1e300), 1e300, 1e300 * std::ldexp(1., -21));
+                EXPECT_TRUE(std::isinf(round_trip(halo_precision::single, 1e300)));
+                for (auto p : {halo_precision::single, halo_precision::bfloat16, halo_precision::truncated})
+                    EXPECT_TRUE(std::isnan(round_trip(p, std::numeric_limits<double>::quiet_NaN())));
+            }
+
+            TEST(halo_precision, exchange) {
+                constexpr int n = 4, h = 1, t = n + 2 * h;
+                std::vector<halo_precision> precisions = {
+                    halo_precision::full, halo_precision::single, halo_precision::bfloat16, halo_precision::truncated};
+                run_threads(4, [&](thread_comm const &comm) {
+                    using testee_t = halo_exchange_dynamic_ut<layout_map<0, 1, 2>,
+                        layout_map<0, 1, 2>,
+                        double,
+                        cpu,
+                        0,
+                        thread_3D_process_grid_t<3>>;
+                    testee_t testee({true, true, true}, comm);
+                    testee.add_halo<0>(h, h, h, n + h - 1, t);
+                    testee.add_halo<1>(h, h, h, n + h - 1, t);
+                    testee.add_halo<2>(h, h, h, n + h - 1, t);
+                    testee.setup(4);
+                    testee.use_halo_precision(precisions);
+
+                    auto const &grid = testee.comm();
+                    int N[3] = {grid.dimensions(0) * n, grid.dimensions(1) * n, grid.dimensions(2) * n};
+                    // the value of the point of the local index (i, j, k) in the field f
+                    auto value = [&](int f, int i, int j, int k) {
+                        int g[3] = {grid.coordinates(0) * n + i - h,
+                            grid.coordinates(1) * n + j - h,
+                            grid.coordinates(2) * n + k - h};
+                        for (int d = 0; d < 3; ++d)
+                            g[d] = (g[d] + N[d]) % N[d];
+                        return (f + 1) / 3. + (g[0] * 100 + g[1] * 10 + g[2]) / 7.;
+                    };
+                    auto core = [&](int i) { return i >= h && i < n + h; };
+                    std::vector<std::vector<double>> fields(precisions.size(), std::vector<double>(t * t * t, -1));
+                    for (int f = 0; f < (int)fields.size(); ++f)
+                        for (int i = h; i < n + h; ++i)
+                            for (int j = h; j < n + h; ++j)
+                                for (int k = h; k < n + h; ++k)
+                                    fields[f][(i * t + j) * t + k] = value(f, i, j, k);
+
+                    testee.pack(fields[0].data(), fields[1].data(), fields[2].data(), fields[3].data());
+                    testee.exchange();
+                    testee.unpack(fields[0].data(), fields[1].data(), fields[2].data(), fields[3].data());
+
+                    for (int f = 0; f < (int)fields.size(); ++f)
+                        for (int i = 0; i < t; ++i)
+                            for (int j = 0; j < t; ++j)
+                                for (int k = 0; k < t; ++k) {
+                                    double expected = value(f, i, j, k);
+                                    if (!core(i) || !core(j) || !core(k))
+                                        expected = round_trip(precisions[f], expected);
+                                    EXPECT_EQ(fields[f][(i * t + j) * t + k], expected)
+                                        << f << ": " << i << ", " << j << ", " << k;
+                                }
+                });
+            }
+        } // namespace
+    }     // namespace gcl
+} // namespace gridtools
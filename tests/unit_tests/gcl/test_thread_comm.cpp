@@ -0,0 +1,190 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/gcl/low_level/thread_comm.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/array.hpp>
+#include <gridtools/common/layout_map.hpp>
+#include <gridtools/gcl/halo_exchange.hpp>
+
+namespace gridtools {
+    namespace gcl {
+        namespace {
+            TEST(dims_create, balanced) {
+                array<int, 3> dims = {};
+                dims_create(12, dims);
+                EXPECT_EQ(dims, (array<int, 3>{3, 2, 2}));
+
+                dims = {0, 0, 1};
+                dims_create(6, dims);
+                EXPECT_EQ(dims, (array<int, 3>{3, 2, 1}));
+
+                dims = {0, 5, 0};
+                dims_create(5, dims);
+                EXPECT_EQ(dims, (array<int, 3>{1, 5, 1}));
+
+                dims = {0, 4, 0};
+                EXPECT_THROW(dims_create(6, dims), std::runtime_error);
+            }
+
+            TEST(thread_comm, ring) {
+                constexpr int n = 5;
+                run_threads(n, [](thread_comm const &comm) {
+                    int next = (comm.rank() + 1) % n, prev = (comm.rank() + n - 1) % n;
+                    // the two messages with the same tag are received in order
+                    int sent[2] = {comm.rank(), 10 * comm.rank()};
+                    int received[2] = {-1, -1};
+                    thread_request requests[4];
+                    comm_isend(comm, &sent[0], sizeof(int), next, 0, requests[0]);
+                    comm_isend(comm, &sent[1], sizeof(int), next, 0, requests[1]);
+                    comm_irecv(comm, &received[0], sizeof(int), prev, 0, requests[2]);
+                    comm_irecv(comm, &received[1], sizeof(int), prev, 0, requests[3]);
+                    comm_waitall(comm, 4, requests);
+                    EXPECT_EQ(received[0], prev);
+                    EXPECT_EQ(received[1], 10 * prev);
+                    comm.barrier();
+                });
+            }
+
+            TEST(thread_comm, exception) {
+                EXPECT_THROW(run_threads(3,
+                                 [](thread_comm const &comm) {
+                                     if (comm.rank() == 1)
+                                         throw std::runtime_error("");
+                                 }),
+                    std::runtime_error);
+            }
+
+            TEST(thread_3D_process_grid, neighbors) {
+                run_threads(6, [](thread_comm const &comm) {
+                    thread_3D_process_grid_t<3> grid({true, false, false}, comm, {0, 0, 1});
+                    int R, C, S, r, c, s;
+                    grid.dims(R, C, S);
+                    grid.coords(r, c, s);
+                    EXPECT_EQ(R, 3);
+                    EXPECT_EQ(C, 2);
+                    EXPECT_EQ(S, 1);
+                    EXPECT_EQ(grid.pid(), r * C + c);
+                    EXPECT_EQ(grid.proc(0, 0, 0), grid.pid());
+                    EXPECT_EQ(grid.proc(1, 0, 0), (r + 1) % R * C + c);
+                    EXPECT_EQ(grid.proc(0, 1, 0), c + 1 < C ? grid.pid() + 1 : -1);
+                    EXPECT_EQ(grid.proc(0, 0, 1), -1);
+                });
+            }
+
+            /*
+             * Every thread owns a subdomain of the global domain, periodic in i and k. The values encode the global
+             * coordinates, the halos outside of the global domain keep -1.
+             */
+            class halo_exchange_threads : public testing::TestWithParam<bool> {
+              protected:
+                static constexpr int ni = 6, nj = 5, nk = 4, h = 2;
+                static constexpr int ti = ni + 2 * h, tj = nj + 2 * h, tk = nk + 2 * h;
+
+                static int value(int gi, int gj, int gk) { return (gi * 100 + gj) * 100 + gk; }
+
+                // the field with the expected values, either in the compute domain only or in the halos as well
+                template <class Grid>
+                static std::vector<int> make_field(Grid const &grid, bool core_only) {
+                    int NI = grid.dimensions(0) * ni, NJ = grid.dimensions(1) * nj;
+                    std::vector<int> res(ti * tj * tk, -1);
+                    for (int i = 0; i < ti; ++i)
+                        for (int j = 0; j < tj; ++j)
+                            for (int k = 0; k < tk; ++k) {
+                                int gi = grid.coordinates(0) * ni + i - h;
+                                int gj = grid.coordinates(1) * nj + j - h;
+                                bool in_core = i >= h && i < ni + h && j >= h && j < nj + h && k >= h && k < nk + h;
+                                if ((core_only && !in_core) || gj < 0 || gj >= NJ)
+                                    continue;
+                                res[(i * tj + j) * tk + k] = value((gi + NI) % NI, gj, (k - h + nk) % nk);
+                            }
+                    return res;
+                }
+            };
+
+            TEST_P(halo_exchange_threads, matches_global_domain) {
+                run_threads(6, [&](thread_comm const &comm) {
+                    using testee_t = halo_exchange_dynamic_ut<layout_map<0, 1, 2>,
+                        layout_map<0, 1, 2>,
+                        int,
+                        cpu,
+                        0,
+                        thread_3D_process_grid_t<3>>;
+                    testee_t testee({true, false, true}, comm);
+                    testee.add_halo<0>(h, h, h, ni + h - 1, ti);
+                    testee.add_halo<1>(h, h, h, nj + h - 1, tj);
+                    testee.add_halo<2>(h, h, h, nk + h - 1, tk);
+                    testee.setup(2);
+                    testee.use_face_exchange(GetParam());
+                    EXPECT_THROW(testee.use_datatypes(), std::runtime_error);
+
+                    auto const &grid = testee.comm();
+                    auto a = make_field(grid, true);
+                    auto b = make_field(grid, true);
+                    // the second exchange sends the same data again
+                    for (int step = 0; step < 2; ++step) {
+                        testee.pack(a.data(), b.data());
+                        testee.exchange();
+                        testee.unpack(a.data(), b.data());
+                    }
+                    auto expected = make_field(grid, false);
+                    EXPECT_EQ(a, expected);
+                    EXPECT_EQ(b, expected);
+                });
+            }
+
+            TEST_P(halo_exchange_threads, direct_pack) {
+                run_threads(6, [&](thread_comm const &comm) {
+                    using testee_t = halo_exchange_dynamic_ut<layout_map<0, 1, 2>,
+                        layout_map<0, 1, 2>,
+                        int,
+                        cpu,
+                        0,
+                        thread_3D_process_grid_t<3>>;
+                    testee_t testee({true, false, true}, comm);
+                    testee.add_halo<0>(h, h, h, ni + h - 1, ti);
+                    testee.add_halo<1>(h, h, h, nj + h - 1, tj);
+                    testee.add_halo<2>(h, h, h, nk + h - 1, tk);
+                    testee.setup(2);
+                    testee.use_face_exchange(GetParam());
+                    if (GetParam()) {
+                        EXPECT_THROW(testee.begin_direct_pack(2), std::runtime_error);
+                        return;
+                    }
+
+                    // the fields are computed point by point, without pack()
+                    auto const &grid = testee.comm();
+                    auto computed = make_field(grid, true);
+                    std::vector<int> a(computed.size(), -1), b(computed.size(), -1);
+                    testee.begin_direct_pack(2);
+                    for (int i = h; i < ni + h; ++i)
+                        for (int j = h; j < nj + h; ++j)
+                            for (int k = h; k < nk + h; ++k) {
+                                int idx = (i * tj + j) * tk + k;
+                                a[idx] = b[idx] = computed[idx];
+                                testee.write_halo(0, i, j, k, computed[idx]);
+                                testee.write_halo(1, i, j, k, computed[idx]);
+                            }
+                    testee.exchange();
+                    testee.unpack(a.data(), b.data());
+                    auto expected = make_field(grid, false);
+                    EXPECT_EQ(a, expected);
+                    EXPECT_EQ(b, expected);
+                });
+            }
+
+            INSTANTIATE_TEST_SUITE_P(face_exchange, halo_exchange_threads, testing::Bool());
+        } // namespace
+    }     // namespace gcl
+} // namespace gridtools
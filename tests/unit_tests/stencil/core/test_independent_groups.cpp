@@ -0,0 +1,67 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/be_api.hpp>
+
+#include <type_traits>
+
+#include <gridtools/meta.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace be_api {
+            namespace {
+                template <int>
+                struct plh;
+
+                template <int I, bool IsConst>
+                struct info {
+                    using plh_t = plh<I>;
+                    using is_const_t = bool_constant<IsConst>;
+                };
+
+                template <class... Infos>
+                struct item {
+                    using plh_map_t = meta::list<Infos...>;
+                    using plhs_t = meta::list<typename Infos::plh_t...>;
+                };
+
+                template <size_t... Is>
+                using group = meta::list<std::integral_constant<size_t, Is>...>;
+
+                static_assert(std::is_same<make_independent_groups<meta::list<>>, meta::list<>>::value, "");
+
+                using chains_t = meta::list<item<info<0, false>>,
+                    item<info<0, true>, info<1, false>>,
+                    item<info<2, false>>,
+                    item<info<2, true>, info<3, true>, info<4, false>>,
+                    item<info<3, true>, info<5, false>>>;
+
+                // the items that only share the read-only placeholder `3` are independent
+                static_assert(std::is_same<make_independent_groups<chains_t>,
+                                  meta::list<group<0, 1>, group<2, 3>, group<4>>>::value,
+                    "");
+
+                // the item that connects two chains merges them, the original order is preserved
+                using joined_t = meta::push_back<chains_t, item<info<1, true>, info<4, true>, info<6, false>>>;
+
+                static_assert(std::is_same<make_independent_groups<joined_t>,
+                                  meta::list<group<4>, group<0, 1, 2, 3, 5>>>::value,
+                    "");
+
+                // write after read is a dependency as well
+                using war_t = meta::list<item<info<0, true>>, item<info<0, false>>, item<info<1, false>>>;
+
+                static_assert(
+                    std::is_same<make_independent_groups<war_t>, meta::list<group<0, 1>, group<2>>>::value, "");
+            } // namespace
+        }     // namespace be_api
+    }         // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,141 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_ifirst.hpp>
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/gt_math.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/positional.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/sid.hpp>
+#include <gridtools/thread_pool/omp.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            struct lap {
+                using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                static void apply(Eval &&eval) {
+                    eval(out()) = 4 * eval(in()) - eval(in(1, 0)) - eval(in(-1, 0)) - eval(in(0, 1)) - eval(in(0, -1));
+                }
+            };
+
+            struct norm {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                static void apply(Eval &&eval) {
+                    eval(out()) = math::sqrt(math::max(eval(in()) * eval(in()), 1.));
+                }
+            };
+
+            struct add_positions {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using i_pos = in_accessor<2>;
+                using param_list = make_param_list<in, out, i_pos>;
+
+                template <class Eval>
+                static void apply(Eval &&eval) {
+                    eval(out()) = call<norm>::with(eval, in()) + eval(i_pos());
+                }
+            };
+
+            struct accumulate {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+                    eval(out()) = eval(in());
+                }
+
+                template <class Eval>
+                static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+                    eval(out()) = eval(out(0, 0, -1));
+                    eval(out()) += eval(in());
+                }
+            };
+
+            const auto builder =
+                storage::builder<storage::cpu_ifirst>.type<double>().halos(1, 1, 0).dimensions(13, 11, 4);
+
+            double in_f(int i, int j, int k) { return i * i - 3 * j + k * i * j; }
+
+            double lap_f(int i, int j, int k) {
+                return 4 * in_f(i, j, k) - in_f(i + 1, j, k) - in_f(i - 1, j, k) - in_f(i, j + 1, k) -
+                       in_f(i, j - 1, k);
+            }
+
+            auto grid = make_grid(halo_descriptor(1, 1, 1, 11, 13), halo_descriptor(1, 1, 1, 9, 11), 4);
+
+            template <int_t SimdWidth>
+            using backend_t = cpu_ifirst<thread_pool::omp, SimdWidth>;
+
+            template <class T>
+            struct cpu_ifirst_simd : testing::Test {};
+
+            using widths_t = testing::Types<integral_constant<int_t, 1>,
+                integral_constant<int_t, 2>,
+                integral_constant<int_t, 4>,
+                integral_constant<int_t, 8>>;
+            TYPED_TEST_SUITE(cpu_ifirst_simd, widths_t);
+
+            TYPED_TEST(cpu_ifirst_simd, parallel) {
+                auto in = builder.initializer(in_f).build();
+                auto out = builder.value(-1).build();
+                run(
+                    [](auto in, auto out, auto i_pos) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel().stage(lap(), in, tmp).stage(add_positions(), tmp, out, i_pos);
+                    },
+                    backend_t<TypeParam::value>(),
+                    grid,
+                    in,
+                    out,
+                    positional<dim::i>());
+                auto v = out->const_host_view();
+                for (int i = 1; i < 12; ++i)
+                    for (int j = 1; j < 10; ++j)
+                        for (int k = 0; k < 4; ++k)
+                            EXPECT_DOUBLE_EQ(v(i, j, k), std::sqrt(std::max(lap_f(i, j, k) * lap_f(i, j, k), 1.)) + i);
+            }
+
+            TYPED_TEST(cpu_ifirst_simd, forward) {
+                auto in = builder.initializer(in_f).build();
+                auto out = builder.value(-1).build();
+                run_single_stage(accumulate(), backend_t<TypeParam::value>(), grid, in, out);
+                auto v = out->const_host_view();
+                for (int i = 1; i < 12; ++i)
+                    for (int j = 1; j < 10; ++j) {
+                        double expected = 0;
+                        for (int k = 0; k < 4; ++k) {
+                            expected += in_f(i, j, k);
+                            EXPECT_DOUBLE_EQ(v(i, j, k), expected);
+                        }
+                    }
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -164,3 +164,60 @@ TEST(tmp_storage_sid, zero_k_extents) {
         }
     }
 }
+
+TEST(tmp_storage_sid, ij_cache) {
+    using extent_t = extent<-1, 2, -2, 3>;
+    pos3<std::size_t> block_size{12, 5, 8};
+
+    tmp_allocator allocator;
+    auto tmp = make_ij_cache_storage<double, extent_t, thread_pool::omp>(allocator, block_size);
+
+    using tmp_t = decltype(tmp);
+
+    static_assert(is_sid<tmp_t>(), "");
+    static_assert(std::is_same<sid::ptr_type<tmp_t>, double *>(), "");
+    // the tile is shared by all k-levels
+    static_assert(std::is_same<std::decay_t<decltype(sid::get_stride<dim::k>(sid::get_strides(tmp)))>,
+                      integral_constant<int_t, 0>>(),
+        "");
+
+    auto f = [](int_t i, int_t j, int_t t) { return i + j * 100 + t * 200; };
+
+    // check write and read
+#pragma omp parallel
+    {
+        const int_t thread = omp_get_thread_num();
+        auto strides = sid::get_strides(tmp);
+
+        double *ptr = sid::get_origin(tmp)();
+        sid::shift(ptr, sid::get_stride<dim::thread>(strides), thread);
+        sid::shift(ptr, sid::get_stride<dim::i>(strides), extent_t::iminus::value);
+        sid::shift(ptr, sid::get_stride<dim::j>(strides), extent_t::jminus::value);
+
+        const int_t size_i = extent_t::extend(dim::i(), block_size.i);
+        const int_t size_j = extent_t::extend(dim::j(), block_size.j);
+        for (int_t j = 0; j < size_j; ++j) {
+            for (int_t i = 0; i < size_i; ++i) {
+                if (i == -extent_t::iminus::value) {
+                    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % byte_alignment, 0);
+                }
+                *ptr = f(i, j, thread);
+                sid::shift(ptr, sid::get_stride<dim::i>(strides), 1_c);
+            }
+            sid::shift(ptr, sid::get_stride<dim::i>(strides), -size_i);
+            sid::shift(ptr, sid::get_stride<dim::j>(strides), 1_c);
+        }
+        sid::shift(ptr, sid::get_stride<dim::j>(strides), -size_j);
+
+#pragma omp barrier
+
+        for (int_t j = 0; j < size_j; ++j) {
+            for (int_t i = 0; i < size_i; ++i) {
+                EXPECT_EQ(*ptr, f(i, j, thread));
+                sid::shift(ptr, sid::get_stride<dim::i>(strides), 1_c);
+            }
+            sid::shift(ptr, sid::get_stride<dim::i>(strides), -size_i);
+            sid::shift(ptr, sid::get_stride<dim::j>(strides), 1_c);
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_kfirst.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/storage/sid.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+            using namespace cpu_kfirst_backend;
+
+            struct lap {
+                using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                static void apply(Eval &&eval) {
+                    eval(out()) = 4 * eval(in()) - eval(in(1, 0)) - eval(in(-1, 0)) - eval(in(0, 1)) - eval(in(0, -1));
+                }
+            };
+
+            struct copy {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                static void apply(Eval &&eval) {
+                    eval(out()) = eval(in());
+                }
+            };
+
+            auto spec = [](auto in, auto out) {
+                GT_DECLARE_TMP(double, tmp);
+                return execute_parallel().stage(lap(), in, tmp).stage(copy(), tmp, out);
+            };
+
+            const auto builder =
+                storage::builder<storage::cpu_kfirst>.type<double>().halos(1, 1, 0).dimensions(13, 11, 4);
+
+            double in_f(int i, int j, int k) { return i * i + 3 * j + k * i * j; }
+
+            template <class Backend>
+            void check_lap(Backend be) {
+                auto in = builder.initializer(in_f).build();
+                auto out = builder.value(-1).build();
+                run(spec,
+                    std::move(be),
+                    make_grid(halo_descriptor(1, 1, 1, 11, 13), halo_descriptor(1, 1, 1, 9, 11), 4),
+                    in,
+                    out);
+                auto v = out->const_host_view();
+                for (int i = 1; i < 12; ++i)
+                    for (int j = 1; j < 10; ++j)
+                        for (int k = 0; k < 4; ++k)
+                            EXPECT_EQ(v(i, j, k),
+                                4 * in_f(i, j, k) - in_f(i + 1, j, k) - in_f(i - 1, j, k) - in_f(i, j + 1, k) -
+                                    in_f(i, j - 1, k));
+            }
+
+            TEST(cpu_kfirst, runtime_block_sizes) {
+                check_lap(cpu_kfirst<int_t, int_t>{1, 1});
+                check_lap(cpu_kfirst<int_t, int_t>{3, 2});
+                check_lap(cpu_kfirst<int_t, int_t>{5, 20});
+                check_lap(cpu_kfirst<int_t, int_t>{64, 64});
+            }
+
+            TEST(autotuner, selects_and_persists_winner) {
+                std::string filename = testing::TempDir() + "gt_cpu_kfirst_tuning.txt";
+                std::remove(filename.c_str());
+                auto tuner =
+                    std::make_shared<autotuner>(filename, std::vector<block_sizes>{{2, 2}, {4, 3}, {16, 16}}, 2);
+                auto key = make_tuning_key<int>(make_grid(7, 5, 3), 1);
+
+                block_sizes found;
+                int calls = 0;
+                for (; calls < 6; ++calls) {
+                    EXPECT_FALSE(tuner->lookup(key, found));
+                    (*tuner)(key, [&](block_sizes sizes) {
+                        EXPECT_EQ(sizes.i, calls < 2 ? 2 : calls < 4 ? 4 : 16);
+                    });
+                }
+                ASSERT_TRUE(tuner->lookup(key, found));
+                (*tuner)(key, [&](block_sizes sizes) {
+                    EXPECT_EQ(sizes.i, found.i);
+                    EXPECT_EQ(sizes.j, found.j);
+                });
+                EXPECT_TRUE(tuner->save());
+
+                autotuner reloaded(filename);
+                block_sizes reloaded_found;
+                ASSERT_TRUE(reloaded.lookup(key, reloaded_found));
+                EXPECT_EQ(reloaded_found.i, found.i);
+                EXPECT_EQ(reloaded_found.j, found.j);
+                EXPECT_FALSE(reloaded.lookup(make_tuning_key<int>(make_grid(7, 5, 3), 2), reloaded_found));
+                std::remove(filename.c_str());
+            }
+
+            TEST(autotuner, reports_write_failure) {
+                autotuner tuner(testing::TempDir() + "no_such_dir/gt_cpu_kfirst_tuning.txt", {{2, 2}}, 1);
+                auto key = make_tuning_key<int>(make_grid(7, 5, 3), 1);
+                tuner(key, [](block_sizes) {});
+                block_sizes found;
+                EXPECT_TRUE(tuner.lookup(key, found));
+                EXPECT_FALSE(tuner.save());
+            }
+
+            TEST(autotuner, replaces_file) {
+                std::string filename = testing::TempDir() + "gt_cpu_kfirst_tuning_replace.txt";
+                std::ofstream(filename) << "garbage that is longer than the tunings of the test, garbage garbage "
+                                           "garbage garbage garbage garbage garbage garbage garbage garbage\n";
+                autotuner tuner(filename, {{2, 2}}, 1);
+                auto key = make_tuning_key<int>(make_grid(7, 5, 3), 1);
+                tuner(key, [](block_sizes) {});
+
+                std::ifstream in(filename);
+                std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                EXPECT_EQ(content.find("garbage"), std::string::npos);
+                autotuner reloaded(filename);
+                block_sizes found;
+                ASSERT_TRUE(reloaded.lookup(key, found));
+                EXPECT_EQ(found.i, 2);
+                std::remove(filename.c_str());
+            }
+
+            TEST(cpu_kfirst_autotuned, smoke) {
+                cpu_kfirst_autotuned<> be{std::make_shared<autotuner>()};
+                for (int i = 0; i != 20; ++i)
+                    check_lap(be);
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,59 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gtest/gtest.h>
+
+#include "test_lap_scale.hpp"
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+    using namespace lap_scale;
+
+    template <class T>
+    using fused_run = regression_test<T>;
+
+    TYPED_TEST_SUITE(fused_run, types_t);
+
+    TYPED_TEST(fused_run, fuse) {
+        auto out = TypeParam::make_storage();
+        auto spec = [](auto in, auto out) {
+            GT_DECLARE_TMP(double, tmp);
+            return fuse(scale_spec(in, tmp), lap_spec(tmp, out));
+        };
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), TypeParam::make_storage(in), out);
+        TypeParam::verify([](int i, int j, int k) { return lap_in(i, j, k) / 2; }, out);
+    }
+
+    TYPED_TEST(fused_run, deferred) {
+        auto a = TypeParam::make_storage(in);
+        auto b = TypeParam::make_storage();
+        auto c = TypeParam::make_storage();
+        auto d = TypeParam::make_storage();
+        make_fused_run(a, b, c, d)
+            .template then<0, 1>(lap_spec)
+            .template then<1, 2>(scale_spec)
+            .template then_single_stage<2, 3>(scale())
+            .run(stencil_backend_t(), TypeParam::make_grid());
+        TypeParam::verify([](int i, int j, int k) { return lap_in(i, j, k) / 4; }, d);
+        TypeParam::verify([](int i, int j, int k) { return lap_in(i, j, k) / 2; }, c);
+    }
+
+    TYPED_TEST(fused_run, plan) {
+        auto a = TypeParam::make_storage(in);
+        auto b = TypeParam::make_storage();
+        auto plan = make_fused_run(a, b)
+                        .template then<0, 1>(scale_spec)
+                        .template then<1, 1>(scale_spec)
+                        .make_plan(stencil_backend_t(), TypeParam::make_grid());
+        plan();
+        TypeParam::verify([](int i, int j, int k) { return in(i, j, k) / 4; }, b);
+    }
+} // namespace
@@ -0,0 +1,110 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    using axis_t = axis<1, axis_config::offset_limit<3>>;
+    using kfull = axis_t::full_interval;
+
+    double in(int i, int j, int k) { return i + 2 * j + 3 * k + 1; }
+
+    double cross(int i, int j, int k) { return in(i + 1, j, k) + in(i - 1, j, k) + in(i, j + 1, k) + in(i, j - 1, k); }
+
+    using env_t = vertical_test_environment<1, axis_t>;
+
+    template <class T>
+    using test_ij_cache = regression_test<T>;
+
+    using types_t = meta::if_<env_t::is_enabled<stencil_backend_t>,
+        ::testing::Types<env_t::apply<stencil_backend_t, double, inlined_params<12, 13, 9>>>,
+        ::testing::Types<>>;
+    TYPED_TEST_SUITE(test_ij_cache, types_t);
+
+    struct copy_functor {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in());
+        }
+    };
+
+    struct cross_functor {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in(1, 0, 0)) + eval(in(-1, 0, 0)) + eval(in(0, 1, 0)) + eval(in(0, -1, 0));
+        }
+    };
+
+    struct cross_acc_functor {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+            eval(out()) = eval(in(1, 0, 0)) + eval(in(-1, 0, 0)) + eval(in(0, 1, 0)) + eval(in(0, -1, 0));
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+            eval(out()) =
+                eval(out(0, 0, -1)) + eval(in(1, 0, 0)) + eval(in(-1, 0, 0)) + eval(in(0, 1, 0)) + eval(in(0, -1, 0));
+        }
+    };
+
+    TYPED_TEST(test_ij_cache, parallel) {
+        auto out = TypeParam::make_storage();
+        auto spec = [](auto in, auto out) {
+            GT_DECLARE_TMP(double, tmp);
+            return execute_parallel().ij_cached(tmp).stage(copy_functor(), in, tmp).stage(cross_functor(), tmp, out);
+        };
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), TypeParam::make_storage(in), out);
+        TypeParam::verify(cross, out);
+    }
+
+    TYPED_TEST(test_ij_cache, forward) {
+        auto out = TypeParam::make_storage();
+        auto spec = [](auto in, auto out) {
+            GT_DECLARE_TMP(double, tmp);
+            return execute_forward().ij_cached(tmp).stage(copy_functor(), in, tmp).stage(
+                cross_acc_functor(), tmp, out);
+        };
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), TypeParam::make_storage(in), out);
+        auto ref = TypeParam::make_storage();
+        auto refv = ref->host_view();
+        for (int i = 1; i < TypeParam::d(0) - 1; ++i)
+            for (int j = 1; j < TypeParam::d(1) - 1; ++j) {
+                refv(i, j, 0) = cross(i, j, 0);
+                for (int k = 1; k < TypeParam::k_size(); ++k)
+                    refv(i, j, k) = refv(i, j, k - 1) + cross(i, j, k);
+            }
+        TypeParam::verify(ref, out);
+    }
+} // namespace
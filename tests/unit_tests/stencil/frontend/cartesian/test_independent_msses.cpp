@@ -0,0 +1,120 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    using axis_t = axis<1>;
+    using full_t = axis_t::full_interval;
+
+    struct forward_sum {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, full_t::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, full_t::modify<1, 0>) {
+            eval(out()) = eval(out(0, 0, -1)) + eval(in());
+        }
+    };
+
+    struct backward_sum {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, 0, 1>>;
+
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, full_t::last_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, full_t::modify<0, -1>) {
+            eval(out()) = eval(out(0, 0, 1)) + eval(in());
+        }
+    };
+
+    struct lap_of_sum {
+        using in0 = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using in1 = in_accessor<1>;
+        using out = inout_accessor<2>;
+
+        using param_list = make_param_list<in0, in1, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = 4 * eval(in0()) - eval(in0(1, 0)) - eval(in0(-1, 0)) - eval(in0(0, 1)) -
+                          eval(in0(0, -1)) + eval(in1());
+        }
+    };
+
+    double in(int i, int j, int k) { return i + 2 * j + 3 * k + 1; }
+
+    using env_t = test_environment<1, axis_t>;
+
+    template <class T>
+    using independent_msses = regression_test<T>;
+
+    using types_t = meta::if_<env_t::is_enabled<stencil_backend_t>,
+        ::testing::Types<env_t::apply<stencil_backend_t, double, inlined_params<12, 13, 9>>>,
+        ::testing::Types<>>;
+    TYPED_TEST_SUITE(independent_msses, types_t);
+
+    // the forward and the backward column sums don't depend on each other, the last pass depends on both
+    TYPED_TEST(independent_msses, column_sums) {
+        auto down = TypeParam::make_storage();
+        auto up = TypeParam::make_storage();
+        auto out = TypeParam::make_storage();
+        auto spec = [](auto in, auto down, auto up, auto out) {
+            GT_DECLARE_TMP(double, tmp);
+            return multi_pass(execute_forward().stage(forward_sum(), in, tmp).stage(forward_sum(), tmp, down),
+                execute_backward().stage(backward_sum(), in, up),
+                execute_parallel().stage(lap_of_sum(), up, down, out));
+        };
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), TypeParam::make_storage(in), down, up, out);
+
+        int k_size = TypeParam::k_size();
+        auto partial = [](int i, int j, int first, int last) {
+            double res = 0;
+            for (int k = first; k < last; ++k)
+                res += in(i, j, k);
+            return res;
+        };
+        auto ref_down = [&](int i, int j, int k) {
+            double res = 0;
+            for (int kk = 0; kk <= k; ++kk)
+                res += partial(i, j, 0, kk + 1);
+            return res;
+        };
+        auto ref_up = [&](int i, int j, int k) { return partial(i, j, k, k_size); };
+        TypeParam::verify(ref_down, down);
+        TypeParam::verify(
+            [&](int i, int j, int k) {
+                return 4 * ref_up(i, j, k) - ref_up(i + 1, j, k) - ref_up(i - 1, j, k) - ref_up(i, j + 1, k) -
+                       ref_up(i, j - 1, k) + ref_down(i, j, k);
+            },
+            out);
+    }
+} // namespace
@@ -100,6 +100,71 @@ namespace {
         TypeParam::verify(ref, field);
     }
 
+    // a window of three k-levels, so that the cache rotates over more than two planes
+    struct two_levels_forward_fill_and_flush {
+        using in = inout_accessor<0, extent<0, 0, 0, 0, -2, 0>>;
+        using param_list = make_param_list<in>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<2, 0>) {
+            eval(in()) = eval(in()) + eval(in(0, 0, -1)) - eval(in(0, 0, -2));
+        }
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::first_level::modify<0, 1>) {
+            eval(in()) = eval(in());
+        }
+    };
+
+    TYPED_TEST(test_kcache_fill_and_flush, two_levels_forward) {
+        auto field = TypeParam::make_storage(in);
+        auto spec = [](auto in) {
+            return execute_forward()
+                .k_cached(cache_io_policy::fill(), cache_io_policy::flush(), in)
+                .stage(two_levels_forward_fill_and_flush(), in);
+        };
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), field);
+        auto ref = TypeParam::make_storage();
+        auto refv = ref->host_view();
+        for (int i = 0; i < TypeParam::d(0); ++i)
+            for (int j = 0; j < TypeParam::d(1); ++j)
+                for (int k = 0; k < TypeParam::k_size(); ++k)
+                    refv(i, j, k) = k < 2 ? in(i, j, k) : in(i, j, k) + refv(i, j, k - 1) - refv(i, j, k - 2);
+        TypeParam::verify(ref, field);
+    }
+
+    struct two_levels_backward_fill_and_flush {
+        using in = inout_accessor<0, extent<0, 0, 0, 0, 0, 2>>;
+        using param_list = make_param_list<in>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<0, -2>) {
+            eval(in()) = eval(in()) + eval(in(0, 0, 1)) - eval(in(0, 0, 2));
+        }
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::last_level::modify<-1, 0>) {
+            eval(in()) = eval(in());
+        }
+    };
+
+    TYPED_TEST(test_kcache_fill_and_flush, two_levels_backward) {
+        auto field = TypeParam::make_storage(in);
+        auto spec = [](auto in) {
+            return execute_backward()
+                .k_cached(cache_io_policy::fill(), cache_io_policy::flush(), in)
+                .stage(two_levels_backward_fill_and_flush(), in);
+        };
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), field);
+        auto ref = TypeParam::make_storage();
+        auto refv = ref->host_view();
+        int k_size = TypeParam::k_size();
+        for (int i = 0; i < TypeParam::d(0); ++i)
+            for (int j = 0; j < TypeParam::d(1); ++j)
+                for (int k = k_size - 1; k >= 0; --k)
+                    refv(i, j, k) =
+                        k >= k_size - 2 ? in(i, j, k) : in(i, j, k) + refv(i, j, k + 1) - refv(i, j, k + 2);
+        TypeParam::verify(ref, field);
+    }
+
     struct copy_fill {
         using in = inout_accessor<0>;
         using param_list = make_param_list<in>;
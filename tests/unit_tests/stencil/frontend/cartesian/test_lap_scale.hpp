@@ -0,0 +1,74 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+/*
+ *  A small two stage computation (a laplacian followed by a scaling) for the tests of the ways to run computations.
+ */
+namespace gridtools {
+    namespace stencil {
+        namespace cartesian {
+            namespace lap_scale {
+                struct lap {
+                    using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+                    using out = inout_accessor<1>;
+
+                    using param_list = make_param_list<in, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        eval(out()) =
+                            4 * eval(in()) - eval(in(1, 0)) - eval(in(-1, 0)) - eval(in(0, 1)) - eval(in(0, -1));
+                    }
+                };
+
+                struct scale {
+                    using in = in_accessor<0>;
+                    using out = inout_accessor<1>;
+
+                    using param_list = make_param_list<in, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        eval(out()) = eval(in()) / 2;
+                    }
+                };
+
+                const auto lap_spec = [](auto in, auto out) { return execute_parallel().stage(lap(), in, out); };
+                const auto scale_spec = [](auto in, auto out) { return execute_parallel().stage(scale(), in, out); };
+
+                // the laplacian of `in`, scaled
+                const auto spec = [](auto in, auto out) {
+                    GT_DECLARE_TMP(double, tmp);
+                    return execute_parallel().stage(lap(), in, tmp).stage(scale(), tmp, out);
+                };
+
+                inline double in(int i, int j, int k) { return i * i + 2 * j - k * i; }
+
+                inline double lap_in(int i, int j, int k) {
+                    return 4 * in(i, j, k) - in(i + 1, j, k) - in(i - 1, j, k) - in(i, j + 1, k) - in(i, j - 1, k);
+                }
+
+                using env_t = test_environment<1>;
+
+                using types_t = meta::if_<env_t::is_enabled<stencil_backend_t>,
+                    ::testing::Types<env_t::apply<stencil_backend_t, double, inlined_params<12, 13, 9>>>,
+                    ::testing::Types<>>;
+            } // namespace lap_scale
+        }     // namespace cartesian
+    }         // namespace stencil
+} // namespace gridtools
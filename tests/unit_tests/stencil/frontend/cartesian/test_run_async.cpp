@@ -0,0 +1,86 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <chrono>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "test_lap_scale.hpp"
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+    using namespace lap_scale;
+
+    template <class T>
+    using run_async = regression_test<T>;
+
+    TYPED_TEST_SUITE(run_async, types_t);
+
+    TYPED_TEST(run_async, independent) {
+        auto in1 = TypeParam::make_storage(in);
+        auto in2 = TypeParam::make_storage([](int i, int j, int k) { return in(i, j, k) + 1; });
+        auto out1 = TypeParam::make_storage();
+        auto out2 = TypeParam::make_storage();
+        auto f1 = gridtools::stencil::run_async(spec, stencil_backend_t(), TypeParam::make_grid(), in1, out1);
+        auto f2 = gridtools::stencil::run_async(spec, stencil_backend_t(), TypeParam::make_grid(), in2, out2);
+        f1.wait();
+        f2.wait();
+
+        auto ref1 = TypeParam::make_storage();
+        auto ref2 = TypeParam::make_storage();
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), in1, ref1);
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), in2, ref2);
+        TypeParam::verify(ref1, out1);
+        TypeParam::verify(ref2, out2);
+    }
+
+    TYPED_TEST(run_async, dependent) {
+        auto a = TypeParam::make_storage(in);
+        auto b = TypeParam::make_storage();
+        auto c = TypeParam::make_storage();
+        auto first = gridtools::stencil::run_async(spec, stencil_backend_t(), TypeParam::make_grid(), a, b);
+        run_async_after(std::move(first), spec, stencil_backend_t(), TypeParam::make_grid(), b, c).get();
+
+        auto ref_b = TypeParam::make_storage();
+        auto ref_c = TypeParam::make_storage();
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), a, ref_b);
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), ref_b, ref_c);
+        TypeParam::verify(ref_c, c);
+    }
+
+    TYPED_TEST(run_async, after_does_not_block) {
+        auto a = TypeParam::make_storage(in);
+        auto b = TypeParam::make_storage();
+        std::promise<void> ready;
+        auto f = run_async_after(ready.get_future(), spec, stencil_backend_t(), TypeParam::make_grid(), a, b);
+        // the computation is enqueued, but doesn't start before `ready`
+        EXPECT_EQ(f.wait_for(std::chrono::milliseconds(10)), std::future_status::timeout);
+        ready.set_value();
+        f.get();
+
+        auto ref = TypeParam::make_storage();
+        run(spec, stencil_backend_t(), TypeParam::make_grid(), a, ref);
+        TypeParam::verify(ref, b);
+    }
+
+    TYPED_TEST(run_async, after_failed) {
+        auto a = TypeParam::make_storage(in);
+        auto b = TypeParam::make_storage();
+        std::promise<void> ready;
+        auto f = run_async_after(ready.get_future(), spec, stencil_backend_t(), TypeParam::make_grid(), a, b);
+        ready.set_exception(std::make_exception_ptr(std::runtime_error("failed")));
+        EXPECT_THROW(f.get(), std::runtime_error);
+    }
+} // namespace
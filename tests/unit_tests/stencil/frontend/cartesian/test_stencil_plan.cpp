@@ -0,0 +1,50 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gtest/gtest.h>
+
+#include "test_lap_scale.hpp"
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+    using namespace lap_scale;
+
+    template <class T>
+    using stencil_plan = regression_test<T>;
+
+    TYPED_TEST_SUITE(stencil_plan, types_t);
+
+    TYPED_TEST(stencil_plan, rebind) {
+        auto a = TypeParam::make_storage(in);
+        auto b = TypeParam::make_storage();
+        auto c = TypeParam::make_storage();
+        auto plan = make_stencil_plan(spec, stencil_backend_t(), TypeParam::make_grid(), a, b);
+
+        auto ref_a = TypeParam::make_storage(in);
+        auto ref_b = TypeParam::make_storage();
+        auto ref_c = TypeParam::make_storage();
+        auto step_ref = [&](auto &in, auto &out) { run(spec, stencil_backend_t(), TypeParam::make_grid(), in, out); };
+
+        plan();
+        step_ref(ref_a, ref_b);
+        TypeParam::verify(ref_b, b);
+
+        // rotate the time levels
+        plan(b, c);
+        step_ref(ref_b, ref_c);
+        TypeParam::verify(ref_c, c);
+
+        plan.rebind(c, a);
+        plan();
+        step_ref(ref_c, ref_a);
+        TypeParam::verify(ref_a, a);
+    }
+} // namespace
@@ -0,0 +1,148 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/thread_pool/persistent.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/thread_pool/concept.hpp>
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace {
+            TEST(persistent_impl_, parse_cpu_list) {
+                EXPECT_EQ(persistent_impl_::parse_cpu_list("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+                EXPECT_TRUE(persistent_impl_::parse_cpu_list("").empty());
+            }
+
+            void check_pool() {
+                persistent pool;
+                int max_threads = get_max_threads(pool);
+                EXPECT_EQ(get_thread_num(pool), 0);
+                for (int size : {0, 1, 3, 100, 1001}) {
+                    std::vector<std::atomic<int>> visits(size);
+                    std::atomic<bool> bad_thread_num{false};
+                    parallel_for_loop(
+                        pool,
+                        [&](int i) {
+                            int thread = get_thread_num(pool);
+                            if (thread < 0 || thread >= max_threads)
+                                bad_thread_num = true;
+                            ++visits[i];
+                        },
+                        size);
+                    EXPECT_FALSE(bad_thread_num);
+                    for (auto &&visit : visits)
+                        EXPECT_EQ(visit, 1);
+                }
+            }
+
+            TEST(persistent, single_thread) {
+                init_persistent(1);
+                EXPECT_EQ(get_max_threads(persistent()), 1);
+                check_pool();
+            }
+
+            TEST(persistent, compact) {
+                init_persistent(4, affinity::compact);
+                EXPECT_EQ(get_max_threads(persistent()), 4);
+                check_pool();
+            }
+
+            TEST(persistent, scatter) {
+                init_persistent(3, affinity::scatter);
+                check_pool();
+            }
+
+            TEST(persistent, many_small_loops) {
+                init_persistent(4);
+                std::atomic<long> sum{0};
+                for (int n = 0; n < 1000; ++n)
+                    parallel_for_loop(persistent(), [&](int i) { sum += i; }, 8);
+                EXPECT_EQ(sum, 1000 * 28);
+            }
+
+            TEST(persistent, multi_dimensional) {
+                init_persistent(4);
+                std::vector<std::atomic<int>> visits(2 * 3 * 5);
+                parallel_for_loop(
+                    persistent(), [&](int i, int j, int k) { ++visits[i + 2 * j + 6 * k]; }, 2, 3, 5);
+                for (auto &&visit : visits)
+                    EXPECT_EQ(visit, 1);
+            }
+
+            TEST(persistent, nested) {
+                init_persistent(4);
+                std::vector<std::atomic<int>> visits(4 * 7);
+                parallel_for_loop(
+                    persistent(),
+                    [&](int i) { parallel_for_loop(persistent(), [&](int j) { ++visits[i * 7 + j]; }, 7); },
+                    4);
+                for (auto &&visit : visits)
+                    EXPECT_EQ(visit, 1);
+            }
+
+            TEST(persistent, async) {
+                init_persistent(4);
+                std::vector<int> order;
+                std::vector<std::future<int>> futures;
+                for (int n = 0; n < 10; ++n)
+                    futures.push_back(async(persistent(), [&order, n] {
+                        std::atomic<int> sum{0};
+                        parallel_for_loop(persistent(), [&](int i) { sum += i; }, 8);
+                        order.push_back(n);
+                        return sum + n;
+                    }));
+                for (int n = 0; n < 10; ++n)
+                    EXPECT_EQ(futures[n].get(), 28 + n);
+                EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+            }
+
+            TEST(persistent, reserve_core) {
+                init_persistent(3);
+                std::vector<int> threads(6);
+                auto last_thread = [&] {
+                    parallel_for_loop(
+                        persistent(), [&](int i) { threads[i] = get_thread_num(persistent()); }, 6);
+                    return *std::max_element(threads.begin(), threads.end());
+                };
+                // the threads are not pinned: no cpu is reported
+                EXPECT_EQ(reserve_core(persistent()), -1);
+                EXPECT_EQ(last_thread(), 1);
+                reserve_core(persistent());
+                reserve_core(persistent());
+                EXPECT_EQ(last_thread(), 0);
+                release_core(persistent());
+                release_core(persistent());
+                EXPECT_EQ(last_thread(), 1);
+                release_core(persistent());
+                release_core(persistent());
+                EXPECT_EQ(last_thread(), 2);
+            }
+
+            TEST(persistent, async_after) {
+                init_persistent(4);
+                std::promise<int> ready;
+                auto first = async_after(persistent(), ready.get_future(), [] { return 1; });
+                // enqueued after `first`, the caller doesn't wait for either of them
+                auto second = async_after(persistent(), std::move(first), [] { return 2; });
+                EXPECT_EQ(second.wait_for(std::chrono::milliseconds(10)), std::future_status::timeout);
+                ready.set_value(0);
+                EXPECT_EQ(second.get(), 2);
+            }
+        } // namespace
+    }     // namespace thread_pool
+} // namespace gridtools
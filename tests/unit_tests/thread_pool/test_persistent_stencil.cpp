@@ -0,0 +1,134 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/thread_pool/persistent.hpp>
+
+#include <chrono>
+#include <future>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/sid.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            struct lap {
+                using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                static void apply(Eval &&eval) {
+                    eval(out()) = 4 * eval(in()) - eval(in(1, 0)) - eval(in(-1, 0)) - eval(in(0, 1)) - eval(in(0, -1));
+                }
+            };
+
+            struct copy {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                static void apply(Eval &&eval) {
+                    eval(out()) = eval(in());
+                }
+            };
+
+            const auto builder =
+                storage::builder<storage::cpu_ifirst>.type<double>().halos(1, 1, 0).dimensions(35, 21, 6);
+
+            double in_f(int i, int j, int k) { return i * i + 3 * j + k * i * j; }
+
+            template <class Backend, class Exec>
+            void check_lap(Backend be, Exec exec) {
+                auto in = builder.initializer(in_f).build();
+                auto out = builder.value(-1).build();
+                run(
+                    [exec](auto in, auto out) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return exec.stage(lap(), in, tmp).stage(copy(), tmp, out);
+                    },
+                    be,
+                    make_grid(halo_descriptor(1, 1, 1, 33, 35), halo_descriptor(1, 1, 1, 19, 21), 6),
+                    in,
+                    out);
+                auto v = out->const_host_view();
+                for (int i = 1; i < 34; ++i)
+                    for (int j = 1; j < 20; ++j)
+                        for (int k = 0; k < 6; ++k)
+                            EXPECT_EQ(v(i, j, k),
+                                4 * in_f(i, j, k) - in_f(i + 1, j, k) - in_f(i - 1, j, k) - in_f(i, j + 1, k) -
+                                    in_f(i, j - 1, k));
+            }
+
+            TEST(persistent, cpu_ifirst) {
+                thread_pool::init_persistent(3);
+                check_lap(cpu_ifirst<thread_pool::persistent>(), execute_parallel());
+                check_lap(cpu_ifirst<thread_pool::persistent>(), execute_forward());
+            }
+
+            TEST(persistent, cpu_kfirst) {
+                thread_pool::init_persistent(3, thread_pool::affinity::compact);
+                using block_size_t = integral_constant<int_t, 8>;
+                check_lap(cpu_kfirst<block_size_t, block_size_t, thread_pool::persistent>(), execute_parallel());
+            }
+
+            TEST(persistent, run_async) {
+                thread_pool::init_persistent(3);
+                auto grid = make_grid(halo_descriptor(1, 1, 1, 33, 35), halo_descriptor(1, 1, 1, 19, 21), 6);
+                auto a = builder.initializer(in_f).build();
+                auto b = builder.value(-1).build();
+                auto c = builder.value(-1).build();
+                auto step = [](auto in, auto out) { return execute_parallel().stage(copy(), in, out); };
+                // the tasks are executed in the order of submission: the second run sees the result of the first
+                auto first = run_async(step, cpu_ifirst<thread_pool::persistent>(), grid, a, b);
+                auto second = run_async(step, cpu_ifirst<thread_pool::persistent>(), grid, b, c);
+                first.get();
+                second.get();
+                auto v = c->const_host_view();
+                for (int i = 1; i < 34; ++i)
+                    for (int j = 1; j < 20; ++j)
+                        for (int k = 0; k < 6; ++k)
+                            EXPECT_EQ(v(i, j, k), in_f(i, j, k));
+            }
+
+            TEST(persistent, run_async_after) {
+                thread_pool::init_persistent(3);
+                auto grid = make_grid(halo_descriptor(1, 1, 1, 33, 35), halo_descriptor(1, 1, 1, 19, 21), 6);
+                auto a = builder.initializer(in_f).build();
+                auto b = builder.value(-1).build();
+                auto c = builder.value(-1).build();
+                auto step = [](auto in, auto out) { return execute_parallel().stage(copy(), in, out); };
+                cpu_ifirst<thread_pool::persistent> be;
+                std::promise<void> ready;
+                // both runs are enqueued before any of them can start
+                auto first = run_async_after(ready.get_future(), step, be, grid, a, b);
+                auto second = run_async_after(std::move(first), step, be, grid, b, c);
+                EXPECT_EQ(second.wait_for(std::chrono::milliseconds(10)), std::future_status::timeout);
+                EXPECT_EQ(c->const_host_view()(1, 1, 0), -1);
+                ready.set_value();
+                second.get();
+                auto v = c->const_host_view();
+                for (int i = 1; i < 34; ++i)
+                    for (int j = 1; j < 20; ++j)
+                        for (int k = 0; k < 6; ++k)
+                            EXPECT_EQ(v(i, j, k), in_f(i, j, k));
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools